@@ -1,19 +1,28 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <deque>
 #include <algorithm>
 #include <functional>
 #include <unordered_map>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string_view>
+#include <istream>
+#include <ostream>
 
 #include <exception>
 #include <stdexcept>
+#include <iterator>
 
 #include "forward_decl.hpp"
 #include "formatting.hpp"
+#include "help_text.hpp"
+#include "option_binding.hpp"
 
 namespace argunaught
 {
@@ -35,6 +44,7 @@ enum class ParserConfigErrorType
     CommandNameMissing,
     DuplicateCommandName,
     CommandGroupNameMissing,
+    UnknownConstraintOption,
 };
 
 //! A structure for capturing information about parser configuration errors.
@@ -51,6 +61,14 @@ struct ParserConfigError
 enum class ParseErrorType
 {
     UnknownOption,
+    UnterminatedQuote,
+    TrailingEscape,
+    MissingRequiredOption,
+    ConflictingOptions,
+    MissingDependentOption,
+    TooFewOptionParams,
+    InvalidOptionValue,
+    RepeatedOption,
 };
 
 //! Information about errors caught while parsing the command line with the
@@ -59,13 +77,39 @@ struct ParseError {
     //! The type of error the parser found
     ParseErrorType type;
 
-    //! Which item in the list of command line tokens generated the error
+    //! Which item in the list of command line tokens generated the error, 
+    //! or `-1` if the error isn't tied to one token, e.g. a missing required option.
     int pos;
 
     //! The problematic command line token.
     std::string value;
 };
 
+//! Returns a short message describing a parse error, e.g. `unknown option: --foo`.
+std::string describeParseError(const ParseError& error);
+
+//! How the results of an option given more than once are combined.
+enum class RepeatPolicy
+{
+    //! Each occurrence gets its own `OptionResult`.
+    Separate,
+
+    //! One result counting the occurrences, e.g. `-v -v -v`.  Values aren't kept.
+    Count,
+
+    //! One result with the values of every occurrence appended in order.
+    Append,
+
+    //! One result with the values of the last occurrence.
+    LastWins,
+
+    //! One result with the values of the first occurrence.
+    FirstWins,
+
+    //! One result for the first occurrence, with a `RepeatedOption` error for each repeat.
+    Error,
+};
+
 //! Command line option descritor
 /*!
  *  Describes the short and long names for an option.  Contains a description 
@@ -83,7 +127,7 @@ struct Option
 
     //! A description of the option, used for generating help.
     //! `\n` is replaced in the default help formatting with proper indentation.
-    std::string description;
+    HelpText description;
 
     //! The number of parameters this option expects, 
     //
@@ -92,6 +136,100 @@ struct Option
     //! Similarly a lone `--` will end option parameter parsing and move to 
     //! positional parameters.
     int maxNumParams = 0;
+
+    //! The minimum number of parameters needed each time the option is given.
+    int minNumParams = 0;
+
+    //! Whether the option must be given.
+    bool required = false;
+
+    //! Long names of options that may not be given along with this one.
+    std::vector<std::string> conflictsWith = {};
+
+    //! Long names of options that must also be given when this one is.
+    std::vector<std::string> dependsOn = {};
+
+    //! How repeats of the option are combined.  Anything other than `Separate`
+    //! merges them into a single `OptionResult` as they're parsed, which is 
+    //! kept in `ParseResult::options` even when using columnar results.  
+    //! Bound options write every value and ignore this.
+    RepeatPolicy repeat = RepeatPolicy::Separate;
+
+    //! Writes the option's values into a bound destination during parsing, see `bindTo`.
+    OptionBinder binder = nullptr;
+
+    //! Binds the option to a variable, which is written as the option is parsed.
+    /*!
+     *  Values are converted to the destination's type: strings, `bool`, 
+     *  integers, floating point values, or a `std::vector` or `std::optional` 
+     *  of those.  A bound `bool` given without a value is set to true.  Values 
+     *  that can't be converted are reported as `InvalidOptionValue` errors.
+     *
+     *  Bound options aren't recorded in the `ParseResult`, so `getOption` and 
+     *  `hasOption` don't see them.  The destination must outlive any parsing.
+     *
+     *  Every parse writes the same destination, so bound options can't be 
+     *  parsed while a parser is shared between threads, see `SharedParsing`.
+     */
+    template<typename T>
+    Option& bindTo(T& dest)
+    {
+        binder = detail::makeBinder(dest);
+        return *this;
+    }
+
+    //! Binds the option to a member of a config struct, e.g. `bindTo(config, &Config::verbose)`.
+    template<typename S, typename M>
+    Option& bindTo(S& object, M S::*member)
+    {
+        return bindTo(object.*member);
+    }
+};
+
+//! The kinds of constraints that can be placed on a set of options.
+enum class ConstraintType
+{
+    //! At most one of the options may be given.
+    MutuallyExclusive,
+
+    //! At least one of the options must be given.
+    AtLeastOne,
+};
+
+//! A constraint across a set of options, named by their long names.
+struct Constraint
+{
+    ConstraintType type;
+    std::vector<std::string> options;
+};
+
+//! A bitset over option ids, used to track which options were found.
+class OptionMask
+{
+private:
+    std::vector<std::uint64_t> mWords;
+
+public:
+    //! Marks the option id as set.
+    void set(std::size_t id);
+
+    //! Returns whether the option id is set.
+    bool test(std::size_t id) const;
+
+    //! Returns whether no option ids are set.
+    bool empty() const;
+
+    //! Returns the number of option ids set in both masks.
+    std::size_t countCommon(const OptionMask& other) const;
+
+    //! Returns whether every option id set in `other` is also set in this mask.
+    bool containsAll(const OptionMask& other) const;
+
+    //! Returns the option ids set in `other` but not in this mask.
+    std::vector<std::size_t> missingFrom(const OptionMask& other) const;
+
+    //! Returns the option ids set in the mask.
+    std::vector<std::size_t> ids() const;
 };
 
 //! An instance of an option found during parsing and any parameters associated.
@@ -99,18 +237,322 @@ struct OptionResult
 {
     std::string optionName;
     std::vector<std::string> values;
+
+    //! The number of times the option was given, when repeats are merged.
+    std::size_t count = 1;
+};
+
+//! The words of a single command line string, split using POSIX shell rules.
+/*!
+ *  Quote removal and escapes are applied while splitting, with the resulting 
+ *  words stored back to back in one buffer.  No expansions are performed.
+ */
+class CommandLineTokens
+{
+private:
+    struct Span 
+    {
+        std::size_t offset;
+        std::size_t length;
+    };
+
+    //! Storage for all of the unescaped words.
+    std::string mArena;
+    std::vector<Span> mSpans;
+
+    std::optional<ParseError> mError;
+
+    friend CommandLineTokens tokenizeCommandLine(std::string_view commandLine);
+
+public:
+    //! The number of words found.
+    std::size_t size() const { return mSpans.size(); }
+
+    //! Returns a view of a word, valid as long as this object is.
+    std::string_view operator[](std::size_t index) const {
+        return std::string_view(mArena.data() + mSpans[index].offset, mSpans[index].length);
+    }
+
+    //! Returns whether the command line was malformed, e.g. had an unterminated quote.
+    bool hasError() const { return mError.has_value(); }
+
+    //! The error found while splitting, if any.
+    const std::optional<ParseError>& error() const { return mError; }
+
+    //! Copies the words into a deque of strings suitable for `Parser::parse`.
+    std::deque<std::string> toDeque() const;
+};
+
+//! Splits a command line string into words following POSIX shell quoting.
+/*!
+ *  Handles single quotes, double quotes, backslash escapes, line continuations 
+ *  and `#` comments at the start of a word.
+ */
+CommandLineTokens tokenizeCommandLine(std::string_view commandLine);
+
+//! Option constraints compiled into bitmask rules over option ids.
+/*!
+ *  Global options of a parser have ids `0..N-1` and a command's options follow
+ *  on from them.  Rules are compiled when options and commands are registered
+ *  and then checked against the options found in a single pass after parsing.
+ */
+class ConstraintRules
+{
+private:
+    enum class RuleType
+    {
+        Required,
+        MutuallyExclusive,
+        AtLeastOne,
+        Requires,
+    };
+
+    struct Rule
+    {
+        RuleType type;
+        OptionMask mask;
+
+        //! For `Requires` rules, the option id that triggers the rule.
+        std::size_t trigger = 0;
+    };
+
+    std::vector<Rule> mRules;
+
+    //! Long option names by option id, for the options the rules refer to.
+    std::unordered_map<std::size_t, std::string> mNames;
+
+    std::string joinNames(const std::vector<std::size_t>& ids, const char* separator) const;
+
+public:
+    //! Compiles the constraints declared by a set of options.
+    /*!
+     *  If `commandOptions` is null, the global options' constraints are compiled 
+     *  along with `groups`.  Otherwise only the command options' constraints are, 
+     *  with option names resolved against both lists.  Unknown option names are 
+     *  reported in `errors`.
+     */
+    static ConstraintRules compile(
+            const OptionList& globalOptions,
+            const OptionList* commandOptions,
+            const std::vector<Constraint>& groups,
+            std::vector<ParserConfigError>& errors);
+
+    //! Returns whether there are no rules to check.
+    bool empty() const { return mRules.empty(); }
+
+    //! Checks the rules against the options found, appending any violations.
+    void evaluate(const OptionMask& present, std::vector<ParseError>& errors) const;
+};
+
+//! A read position over command line tokens, shared by nested parsers.
+/*!
+ *  Tokens are views of storage owned elsewhere, either `argv` or an array of
+ *  `std::string_view`s, which must outlive the cursor.  Advancing is O(1), so
+ *  handing the cursor to a nested parser costs nothing per remaining token.
+ */
+class ArgCursor
+{
+private:
+    const char* const* mArgv = nullptr;
+    const std::string_view* mViews = nullptr;
+    std::size_t mPos = 0;
+    std::size_t mEnd = 0;
+
+public:
+    ArgCursor() = default;
+
+    //! A cursor over `count` C strings, e.g. `argv + 1` and `argc - 1` from main.
+    ArgCursor(const char* const* argv, std::size_t count) 
+        : mArgv(argv), mEnd(count) {}
+
+    //! A cursor over an array of views.
+    ArgCursor(const std::string_view* views, std::size_t count) 
+        : mViews(views), mEnd(count) {}
+
+    //! Returns whether all tokens have been consumed.
+    bool empty() const { return mPos >= mEnd; }
+
+    //! Returns the number of tokens left.
+    std::size_t remaining() const { return mEnd - mPos; }
+
+    //! Returns the index of the current token in the underlying storage.
+    std::size_t position() const { return mPos; }
+
+    //! Returns the current token.
+    std::string_view front() const { return at(mPos); }
+
+    //! Returns a token by its index in the underlying storage.
+    std::string_view at(std::size_t index) const { 
+        return mArgv != nullptr ? std::string_view(mArgv[index]) : mViews[index]; 
+    }
+
+    //! Moves past the current token.
+    void advance(std::size_t count = 1) { mPos = std::min(mPos + count, mEnd); }
+
+    //! Returns the remaining tokens as argv entries, nullptr when not backed by argv.
+    const char* const* argvTail() const { return mArgv != nullptr ? mArgv + mPos : nullptr; }
+
+    //! Copies the remaining tokens, for handlers that take a deque of strings.
+    std::deque<std::string> toDeque() const;
+};
+
+//! Positional arguments delivered one at a time to a streaming command.
+/*!
+ *  Arguments come from the command line, and an argument of `-` or `@path` is
+ *  replaced by the lines read from stdin or from the response file at `path`.
+ *  Lines are read as they're pulled, so memory use doesn't grow with the number
+ *  of arguments.  Each argument is valid until the stream moves on.
+ *
+ *  \code
+ *  for(auto path : stream) { ingest(path); }
+ *  \endcode
+ */
+class PositionalStream
+{
+private:
+    ArgCursor mArgs;
+    const std::vector<std::string>* mStrings = nullptr;
+    std::size_t mStringPos = 0;
+
+    std::istream& mStdin;
+    std::unique_ptr<std::istream> mFile;
+    std::istream* mLines = nullptr;
+    std::string mLine;
+    std::string_view mCurrent;
+
+    //! Returns the next command line argument, false when there are none left.
+    bool nextArg(std::string_view& arg);
+
+public:
+    //! Streams the arguments left in an argv backed cursor, reading `-` from stdin.
+    explicit PositionalStream(ArgCursor args);
+    PositionalStream(ArgCursor args, std::istream& in);
+
+    //! Streams already collected arguments, reading `-` from stdin.
+    explicit PositionalStream(const std::vector<std::string>& args);
+    PositionalStream(const std::vector<std::string>& args, std::istream& in);
+
+    ~PositionalStream();
+
+    //! Moves to the next argument, returning false when there are none left.
+    //! Throws `std::runtime_error` if a response file can't be opened.
+    bool next();
+
+    //! The current argument.
+    std::string_view current() const { return mCurrent; }
+
+    //! An input iterator pulling arguments from the stream.
+    class iterator
+    {
+    private:
+        PositionalStream* mStream = nullptr;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = std::string_view;
+
+        iterator() = default;
+        explicit iterator(PositionalStream* stream) : mStream(stream) {
+            if(mStream != nullptr && !mStream->next()) mStream = nullptr;
+        }
+
+        reference operator*() const { return mStream->current(); }
+        iterator& operator++() {
+            if(!mStream->next()) mStream = nullptr;
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const { return mStream == other.mStream; }
+        bool operator!=(const iterator& other) const { return mStream != other.mStream; }
+    };
+
+    //! Starts pulling arguments, a stream can only be iterated once.
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
 };
 
+//! Shared pointer to an option list that is no longer modified.
+using OptionListPtr = std::shared_ptr<const OptionList>;
+
 //! A collection of options contained in the parser.
 class OptionList
 {
 private:
     std::vector<Option> mOptions;
 
+    //! A hash table of indexes into `mOptions`, looked up by one of the option
+    //! names.  Names are compared against the options' own, so they aren't
+    //! stored a second time.
+    class NameIndex
+    {
+    private:
+        static constexpr std::uint32_t Empty = ~std::uint32_t(0);
+
+        //! Open addressing with linear probing, kept at most half full.
+        std::vector<std::uint32_t> mSlots;
+        std::uint32_t mCount = 0;
+
+        void place(std::uint32_t index, std::string_view name);
+
+    public:
+        using NameField = std::string Option::*;
+
+        std::optional<std::uint32_t> find(std::string_view name, const std::vector<Option>& options, NameField field) const;
+
+        //! Adds `options[index]`, which must already be in the list.
+        void insert(std::uint32_t index, const std::vector<Option>& options, NameField field);
+    };
+
+    NameIndex mLongIndex;
+    NameIndex mShortIndex;
+
+    //! Shared packs of options included by reference, which follow `mOptions`.
+    std::vector<OptionListPtr> mPacks;
+
+    //! The index of each pack's first option, counting from the end of `mOptions`.
+    std::vector<std::uint32_t> mPackOffsets;
+    std::uint32_t mNumPackOptions = 0;
+
+    //! Whether any option declares a constraint, i.e. is required or has 
+    //! `conflictsWith` or `dependsOn` names.
+    bool mDeclaresConstraints = false;
+
+    //! Returns whether any of `options` has a name already in this list.
+    bool clashesWith(const std::vector<Option>& options) const;
+
 public:
+    //! Iterates over all of the options, the list's own ones and then those 
+    //! of any included packs.
+    class const_iterator
+    {
+    private:
+        const OptionList* mList = nullptr;
+        std::size_t mIndex = 0;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Option;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Option*;
+        using reference = const Option&;
+
+        const_iterator() = default;
+        const_iterator(const OptionList* list, std::size_t index) : mList(list), mIndex(index) {}
+
+        reference operator*() const { return mList->at(mIndex); }
+        pointer operator->() const { return &mList->at(mIndex); }
+        const_iterator& operator++() { ++mIndex; return *this; }
+        const_iterator operator++(int) { auto prev = *this; ++mIndex; return prev; }
+        bool operator==(const const_iterator& other) const { return mIndex == other.mIndex; }
+        bool operator!=(const const_iterator& other) const { return mIndex != other.mIndex; }
+    };
+
     OptionList() = default;
     OptionList(std::vector<Option> opts);
-    OptionList(const OptionList& opts);
+    OptionList(const OptionList& opts) = default;
 
     OptionList& operator=( const OptionList& ) = default;
 
@@ -123,16 +565,238 @@ public:
     //!       in this list will end up taking precedence.
     ParserConfigErrorType addOptions(const OptionList& opts);
 
+    //! Includes a shared pack of options by reference rather than copying them.
+    /*!
+     *  The pack's options follow this list's own, and any packs the pack 
+     *  includes are included too, once.  Only the side with fewer options is
+     *  checked for duplicates, so attaching a large pack to many small lists 
+     *  costs little per attachment.  Nothing is included if a name clashes.
+     */
+    ParserConfigErrorType include(OptionListPtr pack);
+
     //! Looks for an option based on its short name
     std::optional<Option> findShortOption(std::string optionName) const;
 
     //! Looks for an option using its long name
     std::optional<Option> findLongOption(std::string optionName) const;
 
-    //! Returns a constant reference to all of the contained options.
+    //! Returns the index of an option with the given short name, if there is one.
+    std::optional<std::size_t> findShortOptionIndex(std::string_view optionName) const;
+
+    //! Returns the index of an option with the given long name, if there is one.
+    std::optional<std::size_t> findLongOptionIndex(std::string_view optionName) const;
+
+    //! Returns a constant reference to the list's own options, excluding any
+    //! included packs.
     const std::vector<Option>& values() const { return mOptions; }
+
+    //! Returns the included packs, in the order their options follow.
+    const std::vector<OptionListPtr>& packs() const { return mPacks; }
+
+    //! The number of options, including those of included packs.
+    std::size_t size() const { return mOptions.size() + mNumPackOptions; }
+    bool empty() const { return size() == 0; }
+
+    //! Returns an option by index, where included packs' options follow the 
+    //! list's own.
+    const Option& at(std::size_t index) const;
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    //! Returns whether any of the list's own options declare a constraint.
+    bool declaresConstraints() const { return mDeclaresConstraints; }
+};
+
+//! Creates an immutable pack of options that commands and parsers can include
+//! by reference, e.g. options common to many commands.
+inline OptionListPtr 
+makeOptionPack(std::vector<Option> opts)
+{
+    return std::make_shared<const OptionList>(std::move(opts));
+}
+
+//! One layer in a chain of option lists, e.g. command, then parser, then an 
+//! inherited parent parser's options.
+/*!
+ *  Scopes are immutable and shared, so a parse result or nested parser can 
+ *  reference the options it knows about by pushing a layer rather than copying
+ *  every list.  Lookups check this layer first and then walk up the parents.
+ */
+class OptionScope
+{
+private:
+    OptionListPtr mOptions;
+    std::shared_ptr<const OptionScope> mParent;
+
+public:
+    OptionScope(OptionListPtr options, std::shared_ptr<const OptionScope> parent = nullptr);
+
+    //! Returns a new scope with `options` in front of `parent`, or just 
+    //! `parent` when there is nothing to add.
+    static std::shared_ptr<const OptionScope> push(
+            std::shared_ptr<const OptionScope> parent, 
+            OptionListPtr options);
+
+    //! The options in this layer.
+    const OptionList& options() const { return *mOptions; }
+
+    //! The next layer out, nullptr for the outermost one.
+    const std::shared_ptr<const OptionScope>& parent() const { return mParent; }
+
+    //! Looks for an option by long name through all layers.
+    const Option* findLongOption(std::string_view optionName) const;
+
+    //! Looks for an option by short name through all layers.
+    const Option* findShortOption(std::string_view optionName) const;
+
+    //! Returns the option lists of all layers, outermost first.
+    std::vector<const OptionList*> layers() const;
 };
 
+//! Shared pointer to an option scope.
+using OptionScopePtr = std::shared_ptr<const OptionScope>;
+
+
+//! Option values and positional arguments stored in a columnar layout.
+/*!
+ *  All values share one character pool, located through an offsets array, and 
+ *  each option found is a record of its id, first value and value count.  This
+ *  avoids a heap allocation per value for command lines with huge numbers of 
+ *  arguments.  Views returned are valid until more values are added.
+ */
+class ColumnarArgs
+{
+public:
+    //! An option found during parsing, referring to a run of values.
+    struct OptionRecord
+    {
+        //! The option's id, global options first followed by command options.
+        std::uint32_t optionId;
+
+        //! The index of the option's first value.
+        std::uint32_t firstValue;
+
+        //! The number of values following the option.
+        std::uint32_t numValues;
+    };
+
+    //! A range of values, iterated as `std::string_view`s.
+    class ValueRange
+    {
+    private:
+        const ColumnarArgs* mArgs;
+        std::size_t mBegin;
+        std::size_t mEnd;
+
+    public:
+        class iterator
+        {
+        private:
+            const ColumnarArgs* mArgs;
+            std::size_t mIndex;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string_view*;
+            using reference = std::string_view;
+
+            iterator(const ColumnarArgs* args, std::size_t index) : mArgs(args), mIndex(index) {}
+
+            std::string_view operator*() const { return mArgs->value(mIndex); }
+            iterator& operator++() { ++mIndex; return *this; }
+            iterator operator++(int) { auto prev = *this; ++mIndex; return prev; }
+            bool operator==(const iterator& other) const { return mIndex == other.mIndex; }
+            bool operator!=(const iterator& other) const { return mIndex != other.mIndex; }
+        };
+
+        ValueRange(const ColumnarArgs* args, std::size_t begin, std::size_t end) 
+            : mArgs(args), mBegin(begin), mEnd(end) {}
+
+        iterator begin() const { return iterator(mArgs, mBegin); }
+        iterator end() const { return iterator(mArgs, mEnd); }
+
+        std::size_t size() const { return mEnd - mBegin; }
+        bool empty() const { return mBegin == mEnd; }
+        std::string_view operator[](std::size_t index) const { return mArgs->value(mBegin + index); }
+    };
+
+private:
+    //! Every value's characters, back to back.
+    std::string mPool;
+
+    //! Value `i` spans `[mOffsets[i], mOffsets[i+1])` in the pool.
+    std::vector<std::size_t> mOffsets = {0};
+
+    std::vector<OptionRecord> mRecords;
+
+    //! The distinct option names found, with each record's name in `mRecordNames`.
+    std::vector<std::string> mOptionNames;
+    std::vector<std::uint32_t> mRecordNames;
+
+    //! Caches the name slot of each option id seen.
+    std::vector<std::uint32_t> mIdNames;
+
+    std::uint32_t nameSlot(std::uint32_t optionId, const std::string& longName);
+
+    //! Values from this index on are positional arguments.
+    std::size_t mFirstPositional = 0;
+    bool mHasPositionals = false;
+
+    void appendValue(std::string_view value);
+
+public:
+    //! The id of options that aren't known to the current parser, e.g. ones 
+    //! found by a parent parser.
+    static constexpr std::uint32_t UnknownOptionId = 0xFFFFFFFF;
+
+    //! Starts a record for an option found, subsequent option values belong to it.
+    void beginOption(std::uint32_t optionId, const std::string& longName);
+
+    //! Adds a value to the most recent option record.
+    void addOptionValue(std::string_view value);
+
+    //! Adds a positional argument, all option values must be added before these.
+    void addPositionalArg(std::string_view value);
+
+    //! Reserves space for a number of additional values and their total character count.
+    void reserve(std::size_t numValues, std::size_t numChars);
+
+    //! Returns the total number of values, option values and positional arguments.
+    std::size_t size() const { return mOffsets.size() - 1; }
+
+    //! Returns a view of a value by index.
+    std::string_view value(std::size_t index) const {
+        return std::string_view(mPool.data() + mOffsets[index], mOffsets[index + 1] - mOffsets[index]);
+    }
+
+    //! Returns the option records, in the order the options were found.
+    const std::vector<OptionRecord>& optionRecords() const { return mRecords; }
+
+    //! Returns the long name of a record's option.
+    const std::string& optionName(const OptionRecord& record) const { 
+        return mOptionNames[mRecordNames[&record - mRecords.data()]]; 
+    }
+
+    //! Reassigns the option ids of all records, used when a nested parser with
+    //! different ids takes over.  Names `lookup` doesn't know get `UnknownOptionId`.
+    void remapOptionIds(const std::function<std::optional<std::size_t> (const std::string&)>& lookup);
+
+    //! Returns the values of an option record.
+    ValueRange values(const OptionRecord& record) const {
+        return ValueRange(this, record.firstValue, record.firstValue + record.numValues);
+    }
+
+    //! Returns the first record of an option by its long name, or nullptr if it wasn't found.
+    const OptionRecord* findOption(const std::string& longName) const;
+
+    //! Returns the positional arguments.
+    ValueRange positionalArgs() const {
+        return ValueRange(this, mHasPositionals ? mFirstPositional : size(), size());
+    }
+};
 
 //! The result of parsing a command line for commands, options and associated 
 //! parameters.
@@ -142,10 +806,31 @@ class ParseResult
 
 private:
     //! We keep track of the options from the parser for use in sub parsing.
-    OptionList optionsList;
+    //! The options known to the parsers that produced this result.
+    OptionScopePtr optionScope;
 
     //! We track the current item position in case of errors.
     std::size_t currItemPos = 0;
+
+    //! Ids of the options found, for checking option constraints.
+    OptionMask presentOptions;
+
+    //! Whether options and positional arguments are stored in `columns`.
+    bool useColumns = false;
+
+    //! Where each option with a repeat policy is in `options`, by long name.
+    std::unordered_map<std::string, std::size_t> mergedOptions;
+
+    //! The positional arguments left in argv for a streaming command.
+    ArgCursor streamArgs;
+    bool hasStreamArgs = false;
+
+    //! The arguments after `--` when the parser passes them through, in argv.
+    const char* const* passThroughTail = nullptr;
+    std::size_t passThroughCount = 0;
+
+    //! Adds a positional argument to whichever storage is in use.
+    void addPositionalArg(std::string_view arg);
     
 public:
     //! Options found, merged result of global and command options.
@@ -161,6 +846,33 @@ public:
     //! List of any errors found during parsing
     std::vector<ParseError> errors;
 
+    //! Option values and positional arguments, when the parser was set to use 
+    //! columnar results.
+    ColumnarArgs columns;
+
+    //! Returns whether the columnar layout was used for this result.
+    bool hasColumns() const { return useColumns; }
+
+    //! Returns whether arguments after `--` were passed through rather than parsed.
+    bool hasPassThrough() const { return passThroughTail != nullptr; }
+
+    //! Returns the arguments after `--`, pointing straight into the original 
+    //! argv.  When that argv came from main it's null terminated, so it can be
+    //! handed to `execvp` as is.
+    char* const* passThroughArgv() const { return const_cast<char* const*>(passThroughTail); }
+
+    //! Returns the number of arguments after `--`.
+    std::size_t passThroughSize() const { return passThroughCount; }
+
+    //! Returns the options known to the parsers that produced this result.
+    const OptionScopePtr& knownOptions() const { return optionScope; }
+
+    //! Returns all the options found as `OptionResult`s, copying any from `columns`.
+    OptionResultList optionResults() const;
+
+    //! Returns all the positional arguments as strings, copying any from `columns`.
+    std::vector<std::string> positionalArgStrings() const;
+
     //! Helper method to check if an error was found during parsing.
     bool hasError() const { return errors.size() > 0; }
 
@@ -181,17 +893,60 @@ public:
     int runCommand() const;
 };
 
+//! Returns the stream command handlers should write their output to.
+/*!
+ *  Defaults to `std::cout`, but is redirected per thread when a command is run
+ *  on behalf of someone else, e.g. by a `CommandServer` streaming output back
+ *  to its client.
+ */
+std::ostream& commandOutput();
+
+//! Redirects `commandOutput()` on the current thread for the lifetime of the object.
+class CommandOutputRedirect
+{
+private:
+    std::ostream* mPrevious;
+
+public:
+    explicit CommandOutputRedirect(std::ostream& out);
+    ~CommandOutputRedirect();
+
+    CommandOutputRedirect(const CommandOutputRedirect&) = delete;
+    CommandOutputRedirect& operator=(const CommandOutputRedirect&) = delete;
+};
+
+//! Marks parsing on the current thread as sharing its parser with other 
+//! threads for the lifetime of the object.
+/*!
+ *  Bound options all write to the one destination, so while this is active 
+ *  parsing a bound option throws a `std::runtime_error` rather than racing 
+ *  other threads.  Used by the front ends that parse concurrently, 
+ *  `CommandServer` and `runBatch`.
+ */
+class SharedParsing
+{
+private:
+    bool mPrevious;
+
+public:
+    SharedParsing();
+    ~SharedParsing();
+
+    SharedParsing(const SharedParsing&) = delete;
+    SharedParsing& operator=(const SharedParsing&) = delete;
+};
+
 //! Definition of a sub command that contains its own functor for execution.
 struct Command 
 {
-    Command(std::string n, std::string h, std::vector<Option> opt, CommandHandler f);
+    Command(std::string n, HelpText h, std::vector<Option> opt, CommandHandler f);
 
     //! The name of the command, i.e. the command line token used to invoke this command.
     std::string name;
     
     //! A description of the command for help text.
     //! `\n` is replaced in the default help formatting with proper indentation.
-    std::string description;
+    HelpText description;
 
     //! A list of options that are specific to this command.
     OptionList options;
@@ -199,12 +954,52 @@ struct Command
     //! The function to call when running this command.  Returns an int to allow returning
     //! the result from main when running the command.
     CommandHandler handler;
+
+    //! Used instead of `handler` when set, the positional arguments are left 
+    //! unparsed and pulled by the handler as it runs.
+    StreamingCommandHandler streamingHandler;
+
+    //! Constraints declared by the command's options, compiled by the parser 
+    //! the command is registered with.
+    ConstraintRules constraintRules;
+};
+
+//! A command registered by name and short help, whose full `Command` is only
+//! built by its factory when it's dispatched or its help is rendered.
+struct LazyCommand
+{
+    LazyCommand(std::string n, std::string h, CommandFactory f);
+
+    //! The name of the command.
+    std::string name;
+
+    //! A one line description shown in the parser's help.
+    std::string shortHelp;
+
+    //! Creates the full command, called at most once.
+    CommandFactory factory;
+
+    //! Returns whether the full command has been built.
+    bool materialized() const { return built.load(std::memory_order_acquire); }
+
+private:
+    friend class Parser;
+
+    std::once_flag once;
+    std::atomic<bool> built{false};
+
+    //! The built command, set once by the parser that dispatches it.
+    CommandPtr command;
+
+    //! Errors compiling the built command's constraints.
+    std::vector<ParserConfigError> configErrors;
 };
 
 //! A special command that actually creates its own parser with its own commands/options.
 struct SubParser 
 {
-    SubParser(std::string n, std::string h, std::vector<Option> opt, SubParserHandler f);
+    SubParser(std::string n, HelpText h, std::vector<Option> opt, SubParserHandler f);
+    SubParser(std::string n, HelpText h, std::vector<Option> opt, SubParserCursorHandler f);
 
     //! The name of the sub parser.  Acts like a command that specifically allows its own
     //! sub parsing call.
@@ -212,7 +1007,7 @@ struct SubParser
 
     //! A description of the sub parsing special command.
     //! `\n` is replaced in the default help formatting with proper indentation.
-    std::string description;
+    HelpText description;
 
     //! A list of options that are specific to this parser.
     OptionList options;
@@ -220,24 +1015,31 @@ struct SubParser
     //! A handling function that can define and run its own parser on the remaining 
     //! command line tokens.
     SubParserHandler handler;
+
+    //! A handling function that continues parsing in place, used instead of 
+    //! `handler` when set.
+    SubParserCursorHandler cursorHandler;
 };
 
 //! A way to group commands that are related semantically.
 class CommandGroup
 {
 private:
-    Parser* mParent;
+    Parser* mParent = nullptr;
+
+    //! Tells the parent parser the group was modified.
+    void parentChanged();
 
 public:
     CommandGroup() = default;
     CommandGroup(Parser* parent) : mParent(parent) {}
-    CommandGroup(Parser* parent, std::string _name, std::string _desc = "");
+    CommandGroup(Parser* parent, std::string _name, HelpText _desc = "");
 
     //! The name of the group of commands, used for grouping commands in help text. 
     std::string name;
 
     //! A description of the group of commands.
-    std::string description;
+    HelpText description;
 
     //! A list of commands in this group
     CommandList commands;
@@ -245,18 +1047,42 @@ public:
     //! A list of subparsers (which are just special commands)
     SubParserList subParsers;
 
+    //! Commands that are built on first use.
+    std::vector<LazyCommandPtr> lazyCommands;
+
     //! Creates a command in the group
-    CommandGroup& command(std::string name, std::string help, CommandHandler func);
+    CommandGroup& command(std::string name, HelpText help, CommandHandler func);
+
+    //! Creates a command in the group that pulls its positional arguments as it runs.
+    CommandGroup& streamingCommand(std::string name, HelpText help, std::vector<Option> options, StreamingCommandHandler func);
+
+    //! Registers a command in the group that is only built by `factory` when first used.
+    CommandGroup& lazyCommand(std::string name, std::string shortHelp, CommandFactory factory);
 
     //! Creates a command in the group, with extra options for the command
-    CommandGroup& command(std::string name, std::string help, std::vector<Option> options, CommandHandler func);
+    CommandGroup& command(std::string name, HelpText help, std::vector<Option> options, CommandHandler func);
+
+    //! Creates a command in the group that includes shared option packs after its own options.
+    CommandGroup& command(
+            std::string name, 
+            HelpText help, 
+            std::vector<Option> options, 
+            std::vector<OptionListPtr> packs, 
+            CommandHandler func);
 
     //! Creates a subparser in the group
-    CommandGroup& subParser(std::string name, std::string help, SubParserHandler func);
+    CommandGroup& subParser(std::string name, HelpText help, SubParserHandler func);
 
     //! Creates a subparser in the group, with extra options for the subparser
-    CommandGroup& subParser(std::string name, std::string help, std::vector<Option> options, SubParserHandler func);
+    CommandGroup& subParser(std::string name, HelpText help, std::vector<Option> options, SubParserHandler func);
 
+    //! Creates a subparser in the group that continues parsing in place.
+    CommandGroup& cursorSubParser(std::string name, HelpText help, SubParserCursorHandler func);
+
+    //! Creates a subparser in the group that continues parsing in place, with extra options.
+    CommandGroup& cursorSubParser(std::string name, HelpText help, std::vector<Option> options, SubParserCursorHandler func);
+
+    //! Finds a command by name, building it if it was registered lazily.
     CommandPtr getCommand(std::string name) const;
 
     //! Ends the group returning a refernce to the parent instantiating parent to allow a fluent interface.
@@ -264,12 +1090,47 @@ public:
 };
 
 
+//! The command found by `Parser::peek`, before any of its arguments are parsed.
+struct PeekResult
+{
+    //! The command token, a view into argv.  Empty when no command was found.
+    std::string_view name;
+
+    //! The command found, nullptr for subparsers and lazy commands that haven't been built.
+    CommandPtr command;
+
+    //! The subparser found, if the command token named one.
+    SubParserPtr subParser;
+
+    //! Whether the command token named a lazily registered command.
+    bool lazyCommand = false;
+
+    //! The argv index of the command token, -1 when no command was found.
+    int commandIndex = -1;
+
+    //! The argv index where the command's arguments start, or where positional
+    //! arguments start when no command was found.
+    int argsIndex = -1;
+
+    //! Returns whether a command or subparser was found.
+    bool found() const { return commandIndex >= 0; }
+};
+
+//! Called by `Parser::peek` for each global option before the command, with 
+//! the option's argv index and the number of values following it.
+using PeekOptionHandler = std::function<void (const Option& option, int optionIndex, int numValues)>;
+
 //! The main parser class that contains sub-parsers, commands, and options to 
 //! aid in parsing a command line.
 class Parser
 {
-    friend class HelpFormatter;
-    friend class DefaultHelpFormatter;
+    friend class CommandGroup;
+    template<typename Derived, typename Style> friend class BasicHelpFormatter;
+    friend class HelpIndex;
+    friend class ParserDefinition;
+    friend class PluginLoader;
+    friend class ReplLine;
+    friend class Schema;
 
 private:
     //! Name of the program
@@ -279,10 +1140,10 @@ private:
     std::string mBanner;
 
     //! A program description printed after the name/banner
-    std::string mDescription;
+    HelpText mDescription;
     
     //! Usage text to show in help after the description
-    std::string mUsage;
+    HelpText mUsage;
 
     //! A list of commands that can be parsed
     CommandList mCommands;
@@ -290,8 +1151,36 @@ private:
     //! A list of subparsers (which are special commands with their own parsers)
     SubParserList mSubParsers;
 
+    //! Ungrouped commands that are built on first use.
+    std::vector<LazyCommandPtr> mLazyCommands;
+
+    //! All lazy commands by name, including grouped ones.
+    std::unordered_map<std::string_view, LazyCommandPtr> mLazyIndex;
+
     //! Global options for the program
-    OptionList mOptions;
+    //! Shared with copies of this parser, replaced rather than modified.
+    OptionListPtr mOptions = std::make_shared<OptionList>();
+
+    //! Options inherited from a parent parser or parse result.
+    OptionScopePtr mInheritedScope;
+
+    //! This parser's options in front of the inherited ones.
+    OptionScopePtr mScope;
+
+    //! Built by the first help search, see `helpIndex`.
+    mutable std::shared_ptr<const HelpIndex> mHelpIndex;
+
+    //! Changed to a value no other parser has had on every modification, so 
+    //! copies only share it while they're unchanged.
+    std::uint64_t mGeneration;
+
+    //! Gives the parser a new generation after a modification.
+    void changed();
+
+    void updateScope();
+
+    //! Returns this parser's options followed by inherited ones, as shown in help.
+    std::vector<Option> helpOptions() const;
 
     //! Any grouped commands
     std::vector<CommandGroup> mGroups;
@@ -299,13 +1188,64 @@ private:
     //! Any parser configuration errors found
     std::vector<ParserConfigError> mConfigErrors;
 
+    //! Whether parse results store values in `ParseResult::columns`.
+    bool mColumnarResults = false;
+
+    //! Whether everything after `--` is left in argv rather than parsed.
+    bool mPassThrough = false;
+
+    //! Whether `ParserDefinition::Flag` exports the parser's definition.
+    bool mDefinitionFlag = false;
+
+    //! Constraints across sets of global options.
+    std::vector<Constraint> mConstraints;
+
+    //! The compiled constraints of the global options.
+    ConstraintRules mConstraintRules;
+
+    //! Configuration errors from compiling constraints, by command name or 
+    //! an empty name for the global options.  Replaced each time a scope is recompiled.
+    std::unordered_map<std::string, std::vector<ParserConfigError>> mConstraintErrors;
+
+    //! Compiles the global constraints and those of every command, used when global
+    //! options change since command option ids follow on from the global ones.
+    void compileConstraints();
+
+    //! Compiles the constraints of a single command's options.
+    void compileCommandConstraints(Command& command);
+
+    //! Includes option packs in a command, reporting any that clash as config errors.
+    void includeOptionPacks(Command& command, const std::vector<OptionListPtr>& packs);
+
+    //! Checks the compiled constraints against the options found.
+    void checkConstraints(ParseResult& result) const;
+
+    //! Combines a repeated option's result with its earlier occurrences.
+    void mergeRepeatedOption(const Option& option, OptionResult optResult, std::size_t optionPos, ParseResult& parseResult) const;
+
     //! Helper method to parse an option, handling potentially command specific options
     //! modifying the deque of command line tokens and adding results to the parseResult.
-    std::optional<OptionResult> parseOption(
+    //! Returns false if no option was parsed.
+    bool parseOption(
             std::shared_ptr<Command> command, 
-            std::deque<std::string>& parseText,
+            ArgCursor& parseText,
             ParseResult& parseResult) const;
 
+    //! Adds a subparser after checking its name.
+    Parser& addSubParser(SubParserPtr subParser);
+
+    //! Adds a command after checking its name.
+    Parser& addCommand(CommandPtr command);
+
+    //! Checks a lazy command's name and indexes it, returning whether it was added.
+    bool addLazyCommand(LazyCommandPtr command);
+
+    //! Builds a lazy command if it hasn't been yet, safe to call from multiple threads.
+    CommandPtr materialize(LazyCommand& command) const;
+
+    //! Prepares a result parsed so far, possibly by another parser, to be continued by this one.
+    void adoptResult(ParseResult& result) const;
+
     //! Checks if a command or subparser name has already been registered with the parser.
     bool checkCommandNameExists(std::string name) const;
 
@@ -313,22 +1253,51 @@ public:
     Parser(std::string programName, std::string banner = "");
 
     //! Sets the parser's description text.
-    Parser& description(std::string d);
+    Parser& description(HelpText d);
     
     //! Sets the parer's usage text.
-    Parser& usage(std::string u);
+    Parser& usage(HelpText u);
 
     //! Creates a command in the parser.
-    Parser& command(std::string name, std::string help, CommandHandler func);
+    Parser& command(std::string name, HelpText help, CommandHandler func);
 
     //! Creates a command in the parser with command specific options.
-    Parser& command(std::string name, std::string help, std::vector<Option> options, CommandHandler func);
+    Parser& command(std::string name, HelpText help, std::vector<Option> options, CommandHandler func);
+
+    //! Creates a command that includes shared option packs after its own options.
+    /*!
+     *  The packs are referenced rather than copied, so a pack attached to many
+     *  commands is only stored once.  See `makeOptionPack`.
+     */
+    Parser& command(
+            std::string name, 
+            HelpText help, 
+            std::vector<Option> options, 
+            std::vector<OptionListPtr> packs, 
+            CommandHandler func);
     
+    //! Creates a command that pulls its positional arguments from a `PositionalStream`
+    //! as it runs, instead of having them all collected during parsing.
+    Parser& streamingCommand(std::string name, HelpText help, StreamingCommandHandler func);
+
+    //! Creates a streaming command with command specific options.
+    Parser& streamingCommand(std::string name, HelpText help, std::vector<Option> options, StreamingCommandHandler func);
+
+    //! Registers a command by name and short help, the full command is only 
+    //! built by `factory` when it's dispatched or its help is rendered.
+    Parser& lazyCommand(std::string name, std::string shortHelp, CommandFactory factory);
+
     //! Creates a subparser (a special type of command) in the parser.
-    Parser& subParser(std::string name, std::string help, SubParserHandler func);
+    Parser& subParser(std::string name, HelpText help, SubParserHandler func);
 
     //! Creates a  subparser (a special type of command) in the parser with command specific options.
-    Parser& subParser(std::string name, std::string help, std::vector<Option> options, SubParserHandler func);
+    Parser& subParser(std::string name, HelpText help, std::vector<Option> options, SubParserHandler func);
+
+    //! Creates a subparser whose handler continues parsing the same tokens and result in place.
+    Parser& cursorSubParser(std::string name, HelpText help, SubParserCursorHandler func);
+
+    //! Creates a subparser whose handler continues parsing in place, with command specific options.
+    Parser& cursorSubParser(std::string name, HelpText help, std::vector<Option> options, SubParserCursorHandler func);
     
     //! Adds a list of options to the parser
     Parser& options(std::vector<Option> options);
@@ -336,38 +1305,102 @@ public:
     //! Adds a list of options to the parser
     Parser& options(const OptionList& options);
 
+    //! Includes a shared option pack in the global options, by reference.
+    Parser& includeOptions(OptionListPtr pack);
+
+    //! Adds constraints across sets of global options, e.g. mutually exclusive ones.
+    Parser& constraints(std::vector<Constraint> constraints);
+
+    //! Sets whether parse results store option values and positional arguments in 
+    //! the contiguous `ParseResult::columns` layout rather than as separate strings.
+    Parser& columnarResults(bool enable = true);
+
+    //! Sets whether parsing stops at a `--`, leaving the arguments after it in 
+    //! argv for `ParseResult::passThroughArgv`, e.g. to exec a child process.
+    //! Only applies when parsing argc and argv, other sources keep treating 
+    //! them as positional arguments.
+    Parser& passThrough(bool enable = true);
+
+    //! Sets whether giving `--argunaught-definition` as the first argument 
+    //! exports the parser's definition as JSON, for tools introspecting the 
+    //! program.  The flag isn't shown in help.  Parsing it skips the rest of 
+    //! the command line and returns a result whose command writes the JSON to
+    //! `commandOutput()`.  Only applies when parsing argc and argv.  See 
+    //! `argunaught/definition.hpp`.
+    Parser& definitionFlag(bool enable = true);
+
     //! Creates a new command group that can have commands or subparsers added to create 
     //! a logical grouping of commands for the program.  Useful for the generation of the help.
     CommandGroup& group(std::string name);
 
     //! Creates a new command group that can have commands or subparsers added to create 
     //! a logical grouping of commands for the program.  Useful for the generation of the help.
-    CommandGroup& group(std::string name, std::string description);
+    CommandGroup& group(std::string name, HelpText description);
 
     //! Returns a const reference to the command list defined for this parser.
     const CommandList& commands() const { return mCommands; }
 
     //! Returns a const reference to the list of global options defined on this parser.
-    const OptionList& options() const { return mOptions; }
+    const OptionList& options() const { return *mOptions; }
+
+    //! Returns this parser's options in front of any inherited ones.
+    OptionScopePtr optionScope() const { return mScope; }
+
+    //! Makes the parent's options available to this parser without copying them.
+    Parser& inheritOptions(const Parser& parent);
 
     //! Looks for a command defined of the parser and returns it, or nullptr if not found.
     CommandPtr getCommand(std::string name) const;
 
+    //! Builds every lazily registered command now, e.g. before forking workers
+    //! so they all share the built commands.
+    void buildLazyCommands() const;
+
+    //! Returns an index for searching the help text of the commands, built on 
+    //! first use and rebuilt if commands have been added since.  Declared in
+    //! `argunaught/help_search.hpp`.
+    std::shared_ptr<const HelpIndex> helpIndex() const;
+
     //! Parses the command line, given argc and argv from main.
     ParseResult parse(int argc, const char* argv[]) const;
 
+    //! Finds the command on a command line without parsing its arguments, 
+    //! skipping over global options first.  Nothing is allocated per token, so
+    //! this is cheap for routing wrappers that hand the command line to 
+    //! another program.
+    PeekResult peek(int argc, const char* argv[], const PeekOptionHandler& onOption = nullptr) const;
+
     //! Parses the given arguments, assumes the executable name has been skipped.
     ParseResult parse(std::deque<std::string> args, OptionResultList existingOptions = {}) const;
 
+    //! Continues parsing from the cursor into an existing result, e.g. one 
+    //! passed to a `SubParserCursorHandler`.  Options already in the result are 
+    //! kept and count towards this parser's constraints.
+    void parseInto(ArgCursor& args, ParseResult& result) const;
+
+    //! Parses a single command line string, splitting it with POSIX shell rules.
+    //
+    //! Like the deque version, the string should not contain the executable name.
+    ParseResult parseCommandLine(std::string_view commandLine) const;
+
+    //! Parses a command line already split with `tokenizeCommandLine`, 
+    //! reading the words in place.
+    ParseResult parseCommandLine(const CommandLineTokens& tokens) const;
+
     //! Allows performing sub command parsing using options from previous 
     //! parser call.
     ParseResult parse(ParseResult const& prevParseResult);
 
     //! Returns if a parser configuration error was found.
-    bool hasConfigurationError() const { return mConfigErrors.size() > 0; }
+    bool hasConfigurationError() const;
 
     //! Returns the list of parser configuration errors found, if any.
-    std::vector<ParserConfigError> parserConfigErrors() const { return mConfigErrors; }
+    std::vector<ParserConfigError> parserConfigErrors() const;
 };
 
 }
+
+// Declared after the parser, as they're templates over it.
+#include "help_search.hpp"
+#include "help_formatter.hpp"
+#include "definition.hpp"
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <istream>
+#include <ostream>
+#include <functional>
+
+#include "argunaught.hpp"
+
+namespace argunaught
+{
+
+//! Settings for running a script of command lines with `runBatch`.
+struct BatchOptions
+{
+    //! The number of worker threads parsing and running command lines.
+    std::size_t numThreads = 4;
+
+    //! Stop running further command lines after the first failure in script order.
+    bool failFast = false;
+
+    //! The maximum number of command lines read ahead of the output, bounding memory use.
+    std::size_t maxInFlight = 4096;
+
+    //! Runs a parsed command line, a non-zero return counts as a failure.  
+    //! Defaults to `ParseResult::runCommand`.
+    std::function<int (const ParseResult&)> dispatch;
+};
+
+//! A summary of a batch run.
+struct BatchResult
+{
+    //! The number of command lines that were run, not counting blank or comment lines.
+    std::size_t commandsRun = 0;
+
+    //! The number of command lines that returned a non-zero exit code.
+    std::size_t commandsFailed = 0;
+
+    //! The exit code of the first failing command line, or 0 if none failed.
+    int exitCode = 0;
+
+    //! The 1-based script line number of the first failure, or 0 if none failed.  
+    //! For a command line continued over several lines, this is where it starts.
+    std::size_t firstFailedLine = 0;
+};
+
+//! Runs a script with one command line per line against a shared parser.
+/*!
+ *  Lines are split with `tokenizeCommandLine`, so quoting and `#` comments 
+ *  work as in a shell script, and blank lines are skipped.  A line ending in
+ *  a backslash, or with a quote left open, continues on the next line.  
+ *  Reading, parsing and running overlap across a pool of threads, while 
+ *  anything each command writes to `commandOutput()` is written to `out` in 
+ *  script order.  A command line that fails to parse isn't run, its errors 
+ *  are written instead and it fails with exit code 1.  The parser and 
+ *  command handlers must be safe to use from multiple threads, so a line 
+ *  giving an option bound with `bindTo` fails the same way.
+ */
+BatchResult runBatch(
+        const Parser& parser, 
+        std::istream& script, 
+        std::ostream& out, 
+        BatchOptions opts = {});
+
+//! Runs a script file with `runBatch`, throwing a `std::runtime_error` if it can't be opened.
+BatchResult runBatchFile(
+        const Parser& parser, 
+        const std::string& path, 
+        std::ostream& out, 
+        BatchOptions opts = {});
+
+}
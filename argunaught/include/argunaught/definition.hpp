@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "argunaught.hpp"
+
+namespace argunaught
+{
+
+//! Writes JSON straight to a stream as it's produced, without building a document.
+/*!
+ *  Values written inside an object must each follow a `key`.  Commas between
+ *  members and elements are added automatically.  Strings are escaped, and
+ *  UTF-8 is passed through as is.
+ */
+class JsonWriter
+{
+private:
+    std::ostream& mOut;
+
+    //! Whether the innermost open object or array already has a member.
+    std::vector<bool> mHasMembers;
+
+    //! Whether a key was just written, so the next value follows it.
+    bool mAfterKey = false;
+
+    //! Writes the comma before a value if it isn't the first in its container.
+    void separate();
+
+    void writeString(std::string_view text);
+
+public:
+    explicit JsonWriter(std::ostream& out) : mOut(out) {}
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    //! Writes a member's key, which the next value belongs to.
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(std::int64_t number);
+    JsonWriter& value(int number) { return value(static_cast<std::int64_t>(number)); }
+    JsonWriter& value(bool flag);
+
+    //! Writes an array of strings.
+    JsonWriter& value(const std::vector<std::string>& texts);
+
+    //! Writes a key followed by its value.
+    template<typename T>
+    JsonWriter& member(std::string_view name, const T& v)
+    {
+        key(name);
+        return value(v);
+    }
+
+    //! Returns whether every object and array has been closed.
+    bool complete() const { return mHasMembers.empty(); }
+};
+
+//! Exports a parser's definition as JSON, e.g. for IDEs and documentation
+//! generators to read rather than scraping help text.
+/*!
+ *  The JSON is in the format `argunaught-gen` reads: the parser's name, banner,
+ *  description and usage, the global options, constraints, commands and
+ *  groups.  Options list `params` (their `maxNumParams`), `minParams`,
+ *  `required`, `repeat`, `conflictsWith` and `dependsOn`.  Commands have a
+ *  `kind` of `command`, `streaming` or `subparser`, along with their options.
+ *
+ *  It's written field by field to the stream without going through help
+ *  formatting.  Lazy commands are built first, like `Schema::serialize`, and
+ *  option binders and handlers aren't exported.
+ */
+class ParserDefinition
+{
+public:
+    //! The argument that makes a parser with `Parser::definitionFlag` enabled
+    //! export its definition, when given as the first argument.
+    static constexpr std::string_view Flag = "--argunaught-definition";
+
+    //! Writes a parser's definition as JSON.
+    static void writeJson(const Parser& parser, std::ostream& out);
+
+    //! Returns a parser's definition as JSON.
+    static std::string json(const Parser& parser);
+};
+
+}
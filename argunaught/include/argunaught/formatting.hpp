@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 #include "forward_decl.hpp"
 
@@ -77,60 +78,33 @@ namespace background
 } // color
 
 
+//! Returns the number of terminal columns a code point takes up: 2 for East
+//! Asian wide and fullwidth characters, 0 for combining marks and controls.
+std::size_t codePointWidth(char32_t cp);
+
+//! Returns the number of terminal columns UTF-8 text takes up.  Each ASCII
+//! byte counts as one column, controls included, as when help is wrapped,
+//! so unlike `codePointWidth` an escape character counts as one column.
+std::size_t displayWidth(std::string_view text);
+
 //! A helper method that handles word wrapping and formatting like embedded `\n`s.
+/*!
+ *  Lines are measured in display columns rather than bytes and only broken 
+ *  between code points, so wide characters and combining marks wrap correctly.
+ */
 std::size_t 
 formatAndAppendText(
         std::string& dest, 
         std::size_t currLineLen,
         std::size_t currIndentAmount,
         std::size_t maxLineLength,
-        std::string value);
-
-class Parser;
-class Option;
-
-//! Base interface for formatting command and option help.
-class HelpFormatter 
-{
-protected:
-    std::string mHelpString;
-    std::size_t mCurrLineLength = 0;
-    std::size_t mCurrIndentAmount = 0;
-
-    std::size_t mMaxLineWidth = 1024;
-
-    virtual void appendText(std::string valuem, bool handleFormatting=false);
-    virtual void newLine();
-    virtual void indent(std::size_t amount);
-
-    //! Finds the longest option/command name
-    std::size_t findMaxOptComLength(Parser& parser, std::size_t indentPerLevel);
+        std::string_view value);
 
-    virtual void optionHelpName(Option const& opt);
-    virtual std::size_t optionHelpNameLength(Option const& opt);
+//! Returns the width of the terminal stdout is connected to, or 0 if it isn't one.
+std::size_t terminalWidth();
 
-    virtual void programName(std::string name) = 0;
-
-    virtual void beginGroup(std::string value) = 0;
-    virtual void endGroup() = 0;
-
-    virtual void commandName(std::string key) = 0;
-    virtual void optionName(std::string key) = 0;
-    virtual void optionDash(bool longDash) = 0;
-    virtual void optionSeperator() = 0;
-
-    virtual void seperator() = 0;
-
-    virtual void groupDescription(std::string value) = 0;
-    virtual void commandDescription(std::string value) = 0;
-    virtual void optionDescription(std::string value) = 0;
-
-    virtual void programDescription(std::string value) = 0;
-    virtual void programUsage(std::string value) = 0;
-
-public:
-    virtual std::string helpString() = 0;;
-};
+//! Returns whether stdout is a tty, i.e. whether help should use ANSI colors.
+bool stdoutIsTTY();
 
 //! Styling options for the default help formatter implementation.
 struct DefaultFormatStyle
@@ -167,46 +141,4 @@ struct DefaultFormatStyle
     std::string optionDescriptionColor = color::ResetColor;
 };
 
-//! Default help formatter using ANSI color sequences if stdout is a tty.
-class DefaultHelpFormatter : public HelpFormatter
-{
-protected:    
-    std::size_t mMaxOptComLength = 0;
-
-    Parser& mParser;
-    DefaultFormatStyle mStyle;
-
-    // A flag for whether we should print out ANSI colors
-    bool mIsTTY = true;
-
-    virtual void generateCommandHelp(CommandPtr com, int maxOptComLength);
-    virtual void generateSubParserHelp(SubParserPtr com, int maxOptComLength);
-
-    void resetColor();
-
-public:
-    DefaultHelpFormatter(Parser& parser, DefaultFormatStyle style = {}, bool forceNoColor=false);
-
-    void programName(std::string name) override;
-
-    void beginGroup(std::string value) override;
-    void endGroup() override;
-
-    void commandName(std::string key) override;
-    void optionName(std::string key) override;
-    void optionDash(bool longDash) override;
-    void optionSeperator() override;
-
-    void seperator() override;
-
-    void groupDescription(std::string value) override;
-    void commandDescription(std::string value) override;
-    void optionDescription(std::string value) override;
-
-    void programDescription(std::string value) override;
-    void programUsage(std::string value) override;
-
-    std::string helpString() override;
-};
-
-}
\ No newline at end of file
+}
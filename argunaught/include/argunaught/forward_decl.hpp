@@ -4,6 +4,9 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <deque>
+#include <optional>
+#include <string_view>
 
 namespace argunaught
 {
@@ -11,22 +14,49 @@ namespace argunaught
 // Forward declarations
 struct Option;
 struct OptionResult;
+class OptionList;
 struct Command;
+struct LazyCommand;
 struct SubParser;
 class ParseResult;
 class Parser;
+class ArgCursor;
+class PositionalStream;
+class HelpIndex;
+struct DefaultFormatStyle;
+
+template<typename Derived = void, typename Style = DefaultFormatStyle>
+class BasicHelpFormatter;
+
+class DefaultHelpFormatter;
 
 //! A collection of options found during parsing.
 using OptionResultList = std::vector<OptionResult>;
 
+//! Writes an option's value straight into a bound destination, returning
+//! false if it can't be converted.  Called once per value, or once with 
+//! `std::nullopt` when the option is given without any values.
+using OptionBinder = std::function<bool (std::optional<std::string_view> value)>;
+
 //! A standard command that runs like a miniature main
 using CommandHandler = std::function<int (const ParseResult&)>;
 
+//! A command handler that pulls its positional arguments from a stream as it 
+//! goes, rather than having them all collected first.
+using StreamingCommandHandler = std::function<int (const ParseResult&, PositionalStream&)>;
+
 //! A command that is expected to instantiate a parser in its handler to 
 //! parse the remaining positional arguments to allow breaking sets of 
 //! commands into sub groups.
 using SubParserHandler = std::function<ParseResult (const Parser& parent, OptionResultList foundOptions, std::deque<std::string> args)>;
 
+//! A sub parser handler that continues parsing the parent's tokens in place.
+//!
+//! The handler receives the cursor positioned after the sub parser's name and 
+//! the result parsed so far, and typically calls `Parser::parseInto` with both
+//! so nested parsing never copies tokens or earlier results.
+using SubParserCursorHandler = std::function<void (const Parser& parent, ArgCursor& args, ParseResult& result)>;
+
 //! Shared pointer to a command object
 using ParserPtr = std::shared_ptr<Parser>;
 
@@ -36,6 +66,12 @@ using CommandPtr = std::shared_ptr<Command>;
 //! A list of command object pointers
 using CommandList = std::vector<CommandPtr>;
 
+//! Builds the full command for a lazily registered one.
+using CommandFactory = std::function<CommandPtr ()>;
+
+//! Shared pointer to a lazily registered command
+using LazyCommandPtr = std::shared_ptr<LazyCommand>;
+
 //! Shared pointer to a subparser
 using SubParserPtr = std::shared_ptr<SubParser>;
 
@@ -0,0 +1,546 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "argunaught.hpp"
+#include "formatting.hpp"
+#include "help_search.hpp"
+
+namespace argunaught
+{
+
+//! Formats command and option help, with its hooks resolved at compile time.
+/*!
+ *  The layout calls a hook for each fragment of help, e.g. `commandName` or
+ *  `optionDescription`, through `Derived` rather than virtually.  A formatter
+ *  customizes its output by deriving with itself as `Derived` and redefining
+ *  any of the public hooks; `void` uses the defaults:
+ *
+ *      class PlainFormatter : public BasicHelpFormatter<PlainFormatter>
+ *      {
+ *      public:
+ *          using BasicHelpFormatter::BasicHelpFormatter;
+ *          void commandName(std::string_view name) { indent(4); appendText(name); }
+ *      };
+ *
+ *  `Style` supplies the spacing, separators and colors with the members of
+ *  `DefaultFormatStyle`, which may be `static constexpr`, e.g.
+ *  `std::string_view`s, to fix the style at compile time.
+ *
+ *  Fragments are passed as `std::string_view`s and appended to a buffer
+ *  reserved from an estimate of the help's size, so rendering doesn't copy
+ *  names or grow the buffer as it goes.
+ */
+template<typename Derived, typename Style>
+class BasicHelpFormatter
+{
+protected:
+    using Self = std::conditional_t<std::is_void_v<Derived>, BasicHelpFormatter, Derived>;
+
+    //! Escape sequences around each colored fragment, counted when estimating.
+    static constexpr std::size_t ColorOverhead = 16;
+
+    std::string mHelpString;
+    std::size_t mCurrLineLength = 0;
+    std::size_t mCurrIndentAmount = 0;
+
+    std::size_t mMaxLineWidth = 1024;
+    std::size_t mMaxOptComLength = 0;
+
+    Parser& mParser;
+    Style mStyle;
+
+    // A flag for whether we should print out ANSI colors
+    bool mIsTTY = true;
+
+    //! Holds a compressed description while it's formatted.
+    std::string mStorage;
+
+    Self& self() { return static_cast<Self&>(*this); }
+
+    void appendText(std::string_view value, bool handleFormatting=false)
+    {
+        if(handleFormatting) {
+            mCurrLineLength = formatAndAppendText(mHelpString, mCurrLineLength, mCurrIndentAmount, mMaxLineWidth, value);
+        }
+        else {
+            // For unformatted text, simply append and update the current line length.
+            mHelpString.append(value);
+            mCurrLineLength += fragmentWidth(value);
+        }
+    }
+
+    //! The display width of a fragment, inline for the usual ASCII names.
+    static std::size_t fragmentWidth(std::string_view value)
+    {
+        for(char ch : value) {
+            if(static_cast<unsigned char>(ch) >= 0x80) return displayWidth(value);
+        }
+        return value.size();
+    }
+
+    void newLine()
+    {
+        mHelpString += '\n';
+        mCurrLineLength = 0;
+    }
+
+    void indent(std::size_t amount)
+    {
+        mHelpString.append(amount, ' ');
+        mCurrLineLength += amount;
+    }
+
+    //! Starts a colored fragment, if colors are enabled.
+    void beginColor(std::string_view color)
+    {
+        if(mIsTTY) {
+            mHelpString += color::ResetColor;
+            mHelpString.append(color);
+        }
+    }
+
+    void resetColor()
+    {
+        if(mIsTTY) {
+            mHelpString += color::ResetColor;
+        }
+    }
+
+    void optionHelpName(const Option& opt)
+    {
+        self().optionDash(true);
+        self().optionName(opt.longName);
+
+        if(opt.shortName.size() != 0) {
+            self().optionSeperator();
+
+            self().optionDash(false);
+            self().optionName(opt.shortName);
+        }
+    }
+
+    static std::size_t optionHelpNameLength(const Option& opt)
+    {
+        std::size_t length = 2 + opt.longName.size();
+        if(opt.shortName.size() != 0) {
+            length += 3 + opt.shortName.size();
+        }
+        return length;
+    }
+
+    //! Finds the longest option/command name
+    std::size_t findMaxOptComLength() const
+    {
+        std::size_t maxOptComLength = 0;
+        for(const auto& opt : mParser.helpOptions()) {
+            maxOptComLength = std::max(maxOptComLength, optionHelpNameLength(opt));
+        }
+
+        auto addCommands = [&] (const CommandList& commands, const std::vector<LazyCommandPtr>& lazyCommands) {
+            for(const auto& com : commands) {
+                maxOptComLength = std::max(maxOptComLength, com->name.size());
+                for(const auto& opt : com->options) {
+                    maxOptComLength = std::max(maxOptComLength, optionHelpNameLength(opt) + mStyle.spacesPerIndentLevel);
+                }
+            }
+
+            // Lazy commands only show their name until they're built.
+            for(const auto& com : lazyCommands) {
+                maxOptComLength = std::max(maxOptComLength, com->name.size());
+            }
+        };
+
+        addCommands(mParser.mCommands, mParser.mLazyCommands);
+        for(const auto& group : mParser.mGroups) {
+            addCommands(group.commands, group.lazyCommands);
+        }
+
+        return maxOptComLength;
+    }
+
+    //! Estimates the size of a line of help with a description.
+    std::size_t estimateLine(std::size_t descriptionSize) const
+    {
+        auto size = mStyle.initialIndentLevel + mStyle.spacesPerIndentLevel + mMaxOptComLength +
+                    std::string_view(mStyle.separator).size() + descriptionSize + descriptionSize / 8 + 1;
+        return mIsTTY ? size + 6 * ColorOverhead : size;
+    }
+
+    std::size_t estimateOptions(const OptionList& options) const
+    {
+        std::size_t size = 0;
+        for(const auto& opt : options) {
+            size += estimateLine(opt.description.size());
+        }
+        return size;
+    }
+
+    //! Estimates the size of the full help, without decompressing descriptions.
+    std::size_t estimateSize() const
+    {
+        auto size = estimateLine(mParser.mName.size() + mParser.mBanner.size()) +
+                    estimateLine(mParser.mDescription.size()) + estimateLine(mParser.mUsage.size());
+        for(const auto& opt : mParser.helpOptions()) {
+            size += estimateLine(opt.description.size());
+        }
+
+        auto addCommands = [&] (const CommandList& commands,
+                                const std::vector<LazyCommandPtr>& lazyCommands,
+                                const SubParserList& subParsers) {
+            for(const auto& com : commands) {
+                size += estimateLine(com->description.size()) + estimateOptions(com->options);
+            }
+            for(const auto& com : lazyCommands) {
+                size += estimateLine(com->shortHelp.size());
+            }
+            for(const auto& sub : subParsers) {
+                size += estimateLine(sub->description.size()) + estimateOptions(sub->options);
+            }
+        };
+
+        addCommands(mParser.mCommands, mParser.mLazyCommands, mParser.mSubParsers);
+        for(const auto& group : mParser.mGroups) {
+            size += estimateLine(group.name.size()) + estimateLine(group.description.size());
+            addCommands(group.commands, group.lazyCommands, group.subParsers);
+        }
+
+        return size;
+    }
+
+    //! Justifies the description following a name of `nameLength` already on the line.
+    void justify(std::size_t nameLength, std::size_t maxOptComLength)
+    {
+        if(nameLength < maxOptComLength) {
+            indent(maxOptComLength - nameLength);
+        }
+
+        mCurrIndentAmount = maxOptComLength + mStyle.initialIndentLevel + std::string_view(mStyle.separator).size();
+        self().seperator();
+    }
+
+    void generateOptionsHelp(const OptionList& options, std::size_t maxOptComLength)
+    {
+        // Print any command specific options with an extra level of indentation
+        for(const auto& opt : options) {
+            indent(mStyle.initialIndentLevel + mStyle.spacesPerIndentLevel);
+            optionHelpName(opt);
+
+            if(!opt.description.empty()) {
+                justify(optionHelpNameLength(opt) + mStyle.spacesPerIndentLevel, maxOptComLength);
+                self().optionDescription(opt.description.view(mStorage));
+            }
+            newLine();
+        }
+    }
+
+    void generateCommandHelp(const Command& com, std::size_t maxOptComLength)
+    {
+        self().commandName(com.name);
+        if(!com.description.empty()) {
+            justify(com.name.size(), maxOptComLength);
+            self().commandDescription(com.description.view(mStorage));
+        }
+
+        newLine();
+        generateOptionsHelp(com.options, maxOptComLength);
+    }
+
+    void generateLazyCommandHelp(const LazyCommand& com, std::size_t maxOptComLength)
+    {
+        self().commandName(com.name);
+        if(!com.shortHelp.empty()) {
+            justify(com.name.size(), maxOptComLength);
+            self().commandDescription(com.shortHelp);
+        }
+
+        newLine();
+    }
+
+    void generateSubParserHelp(const SubParser& com, std::size_t maxOptComLength)
+    {
+        self().commandName(com.name);
+        if(!com.description.empty()) {
+            justify(com.name.size(), maxOptComLength);
+            self().commandDescription(com.description.view(mStorage));
+        }
+
+        newLine();
+        generateOptionsHelp(com.options, maxOptComLength);
+    }
+
+    void generateCommands(const CommandList& commands,
+                          const std::vector<LazyCommandPtr>& lazyCommands,
+                          const SubParserList& subParsers)
+    {
+        for(const auto& com : commands) {
+            self().generateCommandHelp(*com, mMaxOptComLength);
+        }
+
+        for(const auto& com : lazyCommands) {
+            self().generateLazyCommandHelp(*com, mMaxOptComLength);
+        }
+
+        for(const auto& sub : subParsers) {
+            self().generateSubParserHelp(*sub, mMaxOptComLength);
+        }
+    }
+
+    //! Appends a colored fragment.
+    void coloredText(std::string_view color, std::string_view value, bool handleFormatting=false)
+    {
+        beginColor(color);
+        appendText(value, handleFormatting);
+        resetColor();
+    }
+
+public:
+    BasicHelpFormatter(Parser& parser, Style style = {}, bool forceNoColor=false)
+        : mParser(parser),
+          mStyle(std::move(style))
+    {
+        mMaxOptComLength = std::max(findMaxOptComLength(), static_cast<std::size_t>(mStyle.maxJustified));
+        mIsTTY = !forceNoColor && stdoutIsTTY();
+        mMaxLineWidth = std::min(static_cast<std::size_t>(mStyle.maxLineLength), terminalWidth()-1);
+    }
+
+    // Hooks for each fragment of help, which `Derived` can redefine.
+
+    void programName(std::string_view name)
+    {
+        coloredText(mStyle.programNameColor, name);
+        newLine();
+    }
+
+    void beginGroup(std::string_view value)
+    {
+        newLine();
+        beginColor(mStyle.groupNameColor);
+        appendText(value);
+        appendText(mStyle.groupNameSuffix);
+        resetColor();
+        newLine();
+    }
+
+    void endGroup()
+    {
+        mHelpString += "\n";
+    }
+
+    void commandName(std::string_view key)
+    {
+        indent(mStyle.initialIndentLevel);
+        coloredText(mStyle.commandNameColor, key);
+    }
+
+    void optionName(std::string_view key) { coloredText(mStyle.optionNameColor, key); }
+    void optionDash(bool longDash) { coloredText(mStyle.optionDashColor, longDash ? "--" : "-"); }
+    void optionSeperator() { coloredText(mStyle.optionSeparatorColor, mStyle.optionSeparator); }
+    void seperator() { coloredText(mStyle.separatorColor, mStyle.separator); }
+
+    void groupDescription(std::string_view value) { coloredText(mStyle.groupDescriptionColor, value, true); }
+    void commandDescription(std::string_view value) { coloredText(mStyle.commandDescriptionColor, value, true); }
+    void optionDescription(std::string_view value) { coloredText(mStyle.optionDescriptionColor, value, true); }
+
+    void programDescription(std::string_view value)
+    {
+        beginColor(mStyle.programDescriptionColor);
+        appendText(value, true);
+        newLine();
+        resetColor();
+    }
+
+    void programUsage(std::string_view value)
+    {
+        beginColor(mStyle.programUsageColor);
+        appendText(value, true);
+        newLine();
+        resetColor();
+    }
+
+    std::string helpString()
+    {
+        mHelpString.clear();
+        mHelpString.reserve(estimateSize());
+        mCurrLineLength = 0;
+
+        self().programName(mParser.mBanner != "" ? mParser.mBanner : mParser.mName);
+
+        if(!mParser.mDescription.empty()) {
+            self().programDescription(mParser.mDescription.view(mStorage));
+        }
+
+        if(!mParser.mUsage.empty()) {
+            self().programUsage(mParser.mUsage.view(mStorage));
+        }
+
+        // Now build up the help string.
+        auto globalOptions = mParser.helpOptions();
+        if(globalOptions.size() > 0) {
+            self().beginGroup(std::string_view("Global Options"));
+            for(const auto& opt : globalOptions) {
+                indent(mStyle.initialIndentLevel);
+                optionHelpName(opt);
+                auto optLen = optionHelpNameLength(opt);
+
+                if(!opt.description.empty()) {
+                    justify(optLen, mMaxOptComLength);
+                    self().optionDescription(opt.description.view(mStorage));
+                }
+                else if(optLen < mMaxOptComLength) {
+                    indent(mMaxOptComLength - optLen);
+                }
+
+                newLine();
+            }
+        }
+
+        if(mParser.mCommands.size() > 0 || mParser.mLazyCommands.size() > 0) {
+            self().beginGroup(std::string_view("Commands"));
+            generateCommands(mParser.mCommands, mParser.mLazyCommands, mParser.mSubParsers);
+        }
+
+        for(const auto& group : mParser.mGroups) {
+            self().beginGroup(group.name);
+            if(!group.description.empty()) {
+                indent(mStyle.initialIndentLevel);
+                mCurrIndentAmount = mStyle.initialIndentLevel;
+
+                self().groupDescription(group.description.view(mStorage));
+
+                newLine();
+                newLine();
+            }
+
+            generateCommands(group.commands, group.lazyCommands, group.subParsers);
+        }
+
+        newLine();
+        return std::move(mHelpString);
+    }
+
+    //! Returns the full help for a single command, building it if it was registered lazily.
+    std::string commandHelpString(const std::string& name)
+    {
+        mHelpString.clear();
+        mCurrLineLength = 0;
+
+        auto com = mParser.getCommand(name);
+        if(com == nullptr) {
+            return mHelpString;
+        }
+
+        std::size_t maxOptComLength = std::max(com->name.size(), static_cast<std::size_t>(mStyle.maxJustified));
+        for(const auto& opt : com->options) {
+            maxOptComLength = std::max(maxOptComLength, optionHelpNameLength(opt) + mStyle.spacesPerIndentLevel);
+        }
+
+        mHelpString.reserve(estimateLine(com->description.size()) + estimateOptions(com->options));
+        self().generateCommandHelp(*com, maxOptComLength);
+        return std::move(mHelpString);
+    }
+
+    //! Returns the help of only the commands best matching `query`, found with
+    //! the parser's `helpIndex`, e.g. for a `help --search` command.  Lazy
+    //! commands show their short help and aren't built.
+    std::string searchHelpString(const std::string& query, std::size_t maxResults = 20)
+    {
+        mHelpString.clear();
+        mCurrLineLength = 0;
+
+        auto hits = mParser.helpIndex()->search(query, maxResults);
+
+        // Justify across the matches only.
+        std::size_t maxOptComLength = mStyle.maxJustified;
+        for(const auto& hit : hits) {
+            maxOptComLength = std::max(maxOptComLength, hit.name.size());
+            const OptionList* options = hit.command != nullptr ? &hit.command->options :
+                                        hit.subParser != nullptr ? &hit.subParser->options : nullptr;
+            if(options != nullptr) {
+                for(const auto& opt : *options) {
+                    maxOptComLength = std::max(maxOptComLength, optionHelpNameLength(opt) + mStyle.spacesPerIndentLevel);
+                }
+            }
+        }
+
+        for(const auto& hit : hits) {
+            switch(hit.kind)
+            {
+                case HelpSearchKind::Command:
+                    self().generateCommandHelp(*hit.command, maxOptComLength);
+                    break;
+
+                case HelpSearchKind::LazyCommand:
+                    self().generateLazyCommandHelp(*hit.lazyCommand, maxOptComLength);
+                    break;
+
+                case HelpSearchKind::SubParser:
+                    self().generateSubParserHelp(*hit.subParser, maxOptComLength);
+                    break;
+            }
+        }
+
+        return std::move(mHelpString);
+    }
+};
+
+// Compiled once in the library.
+extern template class BasicHelpFormatter<void, DefaultFormatStyle>;
+
+//! The default help formatter, with ANSI colors if stdout is a tty.
+/*!
+ *  Renders the same help as `BasicHelpFormatter<>`, but calls its hooks
+ *  virtually with `std::string`s as the earlier `DefaultHelpFormatter` did,
+ *  so formatters that derive from it and override them keep working.  Its
+ *  other members, e.g. `appendText` and `generateCommandHelp`, are no longer
+ *  virtual.  New formatters should derive from `BasicHelpFormatter` instead,
+ *  which avoids the virtual calls and copies.
+ */
+class DefaultHelpFormatter : public BasicHelpFormatter<DefaultHelpFormatter>
+{
+    friend class BasicHelpFormatter<DefaultHelpFormatter>;
+    using Base = BasicHelpFormatter<DefaultHelpFormatter>;
+
+public:
+    DefaultHelpFormatter(Parser& parser, DefaultFormatStyle style = {}, bool forceNoColor=false)
+        : Base(parser, std::move(style), forceNoColor)
+    {
+    }
+
+    virtual ~DefaultHelpFormatter() = default;
+
+    // Called by the layout, forwarding each fragment to the virtual hook.
+    void programName(std::string_view name) { programName(std::string(name)); }
+    void beginGroup(std::string_view value) { beginGroup(std::string(value)); }
+    void commandName(std::string_view key) { commandName(std::string(key)); }
+    void optionName(std::string_view key) { optionName(std::string(key)); }
+    void groupDescription(std::string_view value) { groupDescription(std::string(value)); }
+    void commandDescription(std::string_view value) { commandDescription(std::string(value)); }
+    void optionDescription(std::string_view value) { optionDescription(std::string(value)); }
+    void programDescription(std::string_view value) { programDescription(std::string(value)); }
+    void programUsage(std::string_view value) { programUsage(std::string(value)); }
+
+    virtual void programName(std::string name);
+
+    virtual void beginGroup(std::string value);
+    virtual void endGroup();
+
+    virtual void commandName(std::string key);
+    virtual void optionName(std::string key);
+    virtual void optionDash(bool longDash);
+    virtual void optionSeperator();
+
+    virtual void seperator();
+
+    virtual void groupDescription(std::string value);
+    virtual void commandDescription(std::string value);
+    virtual void optionDescription(std::string value);
+
+    virtual void programDescription(std::string value);
+    virtual void programUsage(std::string value);
+};
+
+}
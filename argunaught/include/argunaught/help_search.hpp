@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "forward_decl.hpp"
+
+namespace argunaught
+{
+
+//! What a help search hit refers to.
+enum class HelpSearchKind
+{
+    Command,
+    LazyCommand,
+    SubParser,
+};
+
+//! A command found by a help search.
+struct HelpSearchHit
+{
+    HelpSearchKind kind = HelpSearchKind::Command;
+    std::string name;
+
+    //! The name of the command's group, empty if it isn't grouped.
+    std::string group;
+
+    //! How many of the query's terms matched, hits matching more rank first.
+    std::size_t matchedTerms = 0;
+    double score = 0.0;
+
+    //! The matched command, set according to `kind`.
+    CommandPtr command;
+    LazyCommandPtr lazyCommand;
+    SubParserPtr subParser;
+};
+
+//! An inverted index over a parser's help text, for searching large command trees.
+/*!
+ *  Indexes the words of command names, group names and descriptions, option
+ *  names and option descriptions, weighted by where they appear.  Names are
+ *  also indexed whole, and words are split on anything but letters and digits.
+ *  Lazy commands are indexed by their name and short help without being built.
+ *
+ *  Query terms match indexed words exactly or, for less, as a prefix.  Hits
+ *  are ranked by how many terms matched and then by the summed weights.
+ */
+class HelpIndex
+{
+private:
+    struct Document
+    {
+        HelpSearchKind kind;
+        std::string group;
+        CommandPtr command;
+        LazyCommandPtr lazyCommand;
+        SubParserPtr subParser;
+    };
+
+    struct Posting
+    {
+        std::uint32_t document;
+        float weight;
+    };
+
+    std::vector<Document> mDocuments;
+
+    //! Sorted words, each with the documents containing it.
+    std::vector<std::string> mTerms;
+    std::vector<std::vector<Posting>> mPostings;
+
+    //! The generation of the parser the index was built from.
+    std::uint64_t mGeneration = 0;
+
+    const std::string& documentName(const Document& doc) const;
+
+public:
+    //! Builds an index over the commands and subparsers of a parser.
+    static std::shared_ptr<const HelpIndex> build(const Parser& parser);
+
+    //! Returns whether the parser hasn't been modified since the index was built.
+    //! Changes made directly to a group's public lists aren't seen.
+    bool isCurrent(const Parser& parser) const;
+
+    //! Finds the commands best matching the words of `query`, best first.
+    std::vector<HelpSearchHit> search(std::string_view query, std::size_t maxResults = 20) const;
+
+    std::size_t numDocuments() const { return mDocuments.size(); }
+    std::size_t numTerms() const { return mTerms.size(); }
+};
+
+}
+
+// The parser, for those including only this header.
+#include "argunaught.hpp"
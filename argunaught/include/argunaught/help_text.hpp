@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace argunaught
+{
+
+class HelpResource;
+
+//! Help text such as a description, either stored inline or as a reference
+//! into a compressed `HelpResource`.
+/*!
+ *  Converts implicitly from and to `std::string`, and supports the comparisons,
+ *  concatenation, streaming and `c_str` that descriptions were used with as
+ *  strings.  Referenced text is only decompressed when it's read, e.g. when
+ *  help is rendered.
+ */
+class HelpText
+{
+private:
+    struct Reference
+    {
+        const HelpResource* resource = nullptr;
+        std::uint32_t id = 0;
+
+        //! The decompressed text once `c_str` has needed it.
+        mutable std::shared_ptr<const std::string> text;
+    };
+
+    std::variant<std::string, Reference> mValue;
+
+public:
+    HelpText() = default;
+    HelpText(std::string text) : mValue(std::move(text)) {}
+    HelpText(const char* text) : mValue(std::string(text)) {}
+
+    //! References text `id` of a resource, which must outlive this text.
+    HelpText(const HelpResource& resource, std::uint32_t id);
+
+    //! Returns whether the text is a reference into a resource.
+    bool isReference() const { return std::holds_alternative<Reference>(mValue); }
+
+    //! Returns whether the text is empty, without decompressing it.
+    bool empty() const;
+
+    //! Returns the length of the text, without decompressing it.
+    std::size_t size() const;
+
+    //! Returns the text, decompressing it if it's a reference.
+    std::string str() const;
+
+    //! Returns a view of the text, decompressing it into `storage` if it's a
+    //! reference so inline text isn't copied.
+    std::string_view view(std::string& storage) const;
+
+    //! Returns the text as a C string that lives as long as this text.  A
+    //! referenced text is decompressed the first time and then kept.
+    const char* c_str() const;
+
+    operator std::string() const { return str(); }
+
+    // Friends so they're only found for help texts, rather than for anything
+    // that converts to one.  The templates take strings and string literals, 
+    // which would otherwise be ambiguous between the other overloads.
+    template<typename T>
+    using EnableIfStringLike = std::enable_if_t<std::is_convertible_v<const T&, std::string_view>, int>;
+
+    friend bool operator==(const HelpText& lhs, const HelpText& rhs);
+    friend bool operator!=(const HelpText& lhs, const HelpText& rhs);
+    friend bool operator==(const HelpText& lhs, std::string_view rhs);
+    friend bool operator!=(const HelpText& lhs, std::string_view rhs);
+
+    template<typename T, EnableIfStringLike<T> = 0>
+    friend bool operator==(const HelpText& lhs, const T& rhs) { return lhs == std::string_view(rhs); }
+
+    template<typename T, EnableIfStringLike<T> = 0>
+    friend bool operator!=(const HelpText& lhs, const T& rhs) { return lhs != std::string_view(rhs); }
+
+    template<typename T, EnableIfStringLike<T> = 0>
+    friend bool operator==(const T& lhs, const HelpText& rhs) { return rhs == std::string_view(lhs); }
+
+    template<typename T, EnableIfStringLike<T> = 0>
+    friend bool operator!=(const T& lhs, const HelpText& rhs) { return rhs != std::string_view(lhs); }
+
+    friend std::ostream& operator<<(std::ostream& out, const HelpText& text);
+
+    friend std::string operator+(const HelpText& lhs, const HelpText& rhs);
+    friend std::string operator+(const HelpText& lhs, std::string_view rhs);
+    friend std::string operator+(std::string_view lhs, const HelpText& rhs);
+
+    template<typename T, EnableIfStringLike<T> = 0>
+    friend std::string operator+(const HelpText& lhs, const T& rhs) { return lhs + std::string_view(rhs); }
+
+    template<typename T, EnableIfStringLike<T> = 0>
+    friend std::string operator+(const T& lhs, const HelpText& rhs) { return std::string_view(lhs) + rhs; }
+};
+
+//! A read-only, compressed blob of help texts, e.g. embedded in the binary.
+/*!
+ *  Texts are packed into blocks of around `BlockSize` bytes that are
+ *  compressed independently with a small LZ77 scheme.  Reading a text only
+ *  decompresses its block, and the last block read is kept for the texts
+ *  after it, since help is usually rendered in registration order.
+ *
+ *  Blobs are made with `compress`, e.g. by a build step that writes them out
+ *  as an array, and use the byte order of the machine that made them.
+ */
+class HelpResource
+{
+private:
+    const char* mData = nullptr;
+    std::size_t mSize = 0;
+    std::uint32_t mNumTexts = 0;
+    std::uint32_t mNumBlocks = 0;
+
+    //! The most recently decompressed block.
+    mutable std::mutex mCacheMutex;
+    mutable std::uint32_t mCachedBlock = 0xFFFFFFFF;
+    mutable std::string mCache;
+
+    template<typename T>
+    T read(std::size_t offset) const;
+
+public:
+    //! The uncompressed size blocks are filled up to.
+    static constexpr std::size_t BlockSize = 16 * 1024;
+
+    //! Compresses texts into a blob, text `n` having id `n`.
+    static std::string compress(const std::vector<std::string>& texts);
+
+    //! Reads a blob, which must outlive the resource.  Throws a
+    //! `std::runtime_error` if it isn't a valid help resource.
+    HelpResource(const void* data, std::size_t size);
+
+    HelpResource(const HelpResource&) = delete;
+    HelpResource& operator=(const HelpResource&) = delete;
+
+    //! The number of texts in the resource.
+    std::size_t size() const { return mNumTexts; }
+
+    //! The length of a text, without decompressing it.
+    std::size_t length(std::uint32_t id) const;
+
+    //! Decompresses a text.  Throws a `std::runtime_error` if its block is corrupt.
+    std::string text(std::uint32_t id) const;
+
+    //! Returns a reference to a text, to register as a description.
+    HelpText at(std::uint32_t id) const { return HelpText(*this, id); }
+};
+
+}
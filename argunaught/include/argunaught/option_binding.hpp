@@ -0,0 +1,108 @@
+#pragma once
+
+#include <charconv>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "forward_decl.hpp"
+
+namespace argunaught
+{
+
+namespace detail
+{
+
+inline bool
+convertValue(std::string_view text, std::string& dest)
+{
+    dest = std::string(text);
+    return true;
+}
+
+inline bool
+convertValue(std::string_view text, bool& dest)
+{
+    if(text == "true" || text == "1" || text == "yes" || text == "on") {
+        dest = true;
+        return true;
+    }
+
+    if(text == "false" || text == "0" || text == "no" || text == "off") {
+        dest = false;
+        return true;
+    }
+
+    return false;
+}
+
+//! Integers and floating point values, which must use up the whole token.
+template<typename T>
+std::enable_if_t<std::is_arithmetic_v<T>, bool>
+convertValue(std::string_view text, T& dest)
+{
+    // from_chars doesn't accept a leading '+'.
+    if(!text.empty() && text[0] == '+') {
+        text.remove_prefix(1);
+    }
+
+    T value{};
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if(ec != std::errc() || end != text.data() + text.size()) {
+        return false;
+    }
+
+    dest = value;
+    return true;
+}
+
+//! Each value given is appended.
+template<typename T>
+bool
+convertValue(std::string_view text, std::vector<T>& dest)
+{
+    T value{};
+    if(!convertValue(text, value)) {
+        return false;
+    }
+
+    dest.push_back(std::move(value));
+    return true;
+}
+
+template<typename T>
+bool
+convertValue(std::string_view text, std::optional<T>& dest)
+{
+    T value{};
+    if(!convertValue(text, value)) {
+        return false;
+    }
+
+    dest = std::move(value);
+    return true;
+}
+
+//! Creates the binder writing into `dest`.  An option given without any value
+//! sets a bound `bool` and leaves anything else untouched.
+template<typename T>
+OptionBinder
+makeBinder(T& dest)
+{
+    return [&dest] (std::optional<std::string_view> value) {
+        if(!value.has_value()) {
+            if constexpr(std::is_same_v<T, bool>) {
+                dest = true;
+            }
+            return true;
+        }
+
+        return convertValue(value.value(), dest);
+    };
+}
+
+}
+
+}
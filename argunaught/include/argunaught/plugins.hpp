@@ -0,0 +1,105 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "argunaught.hpp"
+
+//! Version of the plugin registration interface, plugins built against a
+//! different version are skipped.
+#define ARGUNAUGHT_PLUGIN_ABI_VERSION 1
+
+//! Defines a plugin's registration entry point, registering its commands and
+//! subparsers into the given parser, e.g.
+//!
+//!     ARGUNAUGHT_PLUGIN(parser) {
+//!         parser.command("hello", "Says hello", handler);
+//!     }
+#define ARGUNAUGHT_PLUGIN(parserName) \
+    extern "C" int argunaught_plugin_abi_version() { return ARGUNAUGHT_PLUGIN_ABI_VERSION; } \
+    extern "C" void argunaught_register_plugin(argunaught::Parser& parserName)
+
+namespace argunaught
+{
+
+namespace detail
+{
+class PluginLibraries;
+}
+
+//! What the discovery index knows about a plugin command, without loading it.
+struct PluginCommandInfo
+{
+    //! The command name.
+    std::string name;
+
+    //! The first line of the command's description.
+    std::string shortHelp;
+
+    //! Path of the shared object providing the command.
+    std::string library;
+
+    //! The command's options, e.g. `--name,-n --verbose`.
+    std::string optionsSummary;
+
+    //! Whether the command is a subparser.
+    bool isSubParser = false;
+};
+
+//! Discovers commands in a directory of shared object plugins.
+/*!
+ *  Each plugin exports the entry point defined with `ARGUNAUGHT_PLUGIN`.  The
+ *  commands found are cached in an index file keyed by each library's
+ *  modification time and size, so later runs only load plugins that changed.
+ *  Commands registered from the index are lazy: dispatching one loads just the
+ *  library providing it, and help is served from the index alone.
+ *
+ *  Plugins call into the argunaught library of the host, so executables using
+ *  plugins should export their symbols, e.g. with CMake's `ENABLE_EXPORTS`.
+ *  Loaded libraries stay loaded for the life of the process.
+ */
+class PluginLoader
+{
+private:
+    std::string mPluginDir;
+    std::string mIndexPath;
+    std::vector<PluginCommandInfo> mCommands;
+    std::vector<std::string> mErrors;
+    std::shared_ptr<detail::PluginLibraries> mLibraries;
+
+    //! Collects the commands a plugin registered into its parser.
+    static std::vector<PluginCommandInfo> describePlugin(const Parser& parser, const std::string& library);
+
+    //! Registers the index entries through the given registration functions.
+    template<typename Target>
+    void registerCommands(Target& target) const;
+
+public:
+    //! Creates a loader for `pluginDir`, keeping the index at `indexPath` or in
+    //! the plugin directory when empty.
+    explicit PluginLoader(std::string pluginDir, std::string indexPath = "");
+
+    //! Refreshes the index, loading only plugins that are new or changed since
+    //! it was written, and returns the commands found.
+    const std::vector<PluginCommandInfo>& scan();
+
+    //! The commands found by the last scan.
+    const std::vector<PluginCommandInfo>& commands() const { return mCommands; }
+
+    //! Problems loading plugins found by the last scan, e.g. a missing entry 
+    //! point.  Failures are kept in the index too, so a broken plugin is only
+    //! loaded again once it changes.
+    const std::vector<std::string>& errors() const { return mErrors; }
+
+    //! Returns the number of plugin libraries loaded so far.
+    std::size_t loadedLibraries() const;
+
+    //! Registers the scanned commands into a parser.
+    void registerInto(Parser& parser) const;
+
+    //! Registers the scanned commands into a command group.
+    void registerInto(CommandGroup& group) const;
+};
+
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "argunaught.hpp"
+
+namespace argunaught
+{
+
+//! A word of a line being edited, with where it is in the line.
+struct ReplWord
+{
+    //! The byte range of the word in the line, including any quotes.
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    //! The word with quoting and escapes removed.
+    std::string text;
+};
+
+//! Completion candidates for the word under the cursor.
+struct ReplCompletion
+{
+    //! The byte range of the line the candidates replace.
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    //! Matching command or option names, sorted.
+    std::vector<std::string> candidates;
+
+    //! The longest prefix shared by all of the candidates.
+    std::string commonPrefix() const;
+};
+
+//! Tracks a command line as it's edited, for completion and validation.
+/*!
+ *  `update` compares the new line with the previous one and only rescans
+ *  from the word containing the first change, resuming from the parse state
+ *  recorded after the word before it.  Typing at the end of the line only
+ *  rescans the last word, however long the line.
+ *
+ *  The state follows `Parser::parse`: global options, then a command, its
+ *  options and positional arguments.  Commands are looked up in a sorted
+ *  index built on first use, which completion also uses for name prefixes.
+ *  Anything after a subparser is left to it and isn't checked.
+ *
+ *  Error positions are word indexes, see `words()` for where they are.
+ */
+class ReplLine
+{
+public:
+    //! Where a word leaves the parse.
+    enum class Phase : std::uint8_t
+    {
+        GlobalOptions,
+        Command,
+        CommandOptions,
+        Positional,
+        SubParser,
+    };
+
+private:
+    //! An entry of the sorted command index.
+    struct CommandEntry
+    {
+        std::string_view name;
+        CommandPtr command;
+        LazyCommandPtr lazy;
+        SubParserPtr subParser;
+    };
+
+    //! The parse state after a word.
+    struct State
+    {
+        Phase phase = Phase::GlobalOptions;
+        CommandPtr command;
+        SubParserPtr subParser;
+
+        //! The option taking values, and the index of the word naming it.
+        const Option* pending = nullptr;
+        std::size_t pendingWord = 0;
+        int numValues = 0;
+    };
+
+    struct WordRecord
+    {
+        ReplWord word;
+        State state;
+
+        //! The id of the option the word names, for constraints.
+        std::size_t optionId = ColumnarArgs::UnknownOptionId;
+        std::vector<ParseError> errors;
+    };
+
+    const Parser& mParser;
+    std::vector<CommandEntry> mIndex;
+    bool mIndexBuilt = false;
+
+    std::string mText;
+    std::vector<WordRecord> mWords;
+
+    std::vector<ParseError> mErrors;
+    std::size_t mLastRescan = 0;
+
+    void buildIndex();
+    const CommandEntry* findCommand(std::string_view name);
+    const Option* findOption(const State& state, std::string_view token, std::size_t& optionId) const;
+
+    void analyzeWord(WordRecord& record, const State& before);
+    void finish();
+
+    State stateBefore(std::size_t wordIndex) const;
+
+public:
+    explicit ReplLine(const Parser& parser);
+
+    //! Sets the line being edited, rescanning only what changed.
+    void update(std::string_view line);
+
+    //! Clears the line, keeping the command index.
+    void clear() { update({}); }
+
+    //! The current line.
+    const std::string& text() const { return mText; }
+
+    //! The words of the line.
+    std::vector<ReplWord> words() const;
+
+    //! The errors the line would have if it were run now.
+    const std::vector<ParseError>& errors() const { return mErrors; }
+
+    //! The byte offset the last `update` started rescanning from.
+    std::size_t lastRescan() const { return mLastRescan; }
+
+    //! The phase the parse is in at the end of the line.
+    Phase phase() const;
+
+    //! Finds commands or options matching the word under the cursor.
+    ReplCompletion complete(std::size_t cursor);
+};
+
+//! Settings for an interactive `Repl`.
+struct ReplOptions
+{
+    std::string prompt = "> ";
+
+    //! A file to load history from and append new lines to, none if empty.
+    std::string historyFile;
+
+    //! The most lines of history kept.
+    std::size_t maxHistory = 1000;
+
+    //! Shows the first error of the line after it as it's typed.
+    bool showErrors = true;
+
+    //! A line that ends the session, besides end of input.
+    std::string exitCommand = "exit";
+
+    //! Runs a parsed line, defaults to `ParseResult::runCommand`.  Lines with
+    //! parse errors have them printed instead.
+    std::function<int (const ParseResult&)> dispatch;
+};
+
+//! An interactive shell that reads command lines and runs them with a parser.
+/*!
+ *  Supports the usual emacs style line editing keys, arrow keys, history and
+ *  tab completion of command and option names.  When reading from a terminal
+ *  it's put in raw mode for the session.  Lines are split with
+ *  `tokenizeCommandLine`, so quoting works as in a shell.
+ */
+class Repl
+{
+private:
+    const Parser& mParser;
+    ReplOptions mOptions;
+    ReplLine mLine;
+
+    std::vector<std::string> mHistory;
+    std::size_t mHistoryPos = 0;
+
+    //! The line being edited while browsing history.
+    std::string mStash;
+
+    std::string mText;
+    std::size_t mCursor = 0;
+
+    //! Set when a tab found several candidates, so another tab lists them.
+    bool mCompletionPending = false;
+
+    void loadHistory();
+    void addHistory(const std::string& line);
+
+    void setText(std::string text, std::size_t cursor);
+    void refresh(std::ostream& out);
+    void completeWord(std::ostream& out);
+    int runLine(const std::string& line, std::ostream& out);
+
+public:
+    Repl(const Parser& parser, ReplOptions opts = {});
+
+    //! Reads and runs lines until end of input or the exit command, returning
+    //! the exit code of the last command run.
+    int run(std::istream& in, std::ostream& out);
+
+    //! The lines entered, oldest first.
+    const std::vector<std::string>& history() const { return mHistory; }
+
+    //! The line analyzer, e.g. for checking completion outside of `run`.
+    ReplLine& line() { return mLine; }
+};
+
+}
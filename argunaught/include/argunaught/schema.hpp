@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "argunaught.hpp"
+
+namespace argunaught
+{
+
+class Schema;
+
+//! What kind of command a schema entry describes.
+enum class SchemaCommandKind : std::uint32_t
+{
+    Command,
+    StreamingCommand,
+    SubParser,
+};
+
+//! A list of option long names in a schema, e.g. an option's `conflictsWith`.
+class SchemaNames
+{
+private:
+    const Schema* mSchema = nullptr;
+    std::uint32_t mFirst = 0;
+    std::uint32_t mCount = 0;
+
+public:
+    SchemaNames() = default;
+    SchemaNames(const Schema* schema, std::uint32_t first, std::uint32_t count)
+        : mSchema(schema), mFirst(first), mCount(count) {}
+
+    std::size_t size() const { return mCount; }
+    bool empty() const { return mCount == 0; }
+    std::string_view operator[](std::size_t index) const;
+};
+
+//! An option as stored in a schema, with views into the schema's data.
+struct SchemaOption
+{
+    std::string_view longName;
+    std::string_view shortName;
+    std::string_view description;
+    int maxNumParams = 0;
+    int minNumParams = 0;
+    bool required = false;
+    RepeatPolicy repeat = RepeatPolicy::Separate;
+    SchemaNames conflictsWith;
+    SchemaNames dependsOn;
+};
+
+//! A command or subparser as stored in a schema.
+struct SchemaCommand
+{
+    std::string_view name;
+    std::string_view description;
+    SchemaCommandKind kind = SchemaCommandKind::Command;
+
+    //! The index of the command's group, or `-1` when it isn't grouped.
+    int group = -1;
+
+    //! The command's options are `option(firstOption)` onwards.
+    std::uint32_t firstOption = 0;
+    std::uint32_t numOptions = 0;
+};
+
+//! A command group as stored in a schema.
+struct SchemaGroup
+{
+    std::string_view name;
+    std::string_view description;
+};
+
+//! A global option constraint as stored in a schema.
+struct SchemaConstraint
+{
+    ConstraintType type = ConstraintType::MutuallyExclusive;
+    SchemaNames options;
+};
+
+//! The handlers to bind to the commands of a schema, by command name.
+struct SchemaHandlers
+{
+    std::unordered_map<std::string, CommandHandler> commands;
+    std::unordered_map<std::string, StreamingCommandHandler> streamingCommands;
+    std::unordered_map<std::string, SubParserCursorHandler> subParsers;
+};
+
+//! A parser definition serialized into a single binary blob.
+/*!
+ *  The blob holds everything about a parser except its handlers: options,
+ *  commands, groups, subparsers, constraints and help text, along with a
+ *  sorted command index.  It's position independent, referring to everything
+ *  by offset, so it can be written to a file and memory mapped by later runs.
+ *  Reading it only validates the offsets, the accessors return views straight
+ *  into the data without allocating.
+ *
+ *  `instantiate` turns a schema back into a `Parser`, binding handlers by
+ *  command name.  Only the global options are built up front, commands are
+ *  registered lazily and built from the schema when they're first used.
+ *
+ *  Blobs use the byte order of the machine that wrote them, and blobs from a
+ *  different byte order or schema version are rejected.  Option binders
+ *  aren't stored.
+ */
+class Schema
+{
+private:
+    //! Keeps the data alive, e.g. a mapping or a string.
+    std::shared_ptr<const void> mOwner;
+    const char* mData = nullptr;
+    std::size_t mSize = 0;
+
+    Schema(std::shared_ptr<const void> owner, const char* data, std::size_t size);
+
+    //! Throws a `std::runtime_error` if the blob is malformed.
+    void validate() const;
+
+    template<typename T>
+    T read(std::size_t offset) const;
+
+    std::string_view string(std::size_t refOffset) const;
+
+    friend class SchemaNames;
+
+public:
+    //! The version of the binary layout written by `serialize`.
+    static constexpr std::uint32_t Version = 1;
+
+    //! Serializes a parser's definition, building any lazy commands first.
+    static std::string serialize(const Parser& parser);
+
+    //! Serializes a parser's definition to a file.  The file is replaced by
+    //! renaming a new one over it, so existing mappings of it stay valid.
+    //! Throws a `std::runtime_error` if the file can't be written.
+    static void write(const Parser& parser, const std::string& path);
+
+    //! Reads a schema from serialized data, which it takes ownership of.
+    //! Throws a `std::runtime_error` if the data isn't a valid schema.
+    static Schema fromBuffer(std::string data);
+
+    //! Reads a schema from data that lives for the rest of the program, e.g.
+    //! an array generated by `argunaught-gen`, without copying it.
+    static Schema fromStatic(const void* data, std::size_t size);
+
+    //! Memory maps a schema file, which stays mapped while any copy of the
+    //! schema, or a parser instantiated from it, is alive.  Throws a
+    //! `std::runtime_error` if the file can't be mapped or isn't a valid schema.
+    static Schema map(const std::string& path);
+
+    //! Builds a parser from the schema, binding handlers by command name.
+    //! Throws a `std::runtime_error` if a command has no handler.
+    Parser instantiate(const SchemaHandlers& handlers) const;
+
+    std::string_view name() const;
+    std::string_view banner() const;
+    std::string_view description() const;
+    std::string_view usage() const;
+    bool passThrough() const;
+    bool columnarResults() const;
+
+    //! The global options are `option(0)` up to `numGlobalOptions()`.
+    std::size_t numGlobalOptions() const;
+    std::size_t numOptions() const;
+    SchemaOption option(std::size_t index) const;
+
+    std::size_t numCommands() const;
+    SchemaCommand command(std::size_t index) const;
+
+    //! Finds a command by name using the schema's sorted index.
+    std::optional<std::size_t> findCommand(std::string_view name) const;
+
+    std::size_t numGroups() const;
+    SchemaGroup group(std::size_t index) const;
+
+    std::size_t numConstraints() const;
+    SchemaConstraint constraint(std::size_t index) const;
+
+    //! The raw serialized data.
+    std::string_view data() const { return std::string_view(mData, mSize); }
+};
+
+}
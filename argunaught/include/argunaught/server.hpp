@@ -0,0 +1,109 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <ostream>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "argunaught.hpp"
+
+namespace argunaught
+{
+
+namespace detail
+{
+    class WorkerPool;
+}
+
+//! Settings for running a parser as a resident command server.
+struct ServerOptions
+{
+    //! The number of worker threads parsing and running requests.
+    std::size_t numWorkers = 4;
+
+    //! The maximum number of pending connections on the listening socket.
+    int backlog = 64;
+
+    //! Runs a parsed request on a worker thread.  The returned value is sent
+    //! back to the client as the exit code.  Defaults to `ParseResult::runCommand`.
+    std::function<int (const ParseResult&)> dispatch;
+};
+
+//! Serves a pre-built parser over a Unix domain socket.
+/*!
+ *  Each connection carries one framed argument vector, skipping the executable
+ *  name.  A worker parses it with the shared parser, runs it and streams 
+ *  anything the command writes to `commandOutput()` back to the client, 
+ *  followed by the exit code.  Parse errors are sent back as output with an
+ *  exit code of 1, as are requests giving an option bound with `bindTo`, 
+ *  since workers share its destination.  The parser must outlive the server.
+ *
+ *  Requests are limited to 64MiB, and a client that stops sending its request
+ *  for 5 seconds is disconnected.  `start()` fails if the socket path is in
+ *  use by a running server or isn't a socket.
+ */
+class CommandServer
+{
+private:
+    const Parser& mParser;
+    std::string mSocketPath;
+    ServerOptions mOptions;
+
+    int mListenFd = -1;
+
+    //! A pipe used to wake the accepting thread when stopping.
+    int mWakeFds[2] = {-1, -1};
+
+    std::thread mAcceptThread;
+    std::unique_ptr<detail::WorkerPool> mWorkers;
+
+    std::mutex mMutex;
+    std::condition_variable mStopped;
+    bool mRunning = false;
+
+    void acceptLoop();
+    void handleConnection(int fd);
+
+public:
+    CommandServer(const Parser& parser, std::string socketPath, ServerOptions opts = {});
+    ~CommandServer();
+
+    CommandServer(const CommandServer&) = delete;
+    CommandServer& operator=(const CommandServer&) = delete;
+
+    //! Binds the socket and starts accepting requests in the background.
+    //! Throws a `std::runtime_error` if the socket can't be created.
+    void start();
+
+    //! Stops accepting requests, finishes any in flight and removes the socket file.
+    //! Since that waits on the handler threads, calling it from a request handler
+    //! throws; have the handler signal another thread to stop the server instead.
+    void stop();
+
+    //! Blocks until the server has been stopped from another thread.
+    void wait();
+
+    //! Returns whether the server is currently accepting requests.
+    bool running();
+
+    //! The path of the Unix domain socket being served.
+    const std::string& socketPath() const { return mSocketPath; }
+};
+
+//! The bundled client side of a `CommandServer`.
+/*!
+ *  Sends the arguments (without an executable name) to the server at 
+ *  `socketPath`, writing streamed command output to `out` as it arrives.
+ *  Returns the command's exit code, or throws a `std::runtime_error` if the
+ *  server can't be reached or drops the connection.
+ */
+int runRemoteCommand(
+        const std::string& socketPath, 
+        const std::deque<std::string>& args, 
+        std::ostream& out);
+
+}
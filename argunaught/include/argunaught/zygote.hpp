@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "argunaught.hpp"
+
+namespace argunaught
+{
+
+//! Settings for running a parser as a pre-forking zygote.
+struct ZygoteOptions
+{
+    //! The maximum number of pending connections on the listening socket.
+    int backlog = 64;
+
+    //! Builds all lazy commands before serving, so forked children share them.
+    bool buildLazyCommands = true;
+
+    //! Runs a parsed request in the forked child.  The returned value is sent
+    //! back to the client as the exit code.  Defaults to `ParseResult::runCommand`.
+    std::function<int (const ParseResult&)> dispatch;
+};
+
+//! Serves a pre-built parser by forking a child per request.
+/*!
+ *  Each request carries the client's stdin, stdout and stderr, passed with
+ *  `SCM_RIGHTS`, and an argument vector without the executable name.  The
+ *  zygote forks and the child takes over the client's stdio, parses the 
+ *  arguments with the parser it inherited copy-on-write, runs the command and 
+ *  sends back the exit code.  If the arguments don't parse, the errors are 
+ *  written to the client's stderr and the exit code is 1 without running 
+ *  anything.  The child never returns to the caller.  Since each request is
+ *  parsed in its own process, options bound with `bindTo` can be used and
+ *  write the child's copy of their destination.
+ *
+ *  Forking is only safe from a single threaded process, so `run` should be 
+ *  called before any other threads are started.
+ */
+class Zygote
+{
+private:
+    const Parser& mParser;
+    std::string mSocketPath;
+    ZygoteOptions mOptions;
+
+    int mListenFd = -1;
+
+    //! A pipe used to wake the serving loop when stopping.
+    int mWakeFds[2] = {-1, -1};
+
+    //! Children forked for requests that haven't been reaped yet.  Only these
+    //! are waited for, so the host's other children keep their exit statuses.
+    std::vector<pid_t> mChildren;
+
+    void handleRequest(int fd);
+    void runChild(int fd, const int* stdioFds, const std::deque<std::string>& args);
+    void reapChildren();
+
+public:
+    Zygote(const Parser& parser, std::string socketPath, ZygoteOptions opts = {});
+    ~Zygote();
+
+    Zygote(const Zygote&) = delete;
+    Zygote& operator=(const Zygote&) = delete;
+
+    //! Binds the socket and serves requests on the calling thread until `stop`.
+    //! Throws a `std::runtime_error` if the socket can't be created.
+    void run();
+
+    //! Makes `run` return.  Only writes to a pipe, so it's safe to call from a
+    //! signal handler.
+    void stop();
+
+    //! The path of the Unix domain socket being served.
+    const std::string& socketPath() const { return mSocketPath; }
+};
+
+//! The bundled client side of a `Zygote`.
+/*!
+ *  Sends the given stdio descriptors and the arguments (without an executable
+ *  name) to the zygote at `socketPath`, and waits for the command to finish.
+ *  Returns the command's exit code, or throws a `std::runtime_error` if the
+ *  zygote can't be reached, can't fork a child for the command, or the child 
+ *  exits without reporting one.
+ */
+int runZygoteCommand(
+        const std::string& socketPath, 
+        const std::deque<std::string>& args, 
+        int inFd = 0, 
+        int outFd = 1, 
+        int errFd = 2);
+
+}
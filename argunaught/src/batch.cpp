@@ -0,0 +1,209 @@
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <argunaught/batch.hpp>
+
+#include "worker_pool.hpp"
+
+namespace argunaught
+{
+
+namespace
+{
+
+//! The outcome of a single script line, waiting to be written in order.
+struct LineSlot
+{
+    std::size_t lineNumber = 0;
+    bool done = false;
+
+    //! Blank, comment only or skipped after a fail fast failure.
+    bool ignored = false;
+
+    int exitCode = 0;
+    std::string output;
+};
+
+constexpr std::size_t NoFailure = std::numeric_limits<std::size_t>::max();
+
+}
+
+BatchResult 
+runBatch(
+        const Parser& parser, 
+        std::istream& script, 
+        std::ostream& out, 
+        BatchOptions opts)
+{
+    if(!opts.dispatch) {
+        opts.dispatch = [] (const ParseResult& result) {
+            return result.runCommand();
+        };
+    }
+
+    if(opts.maxInFlight == 0) opts.maxInFlight = 1;
+
+    BatchResult result;
+
+    std::mutex mutex;
+    std::condition_variable slotDone;
+    std::condition_variable slotEmitted;
+
+    // Slots for lines read but not yet written, `slots[0]` is sequence `nextToEmit`.
+    std::deque<LineSlot> slots;
+    std::size_t nextToEmit = 0;
+    bool readingDone = false;
+
+    // The lowest sequence number that failed, used to skip later lines when failing fast.
+    std::atomic<std::size_t> firstFailure{NoFailure};
+
+    // Writes finished lines in script order while later lines are still running.
+    std::thread writer([&] {
+        while(true) {
+            LineSlot slot;
+            std::size_t seq = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                slotDone.wait(lock, [&] {
+                    return (!slots.empty() && slots.front().done) || 
+                           (readingDone && slots.empty());
+                });
+
+                if(slots.empty()) return;
+
+                slot = std::move(slots.front());
+                slots.pop_front();
+                seq = nextToEmit++;
+            }
+            slotEmitted.notify_one();
+
+            // Lines after a failure may have already run before it was noticed.
+            if(slot.ignored || (opts.failFast && seq > firstFailure.load())) continue;
+
+            out << slot.output;
+            result.commandsRun++;
+
+            if(slot.exitCode != 0) {
+                result.commandsFailed++;
+                if(result.firstFailedLine == 0) {
+                    result.exitCode = slot.exitCode;
+                    result.firstFailedLine = slot.lineNumber;
+                }
+            }
+        }
+    });
+
+    {
+        detail::WorkerPool pool(opts.numThreads);
+
+        std::string text;
+        std::string nextLine;
+        std::size_t lineNumber = 0;
+        for(std::size_t seq = 0; std::getline(script, text); ++seq) {
+            const std::size_t startLine = ++lineNumber;
+
+            if(opts.failFast && firstFailure.load() != NoFailure) break;
+
+            // A trailing backslash or an open quote carries the command line on 
+            // to the next line, the only errors splitting can report.
+            auto tokens = tokenizeCommandLine(text);
+            while(tokens.hasError() && std::getline(script, nextLine)) {
+                lineNumber++;
+                text += '\n';
+                text += nextLine;
+                tokens = tokenizeCommandLine(text);
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                slotEmitted.wait(lock, [&] { return slots.size() < opts.maxInFlight; });
+
+                LineSlot slot;
+                slot.lineNumber = startLine;
+                slots.push_back(std::move(slot));
+            }
+
+            pool.post([&, seq, tokens = std::move(tokens)] {
+                LineSlot finished;
+                finished.done = true;
+
+                if(opts.failFast && seq > firstFailure.load()) {
+                    finished.ignored = true;
+                }
+                else if(tokens.size() == 0 && !tokens.hasError()) {
+                    finished.ignored = true;
+                }
+                else {
+                    std::ostringstream lineOut;
+                    {
+                        CommandOutputRedirect redirect(lineOut);
+                        SharedParsing shared;
+                        try {
+                            auto parsed = parser.parseCommandLine(tokens);
+                            if(parsed.hasError()) {
+                                for(const auto& error : parsed.errors) {
+                                    lineOut << "error: " << describeParseError(error) << "\n";
+                                }
+                                finished.exitCode = 1;
+                            }
+                            else {
+                                finished.exitCode = opts.dispatch(parsed);
+                            }
+                        }
+                        catch(const std::exception& e) {
+                            lineOut << "error: " << e.what() << "\n";
+                            finished.exitCode = 1;
+                        }
+                    }
+                    finished.output = lineOut.str();
+
+                    if(finished.exitCode != 0) {
+                        auto prev = firstFailure.load();
+                        while(seq < prev && !firstFailure.compare_exchange_weak(prev, seq)) {}
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    auto& slot = slots[seq - nextToEmit];
+                    finished.lineNumber = slot.lineNumber;
+                    slot = std::move(finished);
+                }
+                slotDone.notify_one();
+            });
+        }
+
+        // The pool finishes any queued lines as it goes out of scope.
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        readingDone = true;
+    }
+    slotDone.notify_one();
+    writer.join();
+
+    return result;
+}
+
+BatchResult 
+runBatchFile(
+        const Parser& parser, 
+        const std::string& path, 
+        std::ostream& out, 
+        BatchOptions opts)
+{
+    std::ifstream script(path);
+    if(!script) {
+        throw std::runtime_error("Unable to open batch script: '" + path + "'!");
+    }
+
+    return runBatch(parser, script, out, opts);
+}
+
+}
@@ -0,0 +1,101 @@
+#include <argunaught/argunaught.hpp>
+
+namespace argunaught
+{
+
+void 
+ColumnarArgs::appendValue(std::string_view value)
+{
+    mPool.append(value.data(), value.size());
+    mOffsets.push_back(mPool.size());
+}
+
+std::uint32_t 
+ColumnarArgs::nameSlot(std::uint32_t optionId, const std::string& longName)
+{
+    const auto noSlot = UnknownOptionId;
+    if(optionId != UnknownOptionId) {
+        if(optionId >= mIdNames.size()) {
+            mIdNames.resize(optionId + 1, noSlot);
+        }
+
+        if(mIdNames[optionId] != noSlot) {
+            return mIdNames[optionId];
+        }
+    }
+
+    auto it = std::find(mOptionNames.begin(), mOptionNames.end(), longName);
+    auto slot = static_cast<std::uint32_t>(it - mOptionNames.begin());
+    if(it == mOptionNames.end()) {
+        mOptionNames.push_back(longName);
+    }
+
+    if(optionId != UnknownOptionId) {
+        mIdNames[optionId] = slot;
+    }
+
+    return slot;
+}
+
+void 
+ColumnarArgs::beginOption(std::uint32_t optionId, const std::string& longName)
+{
+    mRecordNames.push_back(nameSlot(optionId, longName));
+    mRecords.push_back({optionId, static_cast<std::uint32_t>(size()), 0});
+}
+
+void 
+ColumnarArgs::remapOptionIds(const std::function<std::optional<std::size_t> (const std::string&)>& lookup)
+{
+    mIdNames.clear();
+    for(std::size_t ii = 0; ii < mRecords.size(); ++ii) {
+        const auto slot = mRecordNames[ii];
+        auto id = lookup(mOptionNames[slot]);
+        mRecords[ii].optionId = id.has_value() ? static_cast<std::uint32_t>(id.value()) : UnknownOptionId;
+        if(id.has_value()) {
+            if(id.value() >= mIdNames.size()) {
+                mIdNames.resize(id.value() + 1, UnknownOptionId);
+            }
+            mIdNames[id.value()] = slot;
+        }
+    }
+}
+
+void 
+ColumnarArgs::addOptionValue(std::string_view value)
+{
+    appendValue(value);
+    mRecords.back().numValues++;
+}
+
+void 
+ColumnarArgs::addPositionalArg(std::string_view value)
+{
+    if(!mHasPositionals) {
+        mFirstPositional = size();
+        mHasPositionals = true;
+    }
+
+    appendValue(value);
+}
+
+void 
+ColumnarArgs::reserve(std::size_t numValues, std::size_t numChars)
+{
+    mOffsets.reserve(mOffsets.size() + numValues);
+    mPool.reserve(mPool.size() + numChars);
+}
+
+const ColumnarArgs::OptionRecord* 
+ColumnarArgs::findOption(const std::string& longName) const
+{
+    for(std::size_t ii = 0; ii < mRecords.size(); ++ii) {
+        if(mOptionNames[mRecordNames[ii]] == longName) {
+            return &mRecords[ii];
+        }
+    }
+
+    return nullptr;
+}
+
+}
@@ -5,7 +5,7 @@ namespace argunaught
 
 Command::Command(
         std::string n, 
-        std::string h, 
+        HelpText h, 
         std::vector<Option> opt, 
         CommandHandler f//, 
         // bool _handlesSubParsers
@@ -14,4 +14,13 @@ Command::Command(
 {
 }
 
+LazyCommand::LazyCommand(
+        std::string n, 
+        std::string h, 
+        CommandFactory f
+    )
+    : name(n), shortHelp(h), factory(f)
+{
+}
+
 }
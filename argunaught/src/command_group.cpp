@@ -6,54 +6,150 @@ namespace argunaught
 CommandGroup::CommandGroup(
         Parser* parent, 
         std::string _name, 
-        std::string _desc
+        HelpText _desc
     ) : mParent(parent),
         name(_name),
         description(_desc)
 {
 }
 
+void 
+CommandGroup::parentChanged()
+{
+    if(mParent != nullptr) {
+        mParent->changed();
+    }
+}
+
 CommandGroup& 
 CommandGroup::command(
         std::string name, 
-        std::string help, 
+        HelpText help, 
         CommandHandler func)
 {
-    commands.push_back(std::shared_ptr<Command>(new Command(name, help, {}, func)));
-    return *this;    
+    return command(name, help, {}, func);
+}
+
+CommandGroup& 
+CommandGroup::command(
+        std::string name, 
+        HelpText help, 
+        std::vector<Option> options, 
+        CommandHandler func
+    )
+{
+    auto com = std::make_shared<Command>(name, help, options, func);
+    if(mParent != nullptr) {
+        mParent->compileCommandConstraints(*com);
+    }
+
+    commands.push_back(com);
+    parentChanged();
+    return *this;
 }
 
 CommandGroup& 
 CommandGroup::command(
         std::string name, 
-        std::string help, 
+        HelpText help, 
         std::vector<Option> options, 
+        std::vector<OptionListPtr> packs, 
         CommandHandler func
     )
 {
-    commands.push_back(std::make_shared<Command>(name, help, options, func));
+    auto com = std::make_shared<Command>(name, help, options, func);
+    if(mParent != nullptr) {
+        mParent->includeOptionPacks(*com, packs);
+        mParent->compileCommandConstraints(*com);
+    }
+    else {
+        for(const auto& pack : packs) {
+            com->options.include(pack);
+        }
+    }
+
+    commands.push_back(com);
+    parentChanged();
+    return *this;
+}
+
+CommandGroup& 
+CommandGroup::streamingCommand(
+        std::string name, 
+        HelpText help, 
+        std::vector<Option> options, 
+        StreamingCommandHandler func
+    )
+{
+    auto com = std::make_shared<Command>(name, help, options, nullptr);
+    com->streamingHandler = func;
+    if(mParent != nullptr) {
+        mParent->compileCommandConstraints(*com);
+    }
+
+    commands.push_back(com);
+    parentChanged();
+    return *this;
+}
+
+CommandGroup& 
+CommandGroup::lazyCommand(
+        std::string name, 
+        std::string shortHelp, 
+        CommandFactory factory
+    )
+{
+    auto com = std::make_shared<LazyCommand>(name, shortHelp, factory);
+    if(mParent == nullptr || mParent->addLazyCommand(com)) {
+        lazyCommands.push_back(com);
+    }
+
     return *this;
 }
 
 CommandGroup& 
 CommandGroup::subParser(
         std::string name, 
-        std::string help, 
+        HelpText help, 
         SubParserHandler func)
 {
     subParsers.push_back(std::shared_ptr<SubParser>(new SubParser(name, help, {}, func)));
+    parentChanged();
     return *this; 
 }
 
 CommandGroup& 
 CommandGroup::subParser(
         std::string name, 
-        std::string help, 
+        HelpText help, 
         std::vector<Option> options, 
         SubParserHandler func
     )
 {
     subParsers.push_back(std::shared_ptr<SubParser>(new SubParser(name, help, options, func)));
+    parentChanged();
+    return *this; 
+}
+
+CommandGroup& 
+CommandGroup::cursorSubParser(
+        std::string name, 
+        HelpText help, 
+        SubParserCursorHandler func)
+{
+    return cursorSubParser(name, help, {}, func);
+}
+
+CommandGroup& 
+CommandGroup::cursorSubParser(
+        std::string name, 
+        HelpText help, 
+        std::vector<Option> options, 
+        SubParserCursorHandler func
+    )
+{
+    subParsers.push_back(std::make_shared<SubParser>(name, help, options, func));
+    parentChanged();
     return *this; 
 }
 
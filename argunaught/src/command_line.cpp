@@ -0,0 +1,194 @@
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <argunaught/argunaught.hpp>
+
+namespace argunaught
+{
+
+namespace
+{
+
+template<char... Chars>
+bool
+isAnyOf(char ch)
+{
+    return ((ch == Chars) || ...);
+}
+
+//! Finds the first of the given characters at or after `pos`, or `size` if 
+//! there are none.  Scans 16 bytes at a time when SSE2 is available.
+template<char... Chars>
+std::size_t
+scanFor(const char* data, std::size_t pos, std::size_t size)
+{
+#if defined(__SSE2__)
+    while(pos + 16 <= size) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        auto matches = _mm_setzero_si128();
+        ((matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, _mm_set1_epi8(Chars)))), ...);
+
+        auto mask = _mm_movemask_epi8(matches);
+        if(mask != 0) {
+            return pos + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+
+        pos += 16;
+    }
+#endif
+
+    while(pos < size && !isAnyOf<Chars...>(data[pos])) {
+        pos++;
+    }
+
+    return pos;
+}
+
+bool
+isBlank(char ch)
+{
+    return isAnyOf<' ', '\t', '\n', '\r'>(ch);
+}
+
+}
+
+std::deque<std::string> 
+CommandLineTokens::toDeque() const
+{
+    std::deque<std::string> args;
+    for(std::size_t ii = 0; ii < size(); ++ii) {
+        args.emplace_back((*this)[ii]);
+    }
+
+    return args;
+}
+
+std::deque<std::string> 
+ArgCursor::toDeque() const
+{
+    std::deque<std::string> args;
+    for(std::size_t ii = mPos; ii < mEnd; ++ii) {
+        args.emplace_back(at(ii));
+    }
+
+    return args;
+}
+
+CommandLineTokens 
+tokenizeCommandLine(std::string_view commandLine)
+{
+    CommandLineTokens tokens;
+
+    const char* data = commandLine.data();
+    const std::size_t size = commandLine.size();
+
+    // Unescaped words are never longer than the input, so one allocation suffices.
+    tokens.mArena.reserve(size);
+
+    auto setError = [&tokens] (ParseErrorType type, std::size_t wordStart) {
+        tokens.mError = ParseError{
+            type,
+            static_cast<int>(tokens.mSpans.size()),
+            tokens.mArena.substr(wordStart)
+        };
+    };
+
+    std::size_t pos = 0;
+    while(true) {
+        // Line continuations between words are blanks too, not empty words.
+        while(pos < size) {
+            if(isBlank(data[pos])) {
+                pos++;
+            }
+            else if(data[pos] == '\\' && pos + 1 < size && data[pos + 1] == '\n') {
+                pos += 2;
+            }
+            else {
+                break;
+            }
+        }
+
+        if(pos >= size) break;
+
+        // A `#` starting a word comments out the rest of the line.
+        if(data[pos] == '#') {
+            auto eol = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+            pos = eol ? static_cast<std::size_t>(eol - data) : size;
+            continue;
+        }
+
+        std::size_t wordStart = tokens.mArena.size();
+        while(pos < size) {
+            auto next = scanFor<' ', '\t', '\n', '\r', '\'', '"', '\\'>(data, pos, size);
+            tokens.mArena.append(data + pos, next - pos);
+            pos = next;
+
+            if(pos >= size || isBlank(data[pos])) break;
+
+            if(data[pos] == '\'') {
+                // Everything up to the closing single quote is literal.
+                auto close = static_cast<const char*>(std::memchr(data + pos + 1, '\'', size - pos - 1));
+                if(close == nullptr) {
+                    setError(ParseErrorType::UnterminatedQuote, wordStart);
+                    return tokens;
+                }
+
+                auto closePos = static_cast<std::size_t>(close - data);
+                tokens.mArena.append(data + pos + 1, closePos - pos - 1);
+                pos = closePos + 1;
+            }
+            else if(data[pos] == '"') {
+                pos++;
+                while(true) {
+                    auto quoteEnd = scanFor<'"', '\\'>(data, pos, size);
+                    tokens.mArena.append(data + pos, quoteEnd - pos);
+                    pos = quoteEnd;
+
+                    if(pos < size && data[pos] == '"') {
+                        pos++;
+                        break;
+                    }
+
+                    // Either ran out of input or a backslash was the last character.
+                    if(pos + 1 >= size) {
+                        setError(ParseErrorType::UnterminatedQuote, wordStart);
+                        return tokens;
+                    }
+
+                    // Inside double quotes a backslash only escapes a few characters.
+                    char escaped = data[pos + 1];
+                    if(isAnyOf<'$', '`', '"', '\\'>(escaped)) {
+                        tokens.mArena += escaped;
+                    }
+                    else if(escaped != '\n') {
+                        tokens.mArena += '\\';
+                        tokens.mArena += escaped;
+                    }
+                    pos += 2;
+                }
+            }
+            else {
+                // Backslash outside of quotes.
+                if(pos + 1 >= size) {
+                    setError(ParseErrorType::TrailingEscape, wordStart);
+                    return tokens;
+                }
+
+                // An escaped new line is a line continuation and is dropped.
+                if(data[pos + 1] != '\n') {
+                    tokens.mArena += data[pos + 1];
+                }
+                pos += 2;
+            }
+        }
+
+        tokens.mSpans.push_back({wordStart, tokens.mArena.size() - wordStart});
+    }
+
+    return tokens;
+}
+
+}
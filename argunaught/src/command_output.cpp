@@ -0,0 +1,34 @@
+#include <iostream>
+
+#include <argunaught/argunaught.hpp>
+
+namespace argunaught
+{
+
+namespace
+{
+    thread_local std::ostream* tCurrentOutput = nullptr;
+}
+
+std::ostream& 
+commandOutput()
+{
+    if(tCurrentOutput != nullptr) {
+        return *tCurrentOutput;
+    }
+
+    return std::cout;
+}
+
+CommandOutputRedirect::CommandOutputRedirect(std::ostream& out)
+    : mPrevious(tCurrentOutput)
+{
+    tCurrentOutput = &out;
+}
+
+CommandOutputRedirect::~CommandOutputRedirect()
+{
+    tCurrentOutput = mPrevious;
+}
+
+}
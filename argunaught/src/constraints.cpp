@@ -0,0 +1,272 @@
+#include <argunaught/argunaught.hpp>
+
+namespace argunaught
+{
+
+namespace
+{
+
+constexpr std::size_t BitsPerWord = 64;
+
+int
+popCount(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for(; word != 0; word &= word - 1) count++;
+    return count;
+#endif
+}
+
+}
+
+void 
+OptionMask::set(std::size_t id)
+{
+    auto word = id / BitsPerWord;
+    if(word >= mWords.size()) {
+        mWords.resize(word + 1, 0);
+    }
+
+    mWords[word] |= std::uint64_t(1) << (id % BitsPerWord);
+}
+
+bool 
+OptionMask::test(std::size_t id) const
+{
+    auto word = id / BitsPerWord;
+    return word < mWords.size() && 
+           (mWords[word] & (std::uint64_t(1) << (id % BitsPerWord))) != 0;
+}
+
+std::size_t 
+OptionMask::countCommon(const OptionMask& other) const
+{
+    std::size_t count = 0;
+    auto len = std::min(mWords.size(), other.mWords.size());
+    for(std::size_t ii = 0; ii < len; ++ii) {
+        count += static_cast<std::size_t>(popCount(mWords[ii] & other.mWords[ii]));
+    }
+
+    return count;
+}
+
+bool 
+OptionMask::containsAll(const OptionMask& other) const
+{
+    for(std::size_t ii = 0; ii < other.mWords.size(); ++ii) {
+        auto word = ii < mWords.size() ? mWords[ii] : 0;
+        if((word & other.mWords[ii]) != other.mWords[ii]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<std::size_t> 
+OptionMask::missingFrom(const OptionMask& other) const
+{
+    std::vector<std::size_t> missing;
+    for(std::size_t ii = 0; ii < other.mWords.size(); ++ii) {
+        auto word = ii < mWords.size() ? mWords[ii] : 0;
+        auto bits = other.mWords[ii] & ~word;
+        for(std::size_t bit = 0; bits != 0; ++bit, bits >>= 1) {
+            if(bits & 1) missing.push_back(ii * BitsPerWord + bit);
+        }
+    }
+
+    return missing;
+}
+
+bool 
+OptionMask::empty() const
+{
+    return std::all_of(mWords.begin(), mWords.end(), [] (auto word) { return word == 0; });
+}
+
+std::vector<std::size_t> 
+OptionMask::ids() const
+{
+    // Every id in this mask is missing from an empty one.
+    return OptionMask().missingFrom(*this);
+}
+
+ConstraintRules 
+ConstraintRules::compile(
+        const OptionList& globalOptions,
+        const OptionList* commandOptions,
+        const std::vector<Constraint>& groups,
+        std::vector<ParserConfigError>& errors)
+{
+    ConstraintRules rules;
+
+    const auto numGlobals = globalOptions.size();
+
+    // Command options shadow global ones with the same name.
+    auto resolve = [&] (const std::string& name) -> std::optional<std::size_t> {
+        if(commandOptions != nullptr) {
+            auto index = commandOptions->findLongOptionIndex(name);
+            if(index.has_value()) return numGlobals + index.value();
+        }
+
+        return globalOptions.findLongOptionIndex(name);
+    };
+
+    auto resolveAll = [&] (
+            const std::vector<std::string>& names, 
+            const std::string& owner, 
+            OptionMask& mask) 
+    {
+        for(const auto& name : names) {
+            auto id = resolve(name);
+            if(id.has_value()) {
+                mask.set(id.value());
+                continue;
+            }
+
+            auto err = ParserConfigErrorType::UnknownConstraintOption;
+            errors.push_back({
+                err,
+                "Error adding constraint [UnknownConstraintOption]:"
+                " '--" + name + "' referenced by " + owner
+            });
+        }
+    };
+
+    // Only the options owned by this scope declare rules, global option 
+    // constraints are checked by the global rules for every command.
+    const auto& owned = commandOptions != nullptr ? *commandOptions : globalOptions;
+    const auto firstId = commandOptions != nullptr ? numGlobals : 0;
+
+    Rule required{RuleType::Required, {}};
+    auto addRules = [&] (const OptionList& layer, std::size_t layerId) {
+        if(!layer.declaresConstraints()) {
+            return;
+        }
+
+        for(std::size_t ii = 0; ii < layer.values().size(); ++ii) {
+            const auto& opt = layer.values()[ii];
+            const auto id = layerId + ii;
+
+            if(opt.required) {
+                required.mask.set(id);
+            }
+
+            for(const auto& name : opt.conflictsWith) {
+                Rule rule{RuleType::MutuallyExclusive, {}};
+                rule.mask.set(id);
+                resolveAll({name}, "'--" + opt.longName + "'", rule.mask);
+                rules.mRules.push_back(rule);
+            }
+
+            if(!opt.dependsOn.empty()) {
+                Rule rule{RuleType::Requires, {}, id};
+                resolveAll(opt.dependsOn, "'--" + opt.longName + "'", rule.mask);
+                rules.mRules.push_back(rule);
+            }
+        }
+    };
+
+    // Shared packs are skipped unless they declare constraints, so attaching
+    // a pack costs nothing here.
+    addRules(owned, firstId);
+    auto packId = firstId + owned.values().size();
+    for(const auto& pack : owned.packs()) {
+        addRules(*pack, packId);
+        packId += pack->values().size();
+    }
+
+    if(!required.mask.empty()) {
+        rules.mRules.push_back(required);
+    }
+
+    for(const auto& group : groups) {
+        auto type = group.type == ConstraintType::MutuallyExclusive ? 
+                RuleType::MutuallyExclusive : 
+                RuleType::AtLeastOne;
+
+        Rule rule{type, {}};
+        resolveAll(group.options, "a parser constraint", rule.mask);
+        rules.mRules.push_back(rule);
+    }
+
+    // Only the names of options that rules refer to are needed for errors.
+    auto addName = [&] (std::size_t id) {
+        if(rules.mNames.count(id) > 0) {
+            return;
+        }
+
+        const auto& opt = id < numGlobals ? globalOptions.at(id) : commandOptions->at(id - numGlobals);
+        rules.mNames.emplace(id, opt.longName);
+    };
+
+    for(const auto& rule : rules.mRules) {
+        for(auto id : rule.mask.ids()) {
+            addName(id);
+        }
+
+        if(rule.type == RuleType::Requires) {
+            addName(rule.trigger);
+        }
+    }
+
+    return rules;
+}
+
+std::string 
+ConstraintRules::joinNames(const std::vector<std::size_t>& ids, const char* separator) const
+{
+    std::string joined;
+    for(auto id : ids) {
+        if(!joined.empty()) joined += separator;
+        joined += mNames.at(id);
+    }
+
+    return joined;
+}
+
+void 
+ConstraintRules::evaluate(const OptionMask& present, std::vector<ParseError>& errors) const
+{
+    for(const auto& rule : mRules) {
+        switch(rule.type)
+        {
+            case RuleType::Required:
+                if(!present.containsAll(rule.mask)) {
+                    for(auto id : present.missingFrom(rule.mask)) {
+                        errors.push_back({ParseErrorType::MissingRequiredOption, -1, mNames.at(id)});
+                    }
+                }
+                break;
+
+            case RuleType::MutuallyExclusive:
+                if(present.countCommon(rule.mask) > 1) {
+                    std::vector<std::size_t> found;
+                    for(auto id : rule.mask.ids()) {
+                        if(present.test(id)) found.push_back(id);
+                    }
+                    errors.push_back({ParseErrorType::ConflictingOptions, -1, joinNames(found, ", ")});
+                }
+                break;
+
+            case RuleType::AtLeastOne:
+                if(present.countCommon(rule.mask) == 0) {
+                    errors.push_back({ParseErrorType::MissingRequiredOption, -1, joinNames(rule.mask.ids(), " | ")});
+                }
+                break;
+
+            case RuleType::Requires:
+                if(present.test(rule.trigger) && !present.containsAll(rule.mask)) {
+                    for(auto id : present.missingFrom(rule.mask)) {
+                        errors.push_back({ParseErrorType::MissingDependentOption, -1, mNames.at(id)});
+                    }
+                }
+                break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,311 @@
+#include <argunaught/definition.hpp>
+
+#include <sstream>
+
+namespace argunaught
+{
+
+void
+JsonWriter::separate()
+{
+    if(mAfterKey) {
+        mAfterKey = false;
+        return;
+    }
+
+    if(!mHasMembers.empty()) {
+        if(mHasMembers.back()) {
+            mOut.put(',');
+        }
+        mHasMembers.back() = true;
+    }
+}
+
+void
+JsonWriter::writeString(std::string_view text)
+{
+    static const char* hexDigits = "0123456789abcdef";
+
+    mOut.put('"');
+
+    // Write runs of characters that don't need escaping in one go.
+    std::size_t runStart = 0;
+    for(std::size_t ii = 0; ii < text.size(); ++ii) {
+        auto ch = static_cast<unsigned char>(text[ii]);
+        if(ch >= 0x20 && ch != '"' && ch != '\\') {
+            continue;
+        }
+
+        mOut.write(text.data() + runStart, ii - runStart);
+        runStart = ii + 1;
+        switch(ch)
+        {
+            case '"': mOut.write("\\\"", 2); break;
+            case '\\': mOut.write("\\\\", 2); break;
+            case '\n': mOut.write("\\n", 2); break;
+            case '\r': mOut.write("\\r", 2); break;
+            case '\t': mOut.write("\\t", 2); break;
+            case '\b': mOut.write("\\b", 2); break;
+            case '\f': mOut.write("\\f", 2); break;
+            default: {
+                const char escaped[] = {'\\', 'u', '0', '0', hexDigits[ch >> 4], hexDigits[ch & 0xf]};
+                mOut.write(escaped, sizeof(escaped));
+            }
+        }
+    }
+
+    mOut.write(text.data() + runStart, text.size() - runStart);
+    mOut.put('"');
+}
+
+JsonWriter&
+JsonWriter::beginObject()
+{
+    separate();
+    mOut.put('{');
+    mHasMembers.push_back(false);
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::endObject()
+{
+    if(mHasMembers.empty() || mAfterKey) {
+        throw std::runtime_error("Unbalanced JSON object!");
+    }
+
+    mHasMembers.pop_back();
+    mOut.put('}');
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::beginArray()
+{
+    separate();
+    mOut.put('[');
+    mHasMembers.push_back(false);
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::endArray()
+{
+    if(mHasMembers.empty() || mAfterKey) {
+        throw std::runtime_error("Unbalanced JSON array!");
+    }
+
+    mHasMembers.pop_back();
+    mOut.put(']');
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::key(std::string_view name)
+{
+    if(mAfterKey) {
+        throw std::runtime_error("JSON key '" + std::string(name) + "' is missing a value!");
+    }
+
+    separate();
+    writeString(name);
+    mOut.put(':');
+    mAfterKey = true;
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::value(std::string_view text)
+{
+    separate();
+    writeString(text);
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::value(std::int64_t number)
+{
+    separate();
+    mOut << number;
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::value(bool flag)
+{
+    separate();
+    if(flag) {
+        mOut.write("true", 4);
+    }
+    else {
+        mOut.write("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter&
+JsonWriter::value(const std::vector<std::string>& texts)
+{
+    beginArray();
+    for(const auto& text : texts) {
+        value(text);
+    }
+    return endArray();
+}
+
+namespace
+{
+
+//! The names `argunaught-gen` reads repeat policies by.
+const char*
+repeatPolicyName(RepeatPolicy policy)
+{
+    switch(policy)
+    {
+        case RepeatPolicy::Count:
+            return "count";
+
+        case RepeatPolicy::Append:
+            return "append";
+
+        case RepeatPolicy::LastWins:
+            return "lastWins";
+
+        case RepeatPolicy::FirstWins:
+            return "firstWins";
+
+        case RepeatPolicy::Error:
+            return "error";
+
+        default:
+            return "separate";
+    }
+}
+
+//! Writes the parts of a parser's definition, reusing storage for
+//! decompressing descriptions.
+class DefinitionWriter
+{
+private:
+    JsonWriter mJson;
+    std::string mStorage;
+
+public:
+    explicit DefinitionWriter(std::ostream& out) : mJson(out) {}
+
+    JsonWriter& json() { return mJson; }
+
+    void text(std::string_view name, const HelpText& value)
+    {
+        mJson.member(name, value.view(mStorage));
+    }
+
+    void options(const OptionList& options)
+    {
+        mJson.key("options").beginArray();
+        for(const auto& opt : options) {
+            mJson.beginObject()
+                .member("long", opt.longName)
+                .member("short", opt.shortName);
+            text("description", opt.description);
+            mJson.member("params", opt.maxNumParams)
+                .member("minParams", opt.minNumParams)
+                .member("required", opt.required)
+                .member("repeat", repeatPolicyName(opt.repeat))
+                .member("conflictsWith", opt.conflictsWith)
+                .member("dependsOn", opt.dependsOn)
+                .endObject();
+        }
+        mJson.endArray();
+    }
+
+    void command(const Command& com)
+    {
+        mJson.beginObject().member("name", com.name);
+        text("description", com.description);
+        mJson.member("kind", com.streamingHandler ? "streaming" : "command");
+        options(com.options);
+        mJson.endObject();
+    }
+
+    void subParser(const SubParser& sub)
+    {
+        mJson.beginObject().member("name", sub.name);
+        text("description", sub.description);
+        mJson.member("kind", "subparser");
+        options(sub.options);
+        mJson.endObject();
+    }
+};
+
+}
+
+void
+ParserDefinition::writeJson(const Parser& parser, std::ostream& out)
+{
+    DefinitionWriter writer(out);
+    auto& json = writer.json();
+
+    json.beginObject()
+        .member("name", parser.mName)
+        .member("banner", parser.mBanner);
+    writer.text("description", parser.mDescription);
+    writer.text("usage", parser.mUsage);
+    json.member("passThrough", parser.mPassThrough)
+        .member("columnarResults", parser.mColumnarResults);
+
+    writer.options(*parser.mOptions);
+
+    json.key("constraints").beginArray();
+    for(const auto& constraint : parser.mConstraints) {
+        json.beginObject()
+            .member("type", constraint.type == ConstraintType::AtLeastOne ? "atLeastOne" : "mutuallyExclusive")
+            .member("options", constraint.options)
+            .endObject();
+    }
+    json.endArray();
+
+    // Commands are listed in the same order as in `Schema::serialize`.
+    json.key("commands").beginArray();
+    for(const auto& com : parser.mCommands) {
+        writer.command(*com);
+    }
+    for(const auto& lazy : parser.mLazyCommands) {
+        writer.command(*parser.materialize(*lazy));
+    }
+    for(const auto& sub : parser.mSubParsers) {
+        writer.subParser(*sub);
+    }
+    json.endArray();
+
+    json.key("groups").beginArray();
+    for(const auto& group : parser.mGroups) {
+        json.beginObject().member("name", group.name);
+        writer.text("description", group.description);
+        json.key("commands").beginArray();
+        for(const auto& com : group.commands) {
+            writer.command(*com);
+        }
+        for(const auto& lazy : group.lazyCommands) {
+            writer.command(*parser.materialize(*lazy));
+        }
+        for(const auto& sub : group.subParsers) {
+            writer.subParser(*sub);
+        }
+        json.endArray().endObject();
+    }
+    json.endArray();
+
+    json.endObject();
+    out.put('\n');
+}
+
+std::string
+ParserDefinition::json(const Parser& parser)
+{
+    std::ostringstream out;
+    writeJson(parser, out);
+    return out.str();
+}
+
+}
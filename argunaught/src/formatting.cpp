@@ -1,585 +1,436 @@
 #include <unistd.h> // for STDOUT_FILENO and isatty
 #include <sys/ioctl.h> //ioctl() and TIOCGWINSZ
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
 #include <argunaught/argunaught.hpp>
 
-namespace 
+namespace argunaught
 {
 
-// std::string 
-// replaceAll(std::string const& orig, char c, std::string const& replace)
-// {
-//     std::string newStr;
-//     for(char ch : orig) {
-//         if(ch == c) {
-//             newStr += replace;
-//         }
-//         else {
-//             newStr += ch;
-//         }
-//     }
-//     return newStr;
-// }
-
-// std::vector<std::string>
-// split(std::string const& orig, char c)
-// {
-//     std::vector<std::string> result;
-//     std::string newStr;
-//     for(char ch : orig) {
-//         if(ch != c) {
-//             newStr += ch;
-//         }
-//         else {
-//             result.push_back(newStr);
-//             newStr = "";
-//         }
-//     }
-    
-//     if(newStr.size() != 0) {
-//         result.push_back(newStr);
-//     }
-
-//     return result;
-// }
+namespace
+{
 
-std::size_t
-displayWidth()
+//! A range of code points, inclusive.
+struct CodePointRange
 {
-    struct winsize size;
-    ioctl(STDOUT_FILENO, TIOCGWINSZ, &size);
-    return static_cast<std::size_t>(size.ws_col);
+    char32_t first;
+    char32_t last;
+};
+
+//! Combining marks, format controls and other code points that take no columns.
+constexpr CodePointRange ZeroWidthRanges[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF},
+    {0x05C1, 0x05C2}, {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0600, 0x0605},
+    {0x0610, 0x061A}, {0x061C, 0x061C}, {0x064B, 0x065F}, {0x0670, 0x0670},
+    {0x06D6, 0x06DD}, {0x06DF, 0x06E4}, {0x06E7, 0x06E8}, {0x06EA, 0x06ED},
+    {0x070F, 0x070F}, {0x0711, 0x0711}, {0x0730, 0x074A}, {0x07A6, 0x07B0},
+    {0x07EB, 0x07F3}, {0x0816, 0x0819}, {0x081B, 0x0823}, {0x0825, 0x0827},
+    {0x0829, 0x082D}, {0x0859, 0x085B}, {0x0898, 0x089F}, {0x08CA, 0x0902},
+    {0x093A, 0x093A}, {0x093C, 0x093C}, {0x0941, 0x0948}, {0x094D, 0x094D},
+    {0x0951, 0x0957}, {0x0962, 0x0963}, {0x0981, 0x0981}, {0x09BC, 0x09BC},
+    {0x09C1, 0x09C4}, {0x09CD, 0x09CD}, {0x09E2, 0x09E3}, {0x0A01, 0x0A02},
+    {0x0A3C, 0x0A3C}, {0x0A41, 0x0A51}, {0x0A70, 0x0A71}, {0x0A75, 0x0A75},
+    {0x0A81, 0x0A82}, {0x0ABC, 0x0ABC}, {0x0AC1, 0x0AC8}, {0x0ACD, 0x0ACD},
+    {0x0AE2, 0x0AE3}, {0x0B01, 0x0B01}, {0x0B3C, 0x0B3C}, {0x0B3F, 0x0B3F},
+    {0x0B41, 0x0B44}, {0x0B4D, 0x0B4D}, {0x0B55, 0x0B56}, {0x0B62, 0x0B63},
+    {0x0B82, 0x0B82}, {0x0BC0, 0x0BC0}, {0x0BCD, 0x0BCD}, {0x0C00, 0x0C00},
+    {0x0C04, 0x0C04}, {0x0C3C, 0x0C3C}, {0x0C3E, 0x0C40}, {0x0C46, 0x0C56},
+    {0x0C62, 0x0C63}, {0x0C81, 0x0C81}, {0x0CBC, 0x0CBC}, {0x0CCC, 0x0CCD},
+    {0x0CE2, 0x0CE3}, {0x0D00, 0x0D01}, {0x0D3B, 0x0D3C}, {0x0D41, 0x0D44},
+    {0x0D4D, 0x0D4D}, {0x0D62, 0x0D63}, {0x0D81, 0x0D81}, {0x0DCA, 0x0DCA},
+    {0x0DD2, 0x0DD6}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E},
+    {0x0EB1, 0x0EB1}, {0x0EB4, 0x0EBC}, {0x0EC8, 0x0ECE}, {0x0F18, 0x0F19},
+    {0x0F35, 0x0F35}, {0x0F37, 0x0F37}, {0x0F39, 0x0F39}, {0x0F71, 0x0F7E},
+    {0x0F80, 0x0F84}, {0x0F86, 0x0F87}, {0x0F8D, 0x0FBC}, {0x0FC6, 0x0FC6},
+    {0x102D, 0x1030}, {0x1032, 0x1037}, {0x1039, 0x103A}, {0x103D, 0x103E},
+    {0x1058, 0x1059}, {0x105E, 0x1060}, {0x1071, 0x1074}, {0x1082, 0x1082},
+    {0x1085, 0x1086}, {0x108D, 0x108D}, {0x109D, 0x109D}, {0x1160, 0x11FF},
+    {0x135D, 0x135F}, {0x1712, 0x1714}, {0x1732, 0x1733}, {0x1752, 0x1753},
+    {0x1772, 0x1773}, {0x17B4, 0x17B5}, {0x17B7, 0x17BD}, {0x17C6, 0x17C6},
+    {0x17C9, 0x17D3}, {0x17DD, 0x17DD}, {0x180B, 0x180F}, {0x1885, 0x1886},
+    {0x18A9, 0x18A9}, {0x1920, 0x1922}, {0x1927, 0x1928}, {0x1932, 0x1932},
+    {0x1939, 0x193B}, {0x1A17, 0x1A18}, {0x1A1B, 0x1A1B}, {0x1A56, 0x1A56},
+    {0x1A58, 0x1A60}, {0x1A62, 0x1A62}, {0x1A65, 0x1A6C}, {0x1A73, 0x1A7F},
+    {0x1AB0, 0x1AFF}, {0x1B00, 0x1B03}, {0x1B34, 0x1B34}, {0x1B36, 0x1B3A},
+    {0x1B3C, 0x1B3C}, {0x1B42, 0x1B42}, {0x1B6B, 0x1B73}, {0x1B80, 0x1B81},
+    {0x1BA2, 0x1BA5}, {0x1BA8, 0x1BA9}, {0x1BAB, 0x1BAD}, {0x1BE6, 0x1BE6},
+    {0x1BE8, 0x1BE9}, {0x1BED, 0x1BED}, {0x1BEF, 0x1BF1}, {0x1C2C, 0x1C33},
+    {0x1C36, 0x1C37}, {0x1CD0, 0x1CD2}, {0x1CD4, 0x1CE0}, {0x1CE2, 0x1CE8},
+    {0x1CED, 0x1CED}, {0x1CF4, 0x1CF4}, {0x1CF8, 0x1CF9}, {0x1DC0, 0x1DFF},
+    {0x200B, 0x200F}, {0x202A, 0x202E}, {0x2060, 0x2064}, {0x2066, 0x206F},
+    {0x20D0, 0x20F0}, {0x2CEF, 0x2CF1}, {0x2D7F, 0x2D7F}, {0x2DE0, 0x2DFF},
+    {0x302A, 0x302D}, {0x3099, 0x309A}, {0xA66F, 0xA672}, {0xA674, 0xA67D},
+    {0xA69E, 0xA69F}, {0xA6F0, 0xA6F1}, {0xA802, 0xA802}, {0xA806, 0xA806},
+    {0xA80B, 0xA80B}, {0xA825, 0xA826}, {0xA82C, 0xA82C}, {0xA8C4, 0xA8C5},
+    {0xA8E0, 0xA8F1}, {0xA8FF, 0xA8FF}, {0xA926, 0xA92D}, {0xA947, 0xA951},
+    {0xA980, 0xA982}, {0xA9B3, 0xA9B3}, {0xA9B6, 0xA9B9}, {0xA9BC, 0xA9BD},
+    {0xA9E5, 0xA9E5}, {0xAA29, 0xAA2E}, {0xAA31, 0xAA32}, {0xAA35, 0xAA36},
+    {0xAA43, 0xAA43}, {0xAA4C, 0xAA4C}, {0xAA7C, 0xAA7C}, {0xAAB0, 0xAAB0},
+    {0xAAB2, 0xAAB4}, {0xAAB7, 0xAAB8}, {0xAABE, 0xAABF}, {0xAAC1, 0xAAC1},
+    {0xAAEC, 0xAAED}, {0xAAF6, 0xAAF6}, {0xABE5, 0xABE5}, {0xABE8, 0xABE8},
+    {0xABED, 0xABED}, {0xD7B0, 0xD7FF}, {0xFB1E, 0xFB1E}, {0xFE00, 0xFE0F},
+    {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0xFFF9, 0xFFFB}, {0x101FD, 0x101FD},
+    {0x10A01, 0x10A0F}, {0x10A38, 0x10A3F}, {0x11001, 0x11001}, {0x11038, 0x11046},
+    {0x1107F, 0x11081}, {0x110B3, 0x110B6}, {0x110B9, 0x110BA}, {0x11100, 0x11102},
+    {0x11127, 0x1112B}, {0x1112D, 0x11134}, {0x16AF0, 0x16AF4}, {0x16B30, 0x16B36},
+    {0x16F8F, 0x16F92}, {0x1BCA0, 0x1BCA3}, {0x1D167, 0x1D169}, {0x1D173, 0x1D182},
+    {0x1D185, 0x1D18B}, {0x1D1AA, 0x1D1AD}, {0x1E000, 0x1E02A}, {0x1E8D0, 0x1E8D6},
+    {0x1E944, 0x1E94A}, {0xE0001, 0xE0001}, {0xE0020, 0xE007F}, {0xE0100, 0xE01EF},
+};
+
+//! East Asian wide and fullwidth code points, which take two columns.
+constexpr CodePointRange WideRanges[] = {
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC},
+    {0x23F0, 0x23F0}, {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615},
+    {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+    {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE},
+    {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+    {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+    {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755},
+    {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x27BF, 0x27BF},
+    {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x2E99},
+    {0x2E9B, 0x2EF3}, {0x2F00, 0x2FD5}, {0x2FF0, 0x3029}, {0x302E, 0x303E},
+    {0x3041, 0x3096}, {0x309B, 0x30FF}, {0x3105, 0x312F}, {0x3131, 0x318E},
+    {0x3190, 0x31E3}, {0x31EF, 0x321E}, {0x3220, 0x3247}, {0x3250, 0x4DBF},
+    {0x4E00, 0xA48C}, {0xA490, 0xA4C6}, {0xA960, 0xA97C}, {0xAC00, 0xD7A3},
+    {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE52}, {0xFE54, 0xFE66},
+    {0xFE68, 0xFE6B}, {0xFF01, 0xFF60}, {0xFFE0, 0xFFE6}, {0x16FE0, 0x16FE4},
+    {0x16FF0, 0x16FF1}, {0x17000, 0x187F7}, {0x18800, 0x18CD5}, {0x18D00, 0x18D08},
+    {0x1AFF0, 0x1AFFE}, {0x1B000, 0x1B122}, {0x1B132, 0x1B132}, {0x1B150, 0x1B152},
+    {0x1B155, 0x1B155}, {0x1B164, 0x1B167}, {0x1B170, 0x1B2FB}, {0x1F004, 0x1F004},
+    {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A}, {0x1F200, 0x1F202},
+    {0x1F210, 0x1F23B}, {0x1F240, 0x1F248}, {0x1F250, 0x1F251}, {0x1F260, 0x1F265},
+    {0x1F300, 0x1F320}, {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C}, {0x1F37E, 0x1F393},
+    {0x1F3A0, 0x1F3CA}, {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0}, {0x1F3F4, 0x1F3F4},
+    {0x1F3F8, 0x1F43E}, {0x1F440, 0x1F440}, {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D},
+    {0x1F54B, 0x1F54E}, {0x1F550, 0x1F567}, {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596},
+    {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F}, {0x1F680, 0x1F6C5}, {0x1F6CC, 0x1F6CC},
+    {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6D7}, {0x1F6DC, 0x1F6DF}, {0x1F6EB, 0x1F6EC},
+    {0x1F6F4, 0x1F6FC}, {0x1F7E0, 0x1F7EB}, {0x1F7F0, 0x1F7F0}, {0x1F90C, 0x1F93A},
+    {0x1F93C, 0x1F945}, {0x1F947, 0x1F9FF}, {0x1FA70, 0x1FA7C}, {0x1FA80, 0x1FA88},
+    {0x1FA90, 0x1FABD}, {0x1FABF, 0x1FAC5}, {0x1FACE, 0x1FADB}, {0x1FAE0, 0x1FAE8},
+    {0x1FAF0, 0x1FAF8}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD},
+};
+
+template<std::size_t N>
+bool
+inRanges(const CodePointRange (&ranges)[N], char32_t cp)
+{
+    if(cp < ranges[0].first || cp > ranges[N - 1].last) {
+        return false;
+    }
+
+    auto it = std::upper_bound(ranges, ranges + N, cp, [] (char32_t value, const CodePointRange& range) {
+        return value < range.first;
+    });
+    return it != ranges && cp <= (it - 1)->last;
 }
 
-} // End anonymous namespace
+//! Decodes the code point at `pos`, returning its length in bytes.  Invalid
+//! bytes are taken one at a time, as U+FFFD.
+std::size_t
+decodeUtf8(std::string_view text, std::size_t pos, char32_t& cp)
+{
+    const auto lead = static_cast<unsigned char>(text[pos]);
+    std::size_t length = lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+    if(lead < 0xC2 || lead > 0xF4 || pos + length > text.size()) {
+        cp = 0xFFFD;
+        return 1;
+    }
+
+    cp = lead & (0x7F >> length);
+    for(std::size_t ii = 1; ii < length; ++ii) {
+        const auto next = static_cast<unsigned char>(text[pos + ii]);
+        if((next & 0xC0) != 0x80) {
+            cp = 0xFFFD;
+            return 1;
+        }
+        cp = (cp << 6) | (next & 0x3F);
+    }
 
-namespace argunaught
+    return length;
+}
+
+//! Returns whether all of `text` is ASCII, checking a word at a time.
+bool
+isAscii(std::string_view text)
 {
+    constexpr std::uint64_t HighBits = 0x8080808080808080ull;
 
-std::size_t 
-formatAndAppendText(
+    std::size_t pos = 0;
+    for(; pos + sizeof(std::uint64_t) <= text.size(); pos += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, text.data() + pos, sizeof(word));
+        if((word & HighBits) != 0) return false;
+    }
+
+    for(; pos < text.size(); ++pos) {
+        if(static_cast<unsigned char>(text[pos]) >= 0x80) return false;
+    }
+
+    return true;
+}
+
+/*!
+ *  Wraps by display columns, moving a whole code point at a time so a line is
+ *  never broken inside one.  With `Ascii` every byte is a column, which
+ *  compiles down to the byte counting loop.
+ */
+template<bool Ascii>
+std::size_t
+wrapText(
         std::string& dest, 
         std::size_t currLineLen,
         std::size_t currIndentAmount,
         std::size_t maxLineLength,
-        std::string value)
+        std::string_view value)
 {
-
     // TODO: Handle max allowed line < curr indent amount
-    // TODO: Handle hyphenating
 
     std::size_t start = 0;
     std::size_t prevWordLoc = 0;
 
-    for(std::size_t ii = 0; ii < value.size(); ii++) 
+    // The columns of the line from `start`, up to and including the last space.
+    std::size_t lineWidth = 0;
+    std::size_t wordWidth = 0;
+
+    // The last code point taking up columns, which moves to the next line
+    // when hyphenating, and the columns before it.
+    std::size_t lastCharLoc = 0;
+    std::size_t lastCharOffset = 0;
+
+    auto breakLine = [&] () {
+        dest += '\n';
+        dest.append(currIndentAmount, ' ');
+        currLineLen = currIndentAmount;
+    };
+
+    for(std::size_t ii = 0; ii < value.size(); ) 
     {
+        std::size_t length = 1;
+        std::size_t width = 1;
+        if constexpr(!Ascii) {
+            if(static_cast<unsigned char>(value[ii]) >= 0x80) {
+                char32_t cp;
+                length = decodeUtf8(value, ii, cp);
+                width = codePointWidth(cp);
+            }
+        }
+
+        if(value[ii] == '\n') {
+            dest.append(value.substr(start, ii - start));
+            breakLine();
+            start = ii + 1;
+            lineWidth = 0;
+            ii++;
+            continue;
+        }
+
+        const auto before = lineWidth;
+        lineWidth += width;
         if(value[ii] == ' ') {
             prevWordLoc = ii;
-        }
-        else if(value[ii] == '\n') {
-            dest += value.substr(start, ii - start) + "\n";
-            dest += std::string(currIndentAmount, ' ');
-            currLineLen = currIndentAmount;
-            start = ii+1;
-            ii++; // Jump past the new line.
+            wordWidth = lineWidth;
         }
 
-        if((currLineLen + ii - start) >= maxLineLength) {
-            if(start >= prevWordLoc) {
-                // hyphenate here.
-                dest += value.substr(start, ii - 1 - start) + "-\n";
-                dest += std::string(currIndentAmount, ' ');
-                currLineLen = currIndentAmount;
-                start = ii-1;
+        if(currLineLen + before + width > maxLineLength) {
+            if(start >= prevWordLoc && lastCharLoc > start) {
+                // hyphenate, moving the last character to the next line to make room.
+                dest.append(value.substr(start, lastCharLoc - start)) += '-';
+                breakLine();
+                lineWidth -= lastCharOffset;
+                start = lastCharLoc;
                 prevWordLoc = start;
             }
-            else {
+            else if(start < prevWordLoc) {
                 // word wrap break
-                dest += value.substr(start, prevWordLoc - start) + "\n";
-                dest += std::string(currIndentAmount, ' ');
-                currLineLen = currIndentAmount;
-                start = prevWordLoc+1;
+                dest.append(value.substr(start, prevWordLoc - start));
+                breakLine();
+                lineWidth -= wordWidth;
+                start = prevWordLoc + 1;
             }
-        } 
+        }
+
+        if(width > 0) {
+            lastCharLoc = ii;
+            lastCharOffset = lineWidth - width;
+        }
+
+        ii += length;
     }
-    
-    // Write any remaining text.
-    std::size_t left = value.size()-start;
-    if((currLineLen + left) >= maxLineLength) {
-        // if(start == prevWordLoc) {
-        //     // hyphenate here.
-        // }
 
+    // Write any remaining text.
+    if((currLineLen + lineWidth) >= maxLineLength && prevWordLoc > start) {
         // word wrap break
-        dest += value.substr(start, prevWordLoc - start) + "\n";
-        dest += std::string(currIndentAmount, ' ');
-        auto lastAmount = value.size()-prevWordLoc-1;
-        dest += value.substr(prevWordLoc+1, lastAmount);
-        currLineLen = currIndentAmount + lastAmount;
-    } 
+        dest.append(value.substr(start, prevWordLoc - start));
+        breakLine();
+        dest.append(value.substr(prevWordLoc + 1));
+        currLineLen += lineWidth - wordWidth;
+    }
     else {
-        dest += value.substr(start, left);
-        currLineLen += left;
+        dest.append(value.substr(start));
+        currLineLen += lineWidth;
     }
 
     return currLineLen;
 }
 
-void
-HelpFormatter::optionHelpName(Option const& opt)
-{
-    optionDash(true);
-    optionName(opt.longName);
-
-    if(opt.shortName.size() != 0) {
-        optionSeperator();
-
-        optionDash(false);
-        optionName(opt.shortName);   
-    }
-}
-
-std::size_t 
-HelpFormatter::optionHelpNameLength(Option const& opt)
-{
-    size_t length = 2 + opt.longName.size();
-    if(opt.shortName.size() != 0) {
-        length += 3 + opt.shortName.size();
-    }
-    return length;
-}
+} // End anonymous namespace
 
-void
-HelpFormatter::appendText(
-        std::string value,
-        bool handleFormatting
-    )
+std::size_t
+codePointWidth(char32_t cp)
 {
-    if(handleFormatting) {
-        mCurrLineLength = formatAndAppendText(
-                mHelpString, 
-                mCurrLineLength,
-                mCurrIndentAmount,
-                mMaxLineWidth,
-                value
-            );
-    } 
-    else {
-        // For unformatted text, simply append and update the current line length.
-        mHelpString += value;
-        mCurrLineLength += value.size();
+    // Latin, Greek and Cyrillic before the combining marks are all narrow.
+    if(cp < 0x0300) {
+        return (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) ? 0 : 1;
     }
-}
 
-void
-HelpFormatter::newLine() 
-{
-    mHelpString += '\n';
-    mCurrLineLength = 0;
+    if(inRanges(ZeroWidthRanges, cp)) return 0;
+    if(inRanges(WideRanges, cp)) return 2;
+    return 1;
 }
 
-void 
-HelpFormatter::indent(std::size_t amount)
-{
-    appendText(std::string(amount, ' '));
-}
-
-void 
-DefaultHelpFormatter::resetColor()
+std::size_t
+displayWidth(std::string_view text)
 {
-    if(mIsTTY) {
-        mHelpString += color::ResetColor;
+    if(isAscii(text)) {
+        return text.size();
     }
-}
 
-void
-DefaultHelpFormatter::generateCommandHelp(
-        CommandPtr com, 
-        int maxOptComLength
-    )
-{
-    commandName(com->name);
-            
-    if(com->description != "") {
-        // Justify the description.
-        if(maxOptComLength > 0 && 
-           com->name.size() < static_cast<std::size_t>(maxOptComLength)) {
-            indent(maxOptComLength - com->name.size());
+    // ASCII counts a column a byte, as when wrapping.
+    std::size_t width = 0;
+    for(std::size_t pos = 0; pos < text.size(); ) {
+        if(static_cast<unsigned char>(text[pos]) < 0x80) {
+            width++;
+            pos++;
+            continue;
         }
 
-        mCurrIndentAmount = maxOptComLength + mStyle.initialIndentLevel + mStyle.separator.size();
-        seperator();
-        commandDescription(com->description);
+        char32_t cp;
+        pos += decodeUtf8(text, pos, cp);
+        width += codePointWidth(cp);
     }
 
-    newLine();
-
-    // Print any command specific options with an extra level of indentation
-    for(auto opt : com->options.values()) 
-    {
-        indent(mStyle.initialIndentLevel + mStyle.spacesPerIndentLevel);
-        optionHelpName(opt);
-        auto optLen = optionHelpNameLength(opt);
-
-        if(opt.description != "") {
-
-            // Justify the description.
-            if(maxOptComLength > 0 &&
-               (optLen+mStyle.spacesPerIndentLevel) < static_cast<std::size_t>(maxOptComLength)) {
-                indent(maxOptComLength - optLen - mStyle.spacesPerIndentLevel);
-            }
-
-            mCurrIndentAmount = maxOptComLength + mStyle.initialIndentLevel + mStyle.separator.size();
-            seperator();
-            optionDescription(opt.description);
-        }
-        newLine();
-    }
+    return width;
 }
 
-void
-DefaultHelpFormatter::generateSubParserHelp(
-        SubParserPtr com, 
-        int maxOptComLength
-    )
+std::size_t 
+formatAndAppendText(
+        std::string& dest, 
+        std::size_t currLineLen,
+        std::size_t currIndentAmount,
+        std::size_t maxLineLength,
+        std::string_view value)
 {
-    commandName(com->name);
-            
-    // Print the sub parser description if it exists
-    if(com->description != "") {
-
-        // Justify the description.
-        if(maxOptComLength > 0 && 
-           com->name.size() < static_cast<std::size_t>(maxOptComLength)) {
-            indent(maxOptComLength - com->name.size());
+    if(isAscii(value)) {
+        // Most descriptions fit on the rest of their line as they are.
+        if(currLineLen + value.size() < maxLineLength && value.find('\n') == std::string_view::npos) {
+            dest.append(value);
+            return currLineLen + value.size();
         }
 
-        mCurrIndentAmount = maxOptComLength + mStyle.initialIndentLevel + mStyle.separator.size();
-        seperator();
-        commandDescription(com->description);
+        return wrapText<true>(dest, currLineLen, currIndentAmount, maxLineLength, value);
     }
 
-    newLine();
-
-    // Print any command specific options with an extra level of indentation
-    for(auto opt : com->options.values()) 
-    {
-        indent(mStyle.initialIndentLevel + mStyle.spacesPerIndentLevel);
-        optionHelpName(opt);
-        auto optLen = optionHelpNameLength(opt);
-
-        // Print the option description
-        if(opt.description != "") {
-
-            // Justify the description.
-            if((maxOptComLength > 0 &&
-                optLen+mStyle.spacesPerIndentLevel) < static_cast<std::size_t>(maxOptComLength)) {
-                indent(maxOptComLength - optLen - mStyle.spacesPerIndentLevel);
-            }
+    return wrapText<false>(dest, currLineLen, currIndentAmount, maxLineLength, value);
+}
 
-            mCurrIndentAmount = maxOptComLength + mStyle.initialIndentLevel + mStyle.separator.size();
-            seperator();
-            optionDescription(opt.description);
-        }
-        newLine();
-    }
+std::size_t
+terminalWidth()
+{
+    struct winsize size = {};
+    ioctl(STDOUT_FILENO, TIOCGWINSZ, &size);
+    return static_cast<std::size_t>(size.ws_col);
 }
 
-DefaultHelpFormatter::DefaultHelpFormatter(
-        Parser& parser,
-        DefaultFormatStyle style,
-        bool forceNoColor
-    )
-    : mParser(parser),
-      mStyle(style)
+bool
+stdoutIsTTY()
 {
-    mMaxOptComLength = std::max(findMaxOptComLength(parser, style.spacesPerIndentLevel), style.maxJustified);
-    if(forceNoColor) {
-        mIsTTY = false;
-    }
-    else {
-        mIsTTY = isatty(fileno(stdout)) != 0;
-    }
-    mMaxLineWidth = std::min(style.maxLineLength, displayWidth()-1);
+    return isatty(fileno(stdout)) != 0;
 }
 
+template class BasicHelpFormatter<void, DefaultFormatStyle>;
+
 void 
 DefaultHelpFormatter::programName(std::string name)
 {
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.programNameColor;
-    }
-    
-    appendText(name);
-    resetColor();
-    newLine();
+    Base::programName(name);
 }
 
 void 
 DefaultHelpFormatter::beginGroup(std::string value)
 {
-    newLine();
-
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.groupNameColor;
-    }
-    
-    appendText(value + mStyle.groupNameSuffix);
-    resetColor();
-    newLine();
+    Base::beginGroup(value);
 }
 
 void 
 DefaultHelpFormatter::endGroup()
 {
-    mHelpString += "\n";
+    Base::endGroup();
 }
 
 void 
 DefaultHelpFormatter::commandName(std::string key)
 {
-    indent(mStyle.initialIndentLevel);
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.commandNameColor;
-    }
-    
-    appendText(key);
-    resetColor();
+    Base::commandName(key);
 }
 
 void 
 DefaultHelpFormatter::optionName(std::string key)
 {
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.optionNameColor;
-    }
-    
-    appendText(key);
-    resetColor();
+    Base::optionName(key);
 }
 
 void 
 DefaultHelpFormatter::optionDash(bool longDash)
 {
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.optionDashColor;
-    }
-    
-    if(longDash) {
-        appendText("--");
-    }
-    else {
-        appendText("-");
-    }
-
-    resetColor();
+    Base::optionDash(longDash);
 }
 
 void 
 DefaultHelpFormatter::optionSeperator()
 {
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.optionSeparatorColor;
-    }
-    
-    appendText(mStyle.optionSeparator);
-    resetColor();
+    Base::optionSeperator();
 }
 
 void 
 DefaultHelpFormatter::seperator()
 {
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.separatorColor;
-    }
-    
-    appendText(mStyle.separator);
-    resetColor();
-}
-
-void 
-DefaultHelpFormatter::programDescription(std::string value)
-{
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.programDescriptionColor;
-    }
-    
-    appendText(value, true);
-    newLine();
-    resetColor();
-}
-
-void 
-DefaultHelpFormatter::programUsage(std::string value)
-{
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.programUsageColor;
-    }
-    
-    appendText(value, true);
-    newLine();
-    resetColor();
+    Base::seperator();
 }
 
 void 
 DefaultHelpFormatter::groupDescription(std::string value)
 {
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.groupDescriptionColor;
-    }
-    
-    appendText(value, true);
-    resetColor();
+    Base::groupDescription(value);
 }
 
 void 
 DefaultHelpFormatter::commandDescription(std::string value)
 {
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.commandDescriptionColor;
-    }
-    
-    appendText(value, true);
-    resetColor();
+    Base::commandDescription(value);
 }
 
 void 
 DefaultHelpFormatter::optionDescription(std::string value)
 {
-    if(mIsTTY) {
-        resetColor();
-        mHelpString += mStyle.optionDescriptionColor;
-    }
-    
-    appendText(value, true);
-    resetColor();
+    Base::optionDescription(value);
 }
 
-std::size_t 
-HelpFormatter::findMaxOptComLength(Parser& parser, std::size_t indentPerLevel)
+void 
+DefaultHelpFormatter::programDescription(std::string value)
 {
-    // First find the max length of option/command pieces
-    std::size_t maxOptComLength = 0;
-    for(auto opt : parser.mOptions.values()) {
-        maxOptComLength = std::max(maxOptComLength, optionHelpNameLength(opt));
-    }
-
-    for(auto com : parser.mCommands) {
-        maxOptComLength = std::max(maxOptComLength, com->name.size());
-        for(auto opt : com->options.values()) {
-            maxOptComLength = std::max(maxOptComLength, optionHelpNameLength(opt) + indentPerLevel);
-        }
-    }
-
-    // Check across grouped commands as well.
-    for(const auto& group : parser.mGroups) {
-        for(auto com : group.commands) {
-            maxOptComLength = std::max(maxOptComLength, com->name.size());
-            for(auto opt : com->options.values()) {
-                maxOptComLength = std::max(maxOptComLength, optionHelpNameLength(opt) + indentPerLevel);
-            }
-        }
-    }
-
-    return maxOptComLength;
+    Base::programDescription(value);
 }
 
-std::string 
-DefaultHelpFormatter::helpString()
+void 
+DefaultHelpFormatter::programUsage(std::string value)
 {
-    mHelpString = "";
-    mCurrLineLength = 0;
-
-    if(mParser.mBanner != "") {
-        programName(mParser.mBanner);
-    }
-    else {
-        programName(mParser.mName);
-    }
-
-    if(mParser.mDescription != "") {
-        programDescription(mParser.mDescription);
-    }
-
-    if(mParser.mUsage != "") {
-        programUsage(mParser.mUsage);
-    }
-
-    // Now build up the help string.
-    if( mParser.mOptions.values().size() > 0 )
-    {
-        beginGroup("Global Options");
-        for(auto opt : mParser.mOptions.values()) {
-            indent(mStyle.initialIndentLevel);
-            optionHelpName(opt);
-            auto optLen = optionHelpNameLength(opt);
-
-            // Justify the description.
-            if(optLen < mMaxOptComLength) {
-                indent(mMaxOptComLength - optLen);
-            }
-
-            if(opt.description != "") {
-                mCurrIndentAmount = mMaxOptComLength + mStyle.initialIndentLevel + mStyle.separator.size();
-                seperator();
-                optionDescription(opt.description);
-            }
-
-            newLine();
-        }
-    }
-
-    if( mParser.mCommands.size() > 0 )
-    {
-        beginGroup("Commands");
-
-        for(auto com : mParser.mCommands) {
-            generateCommandHelp(com, mMaxOptComLength);
-        }
-        
-        for(auto sub : mParser.mSubParsers) {
-            generateSubParserHelp(sub, mMaxOptComLength);
-        }
-    }
-
-    if(mParser.mGroups.size() > 0) {
-        for(const auto& group : mParser.mGroups) 
-        {
-            beginGroup(group.name);
-            if(group.description != "") {
-
-                indent(mStyle.initialIndentLevel);
-                mCurrIndentAmount = mStyle.initialIndentLevel;
-
-                groupDescription(group.description);
-
-                newLine();
-                newLine();
-            }
-
-            for(auto com : group.commands) {
-                generateCommandHelp(com, mMaxOptComLength);
-            }
-
-            for(auto sub : group.subParsers) {
-                generateSubParserHelp(sub, mMaxOptComLength);
-            }
-        }
-    }
-
-    newLine();
-    return mHelpString;
+    Base::programUsage(value);
 }
 
 }
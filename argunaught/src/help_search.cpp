@@ -0,0 +1,283 @@
+#include <cctype>
+#include <unordered_map>
+
+#include <argunaught/help_search.hpp>
+
+namespace argunaught
+{
+
+namespace
+{
+
+//! Weights of words by where they appear.
+constexpr float NameWeight = 8.0f;
+constexpr float OptionNameWeight = 3.0f;
+constexpr float GroupWeight = 2.0f;
+constexpr float DescriptionWeight = 1.0f;
+
+//! Words a query term is only a prefix of count for this much of their weight.
+constexpr float PrefixMatchFactor = 0.5f;
+
+//! Calls `func` with each lower cased run of letters and digits in `text`.
+template<typename Func>
+void
+forEachWord(std::string_view text, Func func)
+{
+    std::string word;
+    for(char ch : text) {
+        auto uch = static_cast<unsigned char>(ch);
+        if(std::isalnum(uch) || uch >= 0x80) {
+            word += static_cast<char>(std::tolower(uch));
+        }
+        else if(!word.empty()) {
+            func(word);
+            word.clear();
+        }
+    }
+
+    if(!word.empty()) {
+        func(word);
+    }
+}
+
+std::string
+toLower(std::string_view text)
+{
+    std::string lower(text);
+    for(auto& ch : lower) {
+        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+
+    return lower;
+}
+
+//! Collects postings while building, merging repeats of a word in one document.
+class IndexBuilder
+{
+private:
+    std::unordered_map<std::string, std::vector<std::pair<std::uint32_t, float>>> mPostings;
+    std::uint32_t mDocument = 0;
+
+public:
+    void beginDocument(std::uint32_t document) { mDocument = document; }
+
+    void addWord(const std::string& word, float weight)
+    {
+        auto& postings = mPostings[word];
+        if(!postings.empty() && postings.back().first == mDocument) {
+            postings.back().second += weight;
+        }
+        else {
+            postings.emplace_back(mDocument, weight);
+        }
+    }
+
+    void addText(std::string_view text, float weight)
+    {
+        forEachWord(text, [this, weight] (const std::string& word) { addWord(word, weight); });
+    }
+
+    //! Adds a name whole as well as its words, e.g. `dry-run` and `dry` and `run`.
+    void addName(std::string_view name, float weight)
+    {
+        auto whole = toLower(name);
+        if(!whole.empty()) {
+            addWord(whole, weight);
+        }
+
+        forEachWord(name, [this, &whole, weight] (const std::string& word) {
+            if(word != whole) addWord(word, weight);
+        });
+    }
+
+    void addOptions(const OptionList& options)
+    {
+        for(const auto& opt : options) {
+            addName(opt.longName, OptionNameWeight);
+            if(!opt.shortName.empty()) {
+                addName(opt.shortName, OptionNameWeight);
+            }
+            addText(opt.description.str(), DescriptionWeight);
+        }
+    }
+
+    std::unordered_map<std::string, std::vector<std::pair<std::uint32_t, float>>>& postings() { return mPostings; }
+};
+
+}
+
+bool
+HelpIndex::isCurrent(const Parser& parser) const
+{
+    return parser.mGeneration == mGeneration;
+}
+
+const std::string&
+HelpIndex::documentName(const Document& doc) const
+{
+    switch(doc.kind)
+    {
+        case HelpSearchKind::LazyCommand:
+            return doc.lazyCommand->name;
+
+        case HelpSearchKind::SubParser:
+            return doc.subParser->name;
+
+        default:
+            return doc.command->name;
+    }
+}
+
+std::shared_ptr<const HelpIndex>
+HelpIndex::build(const Parser& parser)
+{
+    auto index = std::make_shared<HelpIndex>();
+    index->mGeneration = parser.mGeneration;
+
+    IndexBuilder builder;
+    auto addDocument = [&] (Document doc, const CommandGroup* group) {
+        builder.beginDocument(static_cast<std::uint32_t>(index->mDocuments.size()));
+        builder.addName(index->documentName(doc), NameWeight);
+
+        switch(doc.kind)
+        {
+            case HelpSearchKind::LazyCommand:
+                builder.addText(doc.lazyCommand->shortHelp, DescriptionWeight);
+                break;
+
+            case HelpSearchKind::SubParser:
+                builder.addText(doc.subParser->description.str(), DescriptionWeight);
+                builder.addOptions(doc.subParser->options);
+                break;
+
+            default:
+                builder.addText(doc.command->description.str(), DescriptionWeight);
+                builder.addOptions(doc.command->options);
+                break;
+        }
+
+        if(group != nullptr) {
+            builder.addName(group->name, GroupWeight);
+            builder.addText(group->description.str(), DescriptionWeight);
+            doc.group = group->name;
+        }
+
+        index->mDocuments.push_back(std::move(doc));
+    };
+
+    auto addCommands = [&] (const CommandList& commands,
+                            const std::vector<LazyCommandPtr>& lazyCommands,
+                            const SubParserList& subParsers,
+                            const CommandGroup* group)
+    {
+        for(const auto& com : commands) {
+            addDocument({HelpSearchKind::Command, {}, com, nullptr, nullptr}, group);
+        }
+
+        for(const auto& com : lazyCommands) {
+            addDocument({HelpSearchKind::LazyCommand, {}, nullptr, com, nullptr}, group);
+        }
+
+        for(const auto& sub : subParsers) {
+            addDocument({HelpSearchKind::SubParser, {}, nullptr, nullptr, sub}, group);
+        }
+    };
+
+    addCommands(parser.mCommands, parser.mLazyCommands, parser.mSubParsers, nullptr);
+    for(const auto& group : parser.mGroups) {
+        addCommands(group.commands, group.lazyCommands, group.subParsers, &group);
+    }
+
+    // Sorted terms allow prefix matches with a binary search.
+    auto& postings = builder.postings();
+    index->mTerms.reserve(postings.size());
+    for(const auto& entry : postings) {
+        index->mTerms.push_back(entry.first);
+    }
+    std::sort(index->mTerms.begin(), index->mTerms.end());
+
+    index->mPostings.reserve(index->mTerms.size());
+    for(const auto& term : index->mTerms) {
+        std::vector<Posting> list;
+        for(const auto& [document, weight] : postings[term]) {
+            list.push_back({document, weight});
+        }
+        index->mPostings.push_back(std::move(list));
+    }
+
+    return index;
+}
+
+std::vector<HelpSearchHit>
+HelpIndex::search(std::string_view query, std::size_t maxResults) const
+{
+    std::vector<std::string> queryTerms;
+    forEachWord(query, [&queryTerms] (const std::string& word) {
+        if(std::find(queryTerms.begin(), queryTerms.end(), word) == queryTerms.end()) {
+            queryTerms.push_back(word);
+        }
+    });
+
+    std::vector<float> scores(mDocuments.size(), 0.0f);
+    std::vector<std::uint32_t> matched(mDocuments.size(), 0);
+
+    // The best weight each document has for the current term, so several
+    // words sharing a prefix don't add up.
+    std::vector<float> termScores(mDocuments.size(), 0.0f);
+    std::vector<std::uint32_t> touched;
+
+    for(const auto& term : queryTerms) {
+        auto first = std::lower_bound(mTerms.begin(), mTerms.end(), term);
+        for(auto it = first; it != mTerms.end() && it->compare(0, term.size(), term) == 0; ++it) {
+            const float factor = it->size() == term.size() ? 1.0f : PrefixMatchFactor;
+            for(const auto& posting : mPostings[static_cast<std::size_t>(it - mTerms.begin())]) {
+                auto& best = termScores[posting.document];
+                if(best == 0.0f) {
+                    touched.push_back(posting.document);
+                }
+                best = std::max(best, posting.weight * factor);
+            }
+        }
+
+        for(auto document : touched) {
+            scores[document] += termScores[document];
+            matched[document]++;
+            termScores[document] = 0.0f;
+        }
+        touched.clear();
+    }
+
+    std::vector<std::uint32_t> found;
+    for(std::uint32_t ii = 0; ii < mDocuments.size(); ++ii) {
+        if(matched[ii] > 0) found.push_back(ii);
+    }
+
+    auto better = [&] (std::uint32_t lhs, std::uint32_t rhs) {
+        if(matched[lhs] != matched[rhs]) return matched[lhs] > matched[rhs];
+        if(scores[lhs] != scores[rhs]) return scores[lhs] > scores[rhs];
+        return documentName(mDocuments[lhs]) < documentName(mDocuments[rhs]);
+    };
+
+    const auto numResults = std::min(maxResults, found.size());
+    std::partial_sort(found.begin(), found.begin() + static_cast<std::ptrdiff_t>(numResults), found.end(), better);
+
+    std::vector<HelpSearchHit> hits;
+    hits.reserve(numResults);
+    for(std::size_t ii = 0; ii < numResults; ++ii) {
+        const auto& doc = mDocuments[found[ii]];
+        hits.push_back({
+            doc.kind,
+            documentName(doc),
+            doc.group,
+            matched[found[ii]],
+            scores[found[ii]],
+            doc.command,
+            doc.lazyCommand,
+            doc.subParser
+        });
+    }
+
+    return hits;
+}
+
+}
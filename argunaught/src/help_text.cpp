@@ -0,0 +1,464 @@
+#include <argunaught/help_text.hpp>
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace argunaught
+{
+
+namespace
+{
+
+constexpr char Magic[8] = {'A', 'R', 'G', 'U', 'H', 'E', 'L', 'P'};
+constexpr std::uint32_t Version = 1;
+
+//! Written as is, so a blob from a machine with the other byte order won't match.
+constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t totalSize;
+    std::uint32_t numTexts;
+    std::uint32_t numBlocks;
+    std::uint32_t reserved;
+};
+
+//! Where a text is in its decompressed block.
+struct TextRecord
+{
+    std::uint32_t block;
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+struct BlockRecord
+{
+    std::uint32_t offset;
+    std::uint32_t compressedSize;
+    std::uint32_t size;
+};
+
+static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) % 4 == 0);
+
+constexpr std::size_t TextsOffset = sizeof(Header);
+
+/*
+ *  Blocks are a series of sequences, each a token byte, literals, and a match
+ *  copied from earlier output.  The token's high nibble is the number of
+ *  literals and its low nibble the match length less `MinMatch`, either
+ *  continued by bytes added on while they're 255.  A match's offset back is two
+ *  little endian bytes after the literals.  The last sequence has no match.
+ */
+constexpr std::size_t MinMatch = 4;
+constexpr std::size_t MaxOffset = 0xFFFF;
+constexpr std::size_t HashBits = 12;
+
+std::uint32_t
+hashAt(const char* data)
+{
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return (value * 2654435761u) >> (32 - HashBits);
+}
+
+void
+appendLength(std::string& out, std::size_t length)
+{
+    while(length >= 255) {
+        out += static_cast<char>(255);
+        length -= 255;
+    }
+    out += static_cast<char>(length);
+}
+
+void
+appendSequence(std::string& out, std::string_view literals, std::size_t offset, std::size_t matchLength)
+{
+    const auto matchCode = matchLength > 0 ? matchLength - MinMatch : 0;
+    out += static_cast<char>((std::min<std::size_t>(literals.size(), 15) << 4) | std::min<std::size_t>(matchCode, 15));
+    if(literals.size() >= 15) appendLength(out, literals.size() - 15);
+    out += literals;
+
+    if(matchLength > 0) {
+        out += static_cast<char>(offset & 0xFF);
+        out += static_cast<char>(offset >> 8);
+        if(matchCode >= 15) appendLength(out, matchCode - 15);
+    }
+}
+
+std::string
+compressBlock(std::string_view in)
+{
+    std::string out;
+    std::vector<std::int32_t> table(std::size_t(1) << HashBits, -1);
+
+    std::size_t anchor = 0;
+    std::size_t pos = 0;
+    while(pos + MinMatch <= in.size()) {
+        auto& slot = table[hashAt(in.data() + pos)];
+        const auto candidate = slot;
+        slot = static_cast<std::int32_t>(pos);
+
+        if(candidate < 0 || pos - candidate > MaxOffset ||
+           std::memcmp(in.data() + candidate, in.data() + pos, MinMatch) != 0) {
+            pos++;
+            continue;
+        }
+
+        auto length = MinMatch;
+        while(pos + length < in.size() && in[candidate + length] == in[pos + length]) {
+            length++;
+        }
+
+        appendSequence(out, in.substr(anchor, pos - anchor), pos - candidate, length);
+        pos += length;
+        anchor = pos;
+    }
+
+    appendSequence(out, in.substr(anchor), 0, 0);
+    return out;
+}
+
+std::string
+decompressBlock(const char* data, std::size_t size, std::size_t outSize)
+{
+    auto fail = [] () -> void {
+        throw std::runtime_error("Invalid argunaught help resource: corrupt block");
+    };
+
+    std::string out;
+    out.reserve(outSize);
+
+    std::size_t pos = 0;
+    auto readLength = [&] (std::size_t length) {
+        if(length < 15) return length;
+        std::uint8_t byte;
+        do {
+            if(pos >= size) fail();
+            byte = static_cast<std::uint8_t>(data[pos++]);
+            length += byte;
+        } while(byte == 255);
+        return length;
+    };
+
+    while(pos < size) {
+        const auto token = static_cast<std::uint8_t>(data[pos++]);
+        const auto numLiterals = readLength(token >> 4);
+        if(numLiterals > size - pos || numLiterals > outSize - out.size()) fail();
+        out.append(data + pos, numLiterals);
+        pos += numLiterals;
+
+        if(pos == size) break;
+
+        if(size - pos < 2) fail();
+        const auto offset = static_cast<std::size_t>(static_cast<std::uint8_t>(data[pos])) |
+                            static_cast<std::size_t>(static_cast<std::uint8_t>(data[pos + 1])) << 8;
+        pos += 2;
+
+        const auto length = readLength(token & 0x0F) + MinMatch;
+        if(offset == 0 || offset > out.size() || length > outSize - out.size()) fail();
+
+        // Byte at a time, as matches may overlap what they produce.
+        auto from = out.size() - offset;
+        for(std::size_t ii = 0; ii < length; ++ii) {
+            out += out[from + ii];
+        }
+    }
+
+    if(out.size() != outSize) fail();
+    return out;
+}
+
+template<typename T>
+void
+appendRecord(std::string& out, const T& record)
+{
+    out.append(reinterpret_cast<const char*>(&record), sizeof(T));
+}
+
+}
+
+HelpText::HelpText(const HelpResource& resource, std::uint32_t id)
+    : mValue(Reference{&resource, id, nullptr})
+{
+    if(id >= resource.size()) {
+        throw std::runtime_error("Help text id out of range: " + std::to_string(id));
+    }
+}
+
+bool
+HelpText::empty() const
+{
+    return size() == 0;
+}
+
+std::size_t
+HelpText::size() const
+{
+    if(auto ref = std::get_if<Reference>(&mValue)) {
+        return ref->resource->length(ref->id);
+    }
+
+    return std::get<std::string>(mValue).size();
+}
+
+std::string
+HelpText::str() const
+{
+    if(auto ref = std::get_if<Reference>(&mValue)) {
+        return ref->resource->text(ref->id);
+    }
+
+    return std::get<std::string>(mValue);
+}
+
+std::string_view
+HelpText::view(std::string& storage) const
+{
+    if(auto ref = std::get_if<Reference>(&mValue)) {
+        storage = ref->resource->text(ref->id);
+        return storage;
+    }
+
+    return std::get<std::string>(mValue);
+}
+
+const char*
+HelpText::c_str() const
+{
+    auto ref = std::get_if<Reference>(&mValue);
+    if(ref == nullptr) {
+        return std::get<std::string>(mValue).c_str();
+    }
+
+    // Only ever set once, so a pointer handed out is never freed while this text lives.
+    auto cached = std::atomic_load(&ref->text);
+    if(cached == nullptr) {
+        auto text = std::make_shared<const std::string>(ref->resource->text(ref->id));
+        cached = std::atomic_compare_exchange_strong(&ref->text, &cached, text) ? text : cached;
+    }
+
+    return cached->c_str();
+}
+
+bool
+operator==(const HelpText& lhs, const HelpText& rhs)
+{
+    if(lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    std::string storage;
+    return lhs == rhs.view(storage);
+}
+
+bool
+operator!=(const HelpText& lhs, const HelpText& rhs)
+{
+    return !(lhs == rhs);
+}
+
+bool
+operator==(const HelpText& lhs, std::string_view rhs)
+{
+    if(lhs.empty() || rhs.empty()) {
+        return lhs.empty() && rhs.empty();
+    }
+
+    const auto text = lhs.str();
+    return std::string_view(text) == rhs;
+}
+
+bool
+operator!=(const HelpText& lhs, std::string_view rhs)
+{
+    return !(lhs == rhs);
+}
+
+std::ostream&
+operator<<(std::ostream& out, const HelpText& text)
+{
+    std::string storage;
+    return out << text.view(storage);
+}
+
+std::string
+operator+(const HelpText& lhs, const HelpText& rhs)
+{
+    return lhs.str() + rhs.str();
+}
+
+std::string
+operator+(const HelpText& lhs, std::string_view rhs)
+{
+    auto result = lhs.str();
+    result += rhs;
+    return result;
+}
+
+std::string
+operator+(std::string_view lhs, const HelpText& rhs)
+{
+    std::string storage;
+    auto text = rhs.view(storage);
+
+    std::string result;
+    result.reserve(lhs.size() + text.size());
+    result += lhs;
+    result += text;
+    return result;
+}
+
+std::string
+HelpResource::compress(const std::vector<std::string>& texts)
+{
+    std::vector<TextRecord> records;
+    std::vector<std::string> blocks;
+    std::string block;
+
+    for(const auto& text : texts) {
+        // Texts aren't split over blocks, so reading one decompresses one block.
+        if(!block.empty() && block.size() + text.size() > BlockSize) {
+            blocks.push_back(std::move(block));
+            block.clear();
+        }
+
+        records.push_back({
+            static_cast<std::uint32_t>(blocks.size()),
+            static_cast<std::uint32_t>(block.size()),
+            static_cast<std::uint32_t>(text.size())
+        });
+        block += text;
+    }
+
+    // Kept even if empty, as the last texts refer to it.
+    if(!records.empty() && records.back().block == blocks.size()) {
+        blocks.push_back(std::move(block));
+    }
+
+    std::vector<std::string> compressed;
+    for(const auto& raw : blocks) {
+        compressed.push_back(compressBlock(raw));
+    }
+
+    std::size_t offset = sizeof(Header) + records.size() * sizeof(TextRecord) + blocks.size() * sizeof(BlockRecord);
+    std::string blob;
+
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.numTexts = static_cast<std::uint32_t>(records.size());
+    header.numBlocks = static_cast<std::uint32_t>(blocks.size());
+    appendRecord(blob, header);
+
+    for(const auto& record : records) {
+        appendRecord(blob, record);
+    }
+
+    for(std::size_t ii = 0; ii < blocks.size(); ++ii) {
+        appendRecord(blob, BlockRecord{
+            static_cast<std::uint32_t>(offset),
+            static_cast<std::uint32_t>(compressed[ii].size()),
+            static_cast<std::uint32_t>(blocks[ii].size())
+        });
+        offset += compressed[ii].size();
+    }
+
+    for(const auto& data : compressed) {
+        blob += data;
+    }
+
+    header.totalSize = static_cast<std::uint32_t>(blob.size());
+    std::memcpy(blob.data(), &header, sizeof(Header));
+    return blob;
+}
+
+template<typename T>
+T
+HelpResource::read(std::size_t offset) const
+{
+    // Copied out rather than cast, so the blob needn't be aligned.
+    T value;
+    std::memcpy(&value, mData + offset, sizeof(T));
+    return value;
+}
+
+HelpResource::HelpResource(const void* data, std::size_t size)
+    : mData(static_cast<const char*>(data)), mSize(size)
+{
+    auto fail = [] (const std::string& reason) {
+        throw std::runtime_error("Invalid argunaught help resource: " + reason);
+    };
+
+    if(mSize < sizeof(Header)) {
+        fail("too small");
+    }
+
+    auto header = read<Header>(0);
+    if(std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) fail("bad magic");
+    if(header.byteOrder != ByteOrderMark) fail("written with a different byte order");
+    if(header.version != Version) fail("unsupported version " + std::to_string(header.version));
+    if(header.totalSize != mSize) fail("truncated");
+
+    const std::size_t tablesSize = std::size_t(header.numTexts) * sizeof(TextRecord) +
+                                   std::size_t(header.numBlocks) * sizeof(BlockRecord);
+    if(tablesSize > mSize - sizeof(Header)) fail("tables out of bounds");
+
+    mNumTexts = header.numTexts;
+    mNumBlocks = header.numBlocks;
+
+    // Checked up front so reading a text can only fail on a corrupt block.
+    const auto blocksOffset = TextsOffset + mNumTexts * sizeof(TextRecord);
+    for(std::uint32_t ii = 0; ii < mNumBlocks; ++ii) {
+        auto block = read<BlockRecord>(blocksOffset + ii * sizeof(BlockRecord));
+        if(block.offset > mSize || block.compressedSize > mSize - block.offset) fail("block out of bounds");
+    }
+
+    for(std::uint32_t ii = 0; ii < mNumTexts; ++ii) {
+        auto text = read<TextRecord>(TextsOffset + ii * sizeof(TextRecord));
+        if(text.block >= mNumBlocks) fail("text out of bounds");
+
+        auto block = read<BlockRecord>(blocksOffset + text.block * sizeof(BlockRecord));
+        if(text.offset > block.size || text.size > block.size - text.offset) fail("text out of bounds");
+    }
+}
+
+std::size_t
+HelpResource::length(std::uint32_t id) const
+{
+    if(id >= mNumTexts) {
+        throw std::runtime_error("Help text id out of range: " + std::to_string(id));
+    }
+
+    return read<TextRecord>(TextsOffset + id * sizeof(TextRecord)).size;
+}
+
+std::string
+HelpResource::text(std::uint32_t id) const
+{
+    if(id >= mNumTexts) {
+        throw std::runtime_error("Help text id out of range: " + std::to_string(id));
+    }
+
+    auto record = read<TextRecord>(TextsOffset + id * sizeof(TextRecord));
+    if(record.size == 0) {
+        return "";
+    }
+
+    std::lock_guard<std::mutex> lock(mCacheMutex);
+    if(mCachedBlock != record.block) {
+        auto block = read<BlockRecord>(TextsOffset + mNumTexts * sizeof(TextRecord) + record.block * sizeof(BlockRecord));
+        mCache = decompressBlock(mData + block.offset, block.compressedSize, block.size);
+        mCachedBlock = record.block;
+    }
+
+    return mCache.substr(record.offset, record.size);
+}
+
+}
@@ -11,11 +11,6 @@ OptionList::OptionList(std::vector<Option> opts)
     }
 }
 
-OptionList::OptionList(const OptionList& opts)
-    : OptionList(opts.mOptions)
-{
-}
-
 ParserConfigErrorType 
 OptionList::addOption(Option opt)
 {
@@ -31,24 +26,32 @@ OptionList::addOption(Option opt)
         return ParserConfigErrorType::OptionBeginsWithNumber;
     }
 
-    for(auto& el : mOptions) {
-        if(opt.longName == el.longName) {
-            return ParserConfigErrorType::DuplicateOption;
-        } 
-        else if(opt.shortName.size() > 0 &&
-                opt.shortName == el.shortName) {
-            return ParserConfigErrorType::DuplicateOption;
-        }
+    if(findLongOptionIndex(opt.longName).has_value() || 
+       (opt.shortName.size() > 0 && findShortOptionIndex(opt.shortName).has_value()))
+    {
+        return ParserConfigErrorType::DuplicateOption;
+    }
+
+    if(opt.required || !opt.conflictsWith.empty() || !opt.dependsOn.empty()) {
+        mDeclaresConstraints = true;
+    }
+
+    const auto index = static_cast<std::uint32_t>(mOptions.size());
+    const bool hasShortName = opt.shortName.size() > 0;
+    mOptions.push_back(std::move(opt));
+
+    mLongIndex.insert(index, mOptions, &Option::longName);
+    if(hasShortName) {
+        mShortIndex.insert(index, mOptions, &Option::shortName);
     }
 
-    mOptions.push_back(opt);
     return ParserConfigErrorType::NoError;
 }
 
 ParserConfigErrorType 
 OptionList::addOptions(const OptionList& opts)
 {
-    for(auto& el : opts.mOptions) {
+    for(auto& el : opts) {
         auto res = addOption(el);
         if(res != ParserConfigErrorType::NoError) {
             // Error out on first issue
@@ -59,17 +62,96 @@ OptionList::addOptions(const OptionList& opts)
     return ParserConfigErrorType::NoError;
 }
 
+bool
+OptionList::clashesWith(const std::vector<Option>& options) const
+{
+    for(const auto& opt : options) {
+        if(findLongOptionIndex(opt.longName).has_value() ||
+           (opt.shortName.size() > 0 && findShortOptionIndex(opt.shortName).has_value()))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ParserConfigErrorType 
+OptionList::include(OptionListPtr pack)
+{
+    if(pack == nullptr) {
+        return ParserConfigErrorType::NoError;
+    }
+
+    // Packs are kept flat so lookups never recurse, each layer holding just 
+    // the own options of the pack or of a pack it includes.
+    std::vector<OptionListPtr> layers;
+    auto addLayer = [this, &layers] (const OptionListPtr& layer) {
+        auto included = [&layer] (const std::vector<OptionListPtr>& list) {
+            return std::find(list.begin(), list.end(), layer) != list.end();
+        };
+
+        if(!layer->mOptions.empty() && !included(mPacks) && !included(layers)) {
+            layers.push_back(layer);
+        }
+    };
+
+    addLayer(pack);
+    for(const auto& layer : pack->mPacks) {
+        addLayer(layer);
+    }
+
+    // Check whichever side is smaller for clashing names.
+    for(const auto& layer : layers) {
+        bool clash = false;
+        if(layer->mOptions.size() <= size()) {
+            clash = clashesWith(layer->mOptions);
+        }
+        else {
+            clash = std::any_of(begin(), end(), [&layer] (const Option& opt) {
+                return layer->mLongIndex.find(opt.longName, layer->mOptions, &Option::longName).has_value() ||
+                       (opt.shortName.size() > 0 && 
+                        layer->mShortIndex.find(opt.shortName, layer->mOptions, &Option::shortName).has_value());
+            });
+        }
+
+        if(clash) {
+            return ParserConfigErrorType::DuplicateOption;
+        }
+    }
+
+    for(auto& layer : layers) {
+        mPackOffsets.push_back(mNumPackOptions);
+        mNumPackOptions += static_cast<std::uint32_t>(layer->mOptions.size());
+        mPacks.push_back(std::move(layer));
+    }
+
+    return ParserConfigErrorType::NoError;
+}
+
+const Option& 
+OptionList::at(std::size_t index) const
+{
+    if(index < mOptions.size()) {
+        return mOptions[index];
+    }
+
+    if(index >= size()) {
+        throw std::out_of_range("Option index out of range!");
+    }
+
+    const auto packIndex = index - mOptions.size();
+    auto next = std::upper_bound(mPackOffsets.begin(), mPackOffsets.end(), packIndex);
+    auto layer = static_cast<std::size_t>(next - mPackOffsets.begin()) - 1;
+    return mPacks[layer]->mOptions[packIndex - mPackOffsets[layer]];
+}
+
 std::optional<Option> 
 OptionList::findShortOption(std::string optionName) const
 {
-    ARGUNAUGHT_TRACE("Looking for short option, have %d options\n", mOptions.size());
-    auto it = std::find_if(std::begin(mOptions), std::end(mOptions), [optionName] (const Option& opt) {
-        ARGUNAUGHT_TRACE("Checking '%s' against '%s'\n", optionName.c_str(), opt.shortName.c_str());
-        return opt.shortName == optionName;
-    });
-
-    if(it != mOptions.end()) {
-        return std::optional<Option>(*it);
+    auto index = findShortOptionIndex(optionName);
+    if(index.has_value()) {
+        return at(index.value());
     }
 
     return std::nullopt;
@@ -78,16 +160,151 @@ OptionList::findShortOption(std::string optionName) const
 std::optional<Option> 
 OptionList::findLongOption(std::string optionName) const
 {
-    auto it = std::find_if(std::begin(mOptions), std::end(mOptions), [optionName] (const Option& opt) {
-        return opt.longName == optionName;
-    });
-
-    if(it != mOptions.end()) {
+    auto index = findLongOptionIndex(optionName);
+    if(index.has_value()) {
         ARGUNAUGHT_TRACE("Found long option in parser.");
-        return std::optional<Option>(*it);
+        return at(index.value());
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::size_t> 
+OptionList::findShortOptionIndex(std::string_view optionName) const
+{
+    auto index = mShortIndex.find(optionName, mOptions, &Option::shortName);
+    if(index.has_value()) {
+        return index.value();
+    }
+
+    for(std::size_t ii = 0; ii < mPacks.size(); ++ii) {
+        const auto& pack = *mPacks[ii];
+        auto found = pack.mShortIndex.find(optionName, pack.mOptions, &Option::shortName);
+        if(found.has_value()) {
+            return mOptions.size() + mPackOffsets[ii] + found.value();
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::size_t> 
+OptionList::findLongOptionIndex(std::string_view optionName) const
+{
+    auto index = mLongIndex.find(optionName, mOptions, &Option::longName);
+    if(index.has_value()) {
+        return index.value();
+    }
+
+    for(std::size_t ii = 0; ii < mPacks.size(); ++ii) {
+        const auto& pack = *mPacks[ii];
+        auto found = pack.mLongIndex.find(optionName, pack.mOptions, &Option::longName);
+        if(found.has_value()) {
+            return mOptions.size() + mPackOffsets[ii] + found.value();
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<std::uint32_t> 
+OptionList::NameIndex::find(std::string_view name, const std::vector<Option>& options, NameField field) const
+{
+    if(mSlots.empty()) {
+        return std::nullopt;
+    }
+
+    const auto mask = mSlots.size() - 1;
+    for(auto slot = std::hash<std::string_view>()(name) & mask; mSlots[slot] != Empty; slot = (slot + 1) & mask) {
+        if(options[mSlots[slot]].*field == name) {
+            return mSlots[slot];
+        }
     }
 
     return std::nullopt;
 }
 
+void 
+OptionList::NameIndex::insert(std::uint32_t index, const std::vector<Option>& options, NameField field)
+{
+    // Keep at most half the slots in use so probe runs stay short.
+    if((mCount + 1) * 2 > mSlots.size()) {
+        auto previous = std::move(mSlots);
+        mSlots.assign(previous.empty() ? 8 : previous.size() * 2, Empty);
+        for(auto existing : previous) {
+            if(existing != Empty) {
+                place(existing, options[existing].*field);
+            }
+        }
+    }
+
+    place(index, options[index].*field);
+    mCount++;
+}
+
+void 
+OptionList::NameIndex::place(std::uint32_t index, std::string_view name)
+{
+    const auto mask = mSlots.size() - 1;
+    auto slot = std::hash<std::string_view>()(name) & mask;
+    while(mSlots[slot] != Empty) {
+        slot = (slot + 1) & mask;
+    }
+
+    mSlots[slot] = index;
+}
+
+OptionScope::OptionScope(OptionListPtr options, std::shared_ptr<const OptionScope> parent)
+    : mOptions(std::move(options)), mParent(std::move(parent))
+{
+}
+
+OptionScopePtr 
+OptionScope::push(OptionScopePtr parent, OptionListPtr options)
+{
+    if(options == nullptr || options->empty()) {
+        return parent;
+    }
+
+    return std::make_shared<OptionScope>(std::move(options), std::move(parent));
+}
+
+const Option* 
+OptionScope::findLongOption(std::string_view optionName) const
+{
+    for(auto scope = this; scope != nullptr; scope = scope->mParent.get()) {
+        auto index = scope->mOptions->findLongOptionIndex(optionName);
+        if(index.has_value()) {
+            return &scope->mOptions->at(index.value());
+        }
+    }
+
+    return nullptr;
+}
+
+const Option* 
+OptionScope::findShortOption(std::string_view optionName) const
+{
+    for(auto scope = this; scope != nullptr; scope = scope->mParent.get()) {
+        auto index = scope->mOptions->findShortOptionIndex(optionName);
+        if(index.has_value()) {
+            return &scope->mOptions->at(index.value());
+        }
+    }
+
+    return nullptr;
+}
+
+std::vector<const OptionList*> 
+OptionScope::layers() const
+{
+    std::vector<const OptionList*> result;
+    for(auto scope = this; scope != nullptr; scope = scope->mParent.get()) {
+        result.push_back(scope->mOptions.get());
+    }
+
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
 }
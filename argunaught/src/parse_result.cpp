@@ -3,9 +3,57 @@
 namespace argunaught
 {
 
+std::string
+describeParseError(const ParseError& error)
+{
+    switch(error.type)
+    {
+        case ParseErrorType::UnknownOption:
+            return "unknown option: " + error.value;
+
+        case ParseErrorType::UnterminatedQuote:
+            return "unterminated quote";
+
+        case ParseErrorType::TrailingEscape:
+            return "trailing backslash";
+
+        case ParseErrorType::MissingRequiredOption:
+            return "missing required option: " + error.value;
+
+        case ParseErrorType::ConflictingOptions:
+            return "conflicting options: " + error.value;
+
+        case ParseErrorType::MissingDependentOption:
+            return "missing dependent option: " + error.value;
+
+        case ParseErrorType::TooFewOptionParams:
+            return "too few values for: " + error.value;
+
+        case ParseErrorType::InvalidOptionValue:
+            return "invalid value: " + error.value;
+
+        case ParseErrorType::RepeatedOption:
+            return "repeated option: " + error.value;
+
+        default:
+            return "error: " + error.value;
+    }
+}
+
 int 
 ParseResult::runCommand() const
 {
+    if(command && command->streamingHandler) {
+        if(hasStreamArgs) {
+            PositionalStream stream(streamArgs);
+            return command->streamingHandler(*this, stream);
+        }
+
+        auto args = positionalArgStrings();
+        PositionalStream stream(args);
+        return command->streamingHandler(*this, stream);
+    }
+
     if(command) {
         return command->handler(*this);
     }
@@ -13,24 +61,69 @@ ParseResult::runCommand() const
     return -1;
 }
 
+void 
+ParseResult::addPositionalArg(std::string_view arg)
+{
+    if(useColumns) {
+        columns.addPositionalArg(arg);
+    }
+    else {
+        positionalArgs.emplace_back(arg);
+    }
+}
+
+OptionResultList 
+ParseResult::optionResults() const
+{
+    OptionResultList results = options;
+    for(const auto& record : columns.optionRecords()) {
+        auto values = columns.values(record);
+        results.push_back({
+            columns.optionName(record), 
+            std::vector<std::string>(values.begin(), values.end())
+        });
+    }
+
+    return results;
+}
+
+std::vector<std::string> 
+ParseResult::positionalArgStrings() const
+{
+    auto args = positionalArgs;
+    for(auto arg : columns.positionalArgs()) {
+        args.emplace_back(arg);
+    }
+
+    return args;
+}
+
 std::optional<OptionResult> 
 ParseResult::getOption(std::string optionLongName) const
 {
     // Check that the option was configured on the parser in the first place.
-    auto opt = optionsList.findLongOption(optionLongName);
-    if(!opt.has_value()) {
+    if(optionScope == nullptr || optionScope->findLongOption(optionLongName) == nullptr) {
         throw std::runtime_error("Trying to get option that was not configured: '" + optionLongName + "'!");
     }
 
+    // Options with a repeat policy have a single result that can be found directly.
+    if(auto merged = mergedOptions.find(optionLongName); merged != mergedOptions.end()) {
+        return options[merged->second];
+    }
+
     // See if we parsed out this option.
     std::optional<OptionResult> result = std::nullopt;
-    auto found = std::find_if(options.begin(), options.end(), [&](auto val) {
+    auto found = std::find_if(options.begin(), options.end(), [&](const auto& val) {
         return val.optionName == optionLongName;
     });
 
     if(found != options.end()) {
         result = *found;
     }
+    else if(auto record = columns.findOption(optionLongName); record != nullptr) {
+        auto values = columns.values(*record);
+        result = OptionResult{optionLongName, std::vector<std::string>(values.begin(), values.end())};
+    }
 
     // Return nullopt if not parsed.
     return result;
@@ -41,19 +134,9 @@ ParseResult::getOption(
         std::string optionLongName, 
         std::string defaultVal) const
 {
-    // Check that the option was configured on the parser in the first place.
-    auto opt = optionsList.findLongOption(optionLongName);
-    if(!opt.has_value()) {
-        throw std::runtime_error("Trying to get option that was not configured: '" + optionLongName + "'!");
-    }
-
-    // See if we parsed out this option.
-    auto found = std::find_if(options.begin(), options.end(), [&](auto val) {
-        return val.optionName == optionLongName;
-    });
-
-    if(found != options.end()) {
-        return *found;
+    auto found = getOption(optionLongName);
+    if(found.has_value()) {
+        return found.value();
     }
 
     // Return an OptionResult with the default value.
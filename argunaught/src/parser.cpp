@@ -1,4 +1,7 @@
 #include <argunaught/argunaught.hpp>
+#include <argunaught/help_search.hpp>
+
+#include <atomic>
 
 namespace argunaught
 {
@@ -6,6 +9,16 @@ namespace argunaught
 namespace
 {
 
+std::uint64_t
+nextGeneration()
+{
+    static std::atomic<std::uint64_t> counter{0};
+    return ++counter;
+}
+
+//! Whether the current thread's parser is shared with others, see `SharedParsing`.
+thread_local bool tSharedParsing = false;
+
 std::string
 getParserConfigErrorName(ParserConfigErrorType type)
 {
@@ -29,6 +42,9 @@ getParserConfigErrorName(ParserConfigErrorType type)
         case ParserConfigErrorType::CommandGroupNameMissing:
             return "CommandGroupNameMissing";
 
+        case ParserConfigErrorType::UnknownConstraintOption:
+            return "UnknownConstraintOption";
+
         default:
             return "UnknownError";
     }
@@ -38,29 +54,109 @@ getParserConfigErrorName(ParserConfigErrorType type)
 
 
 Parser::Parser(std::string name, std::string banner)
-    : mName(name), mBanner(banner)
+    : mName(name), mBanner(banner), mGeneration(nextGeneration())
 {
+    updateScope();
+}
+
+void 
+Parser::changed()
+{
+    mGeneration = nextGeneration();
 }
 
 
 Parser& 
-Parser::description(std::string d) 
+Parser::description(HelpText d) 
 { 
     mDescription = d;
+    changed();
     return *this;
 }
 
 Parser& 
-Parser::usage(std::string u) 
+Parser::usage(HelpText u) 
 { 
     mUsage = u;
+    changed();
     return *this;
 }
 
+Parser& 
+Parser::lazyCommand(
+        std::string name, 
+        std::string shortHelp, 
+        CommandFactory factory
+    )
+{
+    auto com = std::make_shared<LazyCommand>(name, shortHelp, factory);
+    if(addLazyCommand(com)) {
+        mLazyCommands.push_back(com);
+    }
+
+    return *this;
+}
+
+bool 
+Parser::addLazyCommand(LazyCommandPtr command)
+{
+    const auto& name = command->name;
+    const auto& help = command->shortHelp;
+
+    // Check for a missing command name.
+    if(name == "") {
+        auto err = ParserConfigErrorType::CommandNameMissing;
+        mConfigErrors.push_back({
+            err,
+            "Error adding command [" + getParserConfigErrorName(err) + "]:"
+            " description='" + help + "'"
+        });
+
+        return false;
+    }
+    
+    // Check for a duplicate command name
+    if(checkCommandNameExists(name)) {
+        auto err = ParserConfigErrorType::DuplicateCommandName;
+        mConfigErrors.push_back({
+            err,
+            "Error adding command [" + getParserConfigErrorName(err) + "]:"
+            " name='" + name + "',"
+            " description='" + help + "'"
+        });
+
+        return false;
+    }
+
+    // The key views the command's own name, which lives as long as the command.
+    mLazyIndex.emplace(command->name, command);
+    changed();
+    return true;
+}
+
+CommandPtr 
+Parser::materialize(LazyCommand& lazy) const
+{
+    std::call_once(lazy.once, [this, &lazy] {
+        auto com = lazy.factory();
+        if(com == nullptr) {
+            throw std::runtime_error("Lazy command factory returned no command: '" + lazy.name + "'!");
+        }
+
+        // The registered name is what dispatches to the command.
+        com->name = lazy.name;
+        com->constraintRules = ConstraintRules::compile(*mOptions, &com->options, {}, lazy.configErrors);
+        lazy.command = com;
+        lazy.built.store(true, std::memory_order_release);
+    });
+
+    return lazy.command;
+}
+
 Parser& 
 Parser::subParser(
         std::string name, 
-        std::string help, 
+        HelpText help, 
         SubParserHandler func)
 {
     return subParser(name, help, {}, func);
@@ -69,18 +165,47 @@ Parser::subParser(
 Parser& 
 Parser::subParser(
         std::string name, 
-        std::string help, 
+        HelpText help, 
         std::vector<Option> options, 
         SubParserHandler func
     )
 {
+    return addSubParser(std::make_shared<SubParser>(name, help, options, func));
+}
+
+Parser& 
+Parser::cursorSubParser(
+        std::string name, 
+        HelpText help, 
+        SubParserCursorHandler func)
+{
+    return cursorSubParser(name, help, {}, func);
+}
+
+Parser& 
+Parser::cursorSubParser(
+        std::string name, 
+        HelpText help, 
+        std::vector<Option> options, 
+        SubParserCursorHandler func
+    )
+{
+    return addSubParser(std::make_shared<SubParser>(name, help, options, func));
+}
+
+Parser& 
+Parser::addSubParser(SubParserPtr subParser)
+{
+    const auto& name = subParser->name;
+    const auto& help = subParser->description;
+
     // Check for a missing command name.
     if(name == "") {
         auto err = ParserConfigErrorType::CommandNameMissing;
         mConfigErrors.push_back({
             err,
             "Error adding subparser [" + getParserConfigErrorName(err) + "]:"
-            " description='" + help + "'"
+            " description='" + help.str() + "'"
         });
 
         return *this;
@@ -94,20 +219,21 @@ Parser::subParser(
             err,
             "Error adding subparser [" + getParserConfigErrorName(err) + "]:"
             " name='" + name + "',"
-            " description='" + help + "'"
+            " description='" + help.str() + "'"
         });
 
         return *this;
     }
 
-    mSubParsers.push_back(std::shared_ptr<SubParser>(new SubParser(name, help, options, func)));
+    mSubParsers.push_back(subParser);
+    changed();
     return *this; 
 }
 
 Parser& 
 Parser::command(
         std::string name, 
-        std::string help, 
+        HelpText help, 
         CommandHandler func)//,
         // bool handlesSubParsers)
 {
@@ -117,18 +243,63 @@ Parser::command(
 Parser& 
 Parser::command(
         std::string name, 
-        std::string help, 
+        HelpText help, 
+        std::vector<Option> options, 
+        CommandHandler func
+    )
+{
+    return addCommand(std::make_shared<Command>(name, help, options, func));
+}
+
+Parser& 
+Parser::command(
+        std::string name, 
+        HelpText help, 
         std::vector<Option> options, 
+        std::vector<OptionListPtr> packs, 
         CommandHandler func
     )
 {
+    auto com = std::make_shared<Command>(name, help, options, func);
+    includeOptionPacks(*com, packs);
+    return addCommand(com);
+}
+
+Parser& 
+Parser::streamingCommand(
+        std::string name, 
+        HelpText help, 
+        StreamingCommandHandler func)
+{
+    return streamingCommand(name, help, {}, func);
+}
+
+Parser& 
+Parser::streamingCommand(
+        std::string name, 
+        HelpText help, 
+        std::vector<Option> options, 
+        StreamingCommandHandler func
+    )
+{
+    auto com = std::make_shared<Command>(name, help, options, nullptr);
+    com->streamingHandler = func;
+    return addCommand(com);
+}
+
+Parser& 
+Parser::addCommand(CommandPtr com)
+{
+    const auto& name = com->name;
+    const auto& help = com->description;
+
     // Check for a missing command name.
     if(name == "") {
         auto err = ParserConfigErrorType::CommandNameMissing;
         mConfigErrors.push_back({
             err,
             "Error adding command [" + getParserConfigErrorName(err) + "]:"
-            " description='" + help + "'"
+            " description='" + help.str() + "'"
         });
 
         return *this;
@@ -142,13 +313,15 @@ Parser::command(
             err,
             "Error adding command [" + getParserConfigErrorName(err) + "]:"
             " name='" + name + "',"
-            " description='" + help + "'"
+            " description='" + help.str() + "'"
         });
 
         return *this;
     }
 
-    mCommands.push_back(std::make_shared<Command>(name, help, options, func));
+    compileCommandConstraints(*com);
+    mCommands.push_back(com);
+    changed();
     return *this;
 }
 
@@ -157,8 +330,10 @@ Parser::options(
         std::vector<Option> options
     )
 {
+    // Copies of this parser may share the current list, so add to a new one.
+    auto updated = std::make_shared<OptionList>(*mOptions);
     for(auto opt : options) {
-        auto res = mOptions.addOption(opt);
+        auto res = updated->addOption(opt);
         if(res != ParserConfigErrorType::NoError) {
             mConfigErrors.push_back({
                 res,
@@ -166,10 +341,17 @@ Parser::options(
                 " '--" + opt.longName + "',"
                 " '-" + opt.shortName + "'," 
                 " numParams=" + std::to_string(opt.maxNumParams) + ","
-                " description='" + opt.description + "'"
+                " description='" + opt.description.str() + "'"
             });
         }
     }
+
+    mOptions = updated;
+    updateScope();
+
+    // Command option ids follow the global ones, so everything is recompiled.
+    compileConstraints();
+    changed();
     return *this;
 }
 
@@ -178,20 +360,195 @@ Parser::options(
         const OptionList& opts
     )
 {
-    return options(opts.values());
+    options(opts.values());
+    for(const auto& pack : opts.packs()) {
+        includeOptions(pack);
+    }
+
+    return *this;
+}
+
+Parser& 
+Parser::includeOptions(OptionListPtr pack)
+{
+    auto updated = std::make_shared<OptionList>(*mOptions);
+    auto res = updated->include(pack);
+    if(res != ParserConfigErrorType::NoError) {
+        mConfigErrors.push_back({
+            res,
+            "Error including option pack [" + getParserConfigErrorName(res) + "]:"
+            " numOptions=" + std::to_string(pack->size())
+        });
+
+        return *this;
+    }
+
+    mOptions = updated;
+    updateScope();
+    compileConstraints();
+    changed();
+    return *this;
+}
+
+Parser& 
+Parser::passThrough(bool enable)
+{
+    mPassThrough = enable;
+    changed();
+    return *this;
+}
+
+Parser& 
+Parser::definitionFlag(bool enable)
+{
+    mDefinitionFlag = enable;
+    changed();
+    return *this;
+}
+
+Parser& 
+Parser::inheritOptions(const Parser& parent)
+{
+    mInheritedScope = parent.mScope;
+    updateScope();
+    changed();
+    return *this;
+}
+
+void 
+Parser::updateScope()
+{
+    mScope = OptionScope::push(mInheritedScope, mOptions);
+}
+
+std::vector<Option> 
+Parser::helpOptions() const
+{
+    std::vector<Option> options(mOptions->begin(), mOptions->end());
+    if(mInheritedScope != nullptr) {
+        for(const auto* layer : mInheritedScope->layers()) {
+            for(const auto& opt : *layer) {
+                if(!mOptions->findLongOptionIndex(opt.longName).has_value()) {
+                    options.push_back(opt);
+                }
+            }
+        }
+    }
+
+    return options;
+}
+
+Parser& 
+Parser::columnarResults(bool enable)
+{
+    mColumnarResults = enable;
+    changed();
+    return *this;
+}
+
+Parser& 
+Parser::constraints(std::vector<Constraint> constraints)
+{
+    mConstraints.insert(mConstraints.end(), constraints.begin(), constraints.end());
+    compileConstraints();
+    changed();
+    return *this;
+}
+
+bool 
+Parser::hasConfigurationError() const
+{
+    return !parserConfigErrors().empty();
+}
+
+std::vector<ParserConfigError> 
+Parser::parserConfigErrors() const
+{
+    auto errors = mConfigErrors;
+    for(const auto& el : mConstraintErrors) {
+        errors.insert(errors.end(), el.second.begin(), el.second.end());
+    }
+
+    // Lazy commands' constraints are only known once they're built.
+    for(const auto& el : mLazyIndex) {
+        if(el.second->materialized()) {
+            errors.insert(errors.end(), el.second->configErrors.begin(), el.second->configErrors.end());
+        }
+    }
+
+    return errors;
+}
+
+void 
+Parser::compileConstraints()
+{
+    std::vector<ParserConfigError> errors;
+    mConstraintRules = ConstraintRules::compile(*mOptions, nullptr, mConstraints, errors);
+    mConstraintErrors.erase("");
+    if(!errors.empty()) {
+        mConstraintErrors[""] = errors;
+    }
+
+    for(auto& com : mCommands) {
+        compileCommandConstraints(*com);
+    }
+
+    for(auto& group : mGroups) {
+        for(auto& com : group.commands) {
+            compileCommandConstraints(*com);
+        }
+    }
+}
+
+void 
+Parser::compileCommandConstraints(Command& command)
+{
+    std::vector<ParserConfigError> errors;
+    command.constraintRules = ConstraintRules::compile(*mOptions, &command.options, {}, errors);
+    mConstraintErrors.erase(command.name);
+    if(!errors.empty()) {
+        mConstraintErrors[command.name] = errors;
+    }
+}
+
+void 
+Parser::includeOptionPacks(Command& command, const std::vector<OptionListPtr>& packs)
+{
+    for(const auto& pack : packs) {
+        auto res = command.options.include(pack);
+        if(res != ParserConfigErrorType::NoError) {
+            mConfigErrors.push_back({
+                res,
+                "Error including option pack [" + getParserConfigErrorName(res) + "]:"
+                " command='" + command.name + "',"
+                " numOptions=" + std::to_string(pack->size())
+            });
+        }
+    }
+}
+
+void 
+Parser::checkConstraints(ParseResult& result) const
+{
+    mConstraintRules.evaluate(result.presentOptions, result.errors);
+    if(result.command != nullptr) {
+        result.command->constraintRules.evaluate(result.presentOptions, result.errors);
+    }
 }
 
 CommandGroup& 
 Parser::group(std::string name)
 {
     mGroups.push_back(CommandGroup(this, name));
+    changed();
     return *(mGroups.end()-1);
 }
 
 CommandGroup& 
-Parser::group(std::string name, std::string description)
+Parser::group(std::string name, HelpText description)
 {
     mGroups.push_back(CommandGroup(this, name, description));
+    changed();
     return *(mGroups.end()-1);
 }
 
@@ -217,75 +574,120 @@ Parser::checkCommandNameExists(std::string name) const
         return true;
     }
 
-    return false;
+    return mLazyIndex.count(name) > 0;
 }
 
 
-std::optional<OptionResult>
+SharedParsing::SharedParsing()
+    : mPrevious(tSharedParsing)
+{
+    tSharedParsing = true;
+}
+
+SharedParsing::~SharedParsing()
+{
+    tSharedParsing = mPrevious;
+}
+
+bool
 Parser::parseOption(std::shared_ptr<Command> command, 
-                    std::deque<std::string>& parseText,
+                    ArgCursor& parseText,
                     ParseResult& parseResult) const
 {
     OptionResult optResult;
 
     // Expect atleast one value in parseText
-    if(parseText.size() == 0) return std::nullopt;
+    if(parseText.empty()) return false;
 
     // Get the option name out.
-    std::string optionFullName = parseText[0];
+    std::string_view optionFullName = parseText.front();
 
     // Make sure the option is not just a - or --
     if(optionFullName == "-" || 
        optionFullName == "--") 
     {
-           parseText.pop_front();
+           parseText.advance();
            parseResult.currItemPos++;
 
-           return std::nullopt;
+           return false;
     }
 
-    std::string optionName;
-    std::optional<Option> opt;
+    // Names are looked up as views into the token, without copying them.
+    std::string_view optionName;
+    bool isLongName = false;
 
     // Check for a long name
-    if(optionFullName[0] == '-' && optionFullName[1] == '-') {
+    if(optionFullName.size() > 1 && optionFullName[0] == '-' && optionFullName[1] == '-') {
         // Skip over '--'
         optionName = optionFullName.substr(2);
-        ARGUNAUGHT_TRACE("Got long option name: '%s'\n", optionName.c_str());
-        if(command != nullptr) {
-            opt = command->options.findLongOption(optionName);
-        }
-
-        if(!opt.has_value()) {
-            ARGUNAUGHT_TRACE("No command option, checking for global option.\n");
-            opt = mOptions.findLongOption(optionName);
-        }
+        isLongName = true;
+        ARGUNAUGHT_TRACE("Got long option name: '%.*s'\n", static_cast<int>(optionName.size()), optionName.data());
     }
-    else if(optionFullName[0] == '-') {
+    else if(!optionFullName.empty() && optionFullName[0] == '-') {
         // Skip over '-'
         optionName = optionFullName.substr(1);
-        ARGUNAUGHT_TRACE("Got short option name: '%s'\n", optionName.c_str());
+        ARGUNAUGHT_TRACE("Got short option name: '%.*s'\n", static_cast<int>(optionName.size()), optionName.data());
+    }
+    else {
+        return false;
+    }
 
-        if(command != nullptr) {
-            opt = command->options.findShortOption(optionName);
+    auto findIndex = [&optionName, isLongName] (const OptionList& list) {
+        return isLongName ? list.findLongOptionIndex(optionName) : list.findShortOptionIndex(optionName);
+    };
+
+    // Command options take precedence, with ids following on from the global options.
+    const Option* opt = nullptr;
+    std::size_t optId = 0;
+    if(command != nullptr) {
+        auto index = findIndex(command->options);
+        if(index.has_value()) {
+            opt = &command->options.at(index.value());
+            optId = mOptions->size() + index.value();
         }
+    }
 
-        if(!opt.has_value()) {
-            ARGUNAUGHT_TRACE("No command option, checking for global option.\n");
-            opt = mOptions.findShortOption(optionName);
+    if(opt == nullptr) {
+        ARGUNAUGHT_TRACE("No command option, checking for global option.\n");
+        auto index = findIndex(*mOptions);
+        if(index.has_value()) {
+            opt = &mOptions->at(index.value());
+            optId = index.value();
         }
     }
-    else {
-        return std::nullopt;
+
+    // Inherited options are understood but have no id, so constraints can't refer to them.
+    if(opt == nullptr && mInheritedScope != nullptr) {
+        opt = isLongName ? mInheritedScope->findLongOption(optionName) : mInheritedScope->findShortOption(optionName);
+        optId = ColumnarArgs::UnknownOptionId;
     }
 
-    parseText.pop_front();
+    parseText.advance();
     parseResult.currItemPos++;
 
-    ARGUNAUGHT_TRACE("Option found: %s\n", opt.has_value() ? "True" : "False");
-    if(opt.has_value()) {
-        Option& foundOption = opt.value();
-        optResult.optionName = foundOption.longName;
+    ARGUNAUGHT_TRACE("Option found: %s\n", opt != nullptr ? "True" : "False");
+    if(opt != nullptr) {
+        const Option& foundOption = *opt;
+        const auto optionPos = parseResult.currItemPos;
+
+        // Bound options are written straight to their destination and never recorded.
+        const bool isBound = static_cast<bool>(foundOption.binder);
+        if(isBound && tSharedParsing) {
+            throw std::runtime_error("Option '" + foundOption.longName + "' is bound to a variable and can't be parsed by a shared parser!");
+        }
+
+        if(optId != ColumnarArgs::UnknownOptionId) {
+            parseResult.presentOptions.set(optId);
+        }
+
+        const bool isMerged = !isBound && foundOption.repeat != RepeatPolicy::Separate;
+        const bool useColumns = parseResult.useColumns && !isBound && !isMerged;
+        if(useColumns) {
+            parseResult.columns.beginOption(static_cast<std::uint32_t>(optId), foundOption.longName);
+        }
+        else if(!isBound) {
+            optResult.optionName = foundOption.longName;
+        }
 
         int paramCounter = 0;
 
@@ -297,33 +699,111 @@ Parser::parseOption(std::shared_ptr<Command> command,
                paramCounter < foundOption.maxNumParams)
               )
         {
-            const auto& currOptValue = parseText.front();
-            if(currOptValue[0] == '-' && currOptValue.size() > 1) {
+            const auto currOptValue = parseText.front();
+            if(currOptValue.size() > 1 && currOptValue[0] == '-') {
                 // Only break out of the option parameter loop if
                 // we find a `-` not followed by a number.  negative
                 // numbers are fine.
-                if(!std::isdigit(currOptValue[1])) break;
+                if(!std::isdigit(static_cast<unsigned char>(currOptValue[1]))) break;
             }
 
-            ARGUNAUGHT_TRACE("Got option value: '%s'\n", parseText.front().c_str());
-            optResult.values.push_back(parseText.front());
-            parseText.pop_front();
+            ARGUNAUGHT_TRACE("Got option value: '%.*s'\n", static_cast<int>(currOptValue.size()), currOptValue.data());
+            if(isBound) {
+                if(!foundOption.binder(currOptValue)) {
+                    parseResult.errors.push_back({
+                            ParseErrorType::InvalidOptionValue, 
+                            static_cast<int>(parseResult.currItemPos),
+                            std::string(currOptValue)
+                        });
+                }
+            }
+            else if(useColumns) {
+                parseResult.columns.addOptionValue(currOptValue);
+            }
+            else {
+                optResult.values.emplace_back(currOptValue);
+            }
+            parseText.advance();
             parseResult.currItemPos++;
 
             paramCounter++; 
         }
     
         ARGUNAUGHT_TRACE("Done checking for option values. %d found\n", paramCounter);
-        return std::optional<OptionResult>(optResult);
+        if(paramCounter < foundOption.minNumParams) {
+            parseResult.errors.push_back({
+                    ParseErrorType::TooFewOptionParams, 
+                    static_cast<int>(optionPos),
+                    foundOption.longName
+                });
+        }
+
+        if(isBound) {
+            if(paramCounter == 0) {
+                foundOption.binder(std::nullopt);
+            }
+        }
+        else if(isMerged) {
+            mergeRepeatedOption(foundOption, std::move(optResult), optionPos, parseResult);
+        }
+        else if(!useColumns) {
+            parseResult.options.push_back(std::move(optResult));
+        }
+
+        return true;
     } else {
         parseResult.errors.push_back({
                 ParseErrorType::UnknownOption, 
                 static_cast<int>(parseResult.currItemPos),
-                optionName
+                std::string(optionName)
             });
     }
 
-    return std::nullopt;
+    return false;
+}
+
+void
+Parser::mergeRepeatedOption(
+        const Option& option, 
+        OptionResult optResult, 
+        std::size_t optionPos, 
+        ParseResult& parseResult) const
+{
+    if(option.repeat == RepeatPolicy::Count) {
+        optResult.values.clear();
+    }
+
+    // The first occurrence is recorded as is.
+    auto [found, inserted] = parseResult.mergedOptions.try_emplace(option.longName, parseResult.options.size());
+    if(inserted) {
+        parseResult.options.push_back(std::move(optResult));
+        return;
+    }
+
+    auto& merged = parseResult.options[found->second];
+    merged.count++;
+    switch(option.repeat) {
+        case RepeatPolicy::Append:
+            merged.values.insert(merged.values.end(), 
+                                 std::make_move_iterator(optResult.values.begin()), 
+                                 std::make_move_iterator(optResult.values.end()));
+            break;
+
+        case RepeatPolicy::LastWins:
+            merged.values = std::move(optResult.values);
+            break;
+
+        case RepeatPolicy::Error:
+            parseResult.errors.push_back({
+                    ParseErrorType::RepeatedOption, 
+                    static_cast<int>(optionPos),
+                    option.longName
+                });
+            break;
+
+        default:
+            break;
+    }
 }
 
 CommandPtr 
@@ -345,38 +825,221 @@ Parser::getCommand(std::string name) const
         }
     }
 
+    auto lazy = mLazyIndex.find(name);
+    if(lazy != mLazyIndex.end()) {
+        return materialize(*lazy->second);
+    }
+
     return nullptr;
 }
 
+namespace
+{
+
+//! Returns whether a token starts an option, rather than a negative number or positional argument.
+bool
+isOptionToken(std::string_view arg)
+{
+    if(arg.empty() || arg[0] != '-') {
+        return false;
+    }
+
+    // A negative number must be the beginning of the positional arguments.
+    return !(arg.size() > 1 && std::isdigit(static_cast<unsigned char>(arg[1])));
+}
+
+}
+
+void 
+Parser::buildLazyCommands() const
+{
+    for(const auto& el : mLazyIndex) {
+        materialize(*el.second);
+    }
+}
+
+std::shared_ptr<const HelpIndex> 
+Parser::helpIndex() const
+{
+    // Searches may run on several threads, at worst each builds an index.
+    auto index = std::atomic_load(&mHelpIndex);
+    if(index == nullptr || !index->isCurrent(*this)) {
+        index = HelpIndex::build(*this);
+        std::atomic_store(&mHelpIndex, index);
+    }
+
+    return index;
+}
+
 ParseResult
 Parser::parse(int argc, const char* argv[]) const
 {
-    // Skip the executable name
-    argv = &argv[1];
-    argc--;
+    ParseResult result;
+    if(mDefinitionFlag && argc > 1 && argv[1] == ParserDefinition::Flag) {
+        // Exported now, so the result doesn't depend on the parser outliving it.
+        auto json = std::make_shared<const std::string>(ParserDefinition::json(*this));
+        result.command = std::make_shared<Command>(
+            std::string(ParserDefinition::Flag), 
+            "Exports the parser's definition as JSON.", 
+            std::vector<Option>{}, 
+            [json] (const ParseResult&) -> int {
+                commandOutput() << *json;
+                return 0;
+            });
+        return result;
+    }
 
-    // Create a deque of strings
-    std::deque<std::string> args;
-    for(int ii = 0; ii < argc; ++ii)
-    {
-        args.emplace_back(argv[ii]);
+    // Skip the executable name, tokens are read straight out of argv.
+    ArgCursor args(argc > 0 ? &argv[1] : argv, argc > 0 ? static_cast<std::size_t>(argc - 1) : 0);
+
+    parseInto(args, result);
+    return result;
+}
+
+PeekResult
+Parser::peek(int argc, const char* argv[], const PeekOptionHandler& onOption) const
+{
+    PeekResult result;
+    int pos = 1;
+
+    // Skip global options and their values, matching the way they're parsed.
+    while(pos < argc && isOptionToken(argv[pos])) {
+        std::string_view token = argv[pos];
+        if(token == "-" || token == "--") {
+            pos++;
+            break;
+        }
+
+        const bool isLongName = token.size() > 1 && token[1] == '-';
+        auto name = token.substr(isLongName ? 2 : 1);
+        auto index = isLongName ? mOptions->findLongOptionIndex(name) : mOptions->findShortOptionIndex(name);
+
+        // Options are looked up the same way `parseOption` does, falling back 
+        // to any inherited from a parent parser.
+        const Option* opt = index.has_value() ? &mOptions->at(index.value()) : nullptr;
+        if(opt == nullptr && mInheritedScope != nullptr) {
+            opt = isLongName ? mInheritedScope->findLongOption(name) : mInheritedScope->findShortOption(name);
+        }
+
+        // An unknown option is skipped and ends the global options, just like parsing.
+        if(opt == nullptr) {
+            pos++;
+            break;
+        }
+
+        const int optionIndex = pos++;
+        int numValues = 0;
+        while(pos < argc && 
+              (opt->maxNumParams == -1 || numValues < opt->maxNumParams)) 
+        {
+            std::string_view value = argv[pos];
+            if(value.size() > 1 && value[0] == '-' && !std::isdigit(static_cast<unsigned char>(value[1]))) {
+                break;
+            }
+
+            pos++;
+            numValues++;
+        }
+
+        if(onOption) {
+            onOption(*opt, optionIndex, numValues);
+        }
     }
 
-    return parse(args);
+    result.argsIndex = pos;
+    if(pos >= argc) {
+        return result;
+    }
+
+    std::string_view token = argv[pos];
+    auto setFound = [&result, token, pos] () {
+        result.name = token;
+        result.commandIndex = pos;
+        result.argsIndex = pos + 1;
+    };
+
+    auto findIn = [token] (const auto& list) {
+        return std::find_if(list.begin(), list.end(), [token] (const auto& el) { return el->name == token; });
+    };
+
+    auto checkCommands = [&] (const CommandList& commands, const SubParserList& subParsers) {
+        auto com = findIn(commands);
+        if(com != commands.end()) {
+            result.command = *com;
+            return true;
+        }
+
+        auto sub = findIn(subParsers);
+        if(sub != subParsers.end()) {
+            result.subParser = *sub;
+            return true;
+        }
+
+        return false;
+    };
+
+    bool found = checkCommands(mCommands, mSubParsers);
+    for(auto it = mGroups.begin(); !found && it != mGroups.end(); ++it) {
+        found = checkCommands(it->commands, it->subParsers);
+    }
+
+    if(!found && !mLazyIndex.empty()) {
+        auto lazy = mLazyIndex.find(token);
+        if(lazy != mLazyIndex.end()) {
+            found = true;
+            result.lazyCommand = true;
+            if(lazy->second->materialized()) {
+                result.command = lazy->second->command;
+            }
+        }
+    }
+
+    if(found) {
+        setFound();
+    }
+
+    return result;
 }
 
+ParseResult
+Parser::parseCommandLine(std::string_view commandLine) const
+{
+    return parseCommandLine(tokenizeCommandLine(commandLine));
+}
+
+ParseResult
+Parser::parseCommandLine(const CommandLineTokens& tokens) const
+{
+    if(tokens.hasError()) {
+        ParseResult result;
+        result.errors.push_back(tokens.error().value());
+        return result;
+    }
+
+    std::vector<std::string_view> views;
+    views.reserve(tokens.size());
+    for(std::size_t ii = 0; ii < tokens.size(); ++ii) {
+        views.push_back(tokens[ii]);
+    }
+
+    ArgCursor args(views.data(), views.size());
+    ParseResult result;
+    parseInto(args, result);
+    return result;
+}
 
 ParseResult
 Parser::parse(ParseResult const& prevParseResult)
 {
     // Create a deque of strings
     std::deque<std::string> args;
-    for(auto& arg : prevParseResult.positionalArgs)
+    for(auto& arg : prevParseResult.positionalArgStrings())
     {
         args.emplace_back(arg);
     }
 
-    mOptions.addOptions(prevParseResult.optionsList.values());
+    mInheritedScope = prevParseResult.optionScope;
+    updateScope();
     return parse(args);
 }
 
@@ -384,79 +1047,118 @@ ParseResult
 Parser::parse(std::deque<std::string> args, OptionResultList existingOptions) const
 {
     ParseResult result;
-
-    for(const auto& opt : existingOptions) {
-        result.options.push_back(opt);
+    for(auto& opt : existingOptions) {
+        result.options.push_back(std::move(opt));
         result.currItemPos++;
     }
 
-    result.optionsList.addOptions(mOptions);
+    std::vector<std::string_view> views(args.begin(), args.end());
+    ArgCursor cursor(views.data(), views.size());
+    parseInto(cursor, result);
+    return result;
+}
+
+void
+Parser::adoptResult(ParseResult& result) const
+{
+    result.useColumns = result.useColumns || mColumnarResults;
+
+    // Options found so far, possibly by a parent parser, count towards our 
+    // constraints under this parser's option ids.
+    result.presentOptions = OptionMask();
+    auto lookup = [this] (const std::string& name) { return mOptions->findLongOptionIndex(name); };
+    for(auto& opt : result.options) {
+        auto index = lookup(opt.optionName);
+        if(index.has_value()) {
+            result.presentOptions.set(index.value());
+        }
+    }
+
+    result.columns.remapOptionIds(lookup);
+    for(const auto& record : result.columns.optionRecords()) {
+        if(record.optionId != ColumnarArgs::UnknownOptionId) {
+            result.presentOptions.set(record.optionId);
+        }
+    }
+
+    // Keep the parent's options around so they can still be looked up.
+    if(result.optionScope == nullptr) {
+        result.optionScope = mScope;
+    }
+    else if(result.optionScope != mScope) {
+        result.optionScope = OptionScope::push(result.optionScope, mOptions);
+    }
+}
+
+void
+Parser::parseInto(ArgCursor& args, ParseResult& result) const
+{
+    adoptResult(result);
 
-    if(args.size() == 0) return result;
+    // With pass through, a `--` ends parsing and the rest stays in argv untouched.
+    auto passThroughAt = [this, &args] () {
+        return mPassThrough && args.argvTail() != nullptr && !args.empty() && args.front() == "--";
+    };
+
+    auto takePassThrough = [&args, &result] () {
+        args.advance();
+        result.currItemPos++;
+        result.passThroughTail = args.argvTail();
+        result.passThroughCount = args.remaining();
+        result.currItemPos += args.remaining();
+        args.advance(args.remaining());
+    };
 
     // parse any options before the command as global options
-    while(!args.empty() && args.front()[0] == '-') {
-        const auto& currArg = args.front();
-        if(currArg.size() > 1 && std::isdigit(currArg[1])) {
-            // If we found a negative number, then we must have found 
-            // the beginning of the positional arguments, so break.
+    while(!args.empty() && isOptionToken(args.front())) {
+        if(passThroughAt()) {
+            takePassThrough();
             break;
         }
 
-        auto optResult = parseOption(nullptr, args, result);
-        if(optResult.has_value()) {
-            result.options.push_back(optResult.value());
-        }
-        else {
+        if(!parseOption(nullptr, args, result)) {
             break;
         }
     }
 
     // Check for just options, no command.
-    if(args.size() == 0) return result;
-
-    // Create a combined list of un-grouped commands and grouped commands
-    CommandList allCommands;
-    std::copy(mCommands.begin(), mCommands.end(), std::back_inserter(allCommands));
-    for(const auto& group : mGroups) {
-        std::copy(
-            group.commands.begin(), 
-            group.commands.end(), 
-            std::back_inserter(allCommands)
-        );
+    if(args.empty()) {
+        checkConstraints(result);
+        return;
     }
 
-    for(const auto& com : allCommands) {
-        if(com->name == args[0]) {
-            ARGUNAUGHT_TRACE("Found command '%s'\n", com->name.c_str());
-            result.command = com;
+    // Lazily registered commands are built here, on dispatch.
+    auto com = getCommand(std::string(args.front()));
+    if(com != nullptr) {
+        ARGUNAUGHT_TRACE("Found command '%s'\n", com->name.c_str());
+        result.command = com;
 
-            args.pop_front();
-            result.currItemPos++;
-
-            result.optionsList.addOptions(com->options);
+        args.advance();
+        result.currItemPos++;
 
-            while(!args.empty() && args.front()[0] == '-') {
-                const auto& currArg = args.front();
-                if(currArg.size() > 1 && std::isdigit(currArg[1])) {
-                    // If we found a negative number, then we must have found 
-                    // the beginning of the positional arguments, so break.
-                    break;
-                }
+        result.optionScope = OptionScope::push(result.optionScope, OptionListPtr(com, &com->options));
 
-                auto optResult = parseOption(com, args, result);
-                if(optResult.has_value()) {
-                    result.options.push_back(optResult.value());
-                }
-                else {
-                    break;
-                }
+        while(!args.empty() && isOptionToken(args.front())) {
+            if(passThroughAt()) {
+                takePassThrough();
+                break;
+            }
 
-                ARGUNAUGHT_TRACE("Done parsing option '%s', ended with %lu params\n",
-                optResult.value().optionName.c_str(), optResult.value().values.size());
+            if(!parseOption(com, args, result)) {
+                break;
             }
 
-            break;
+            ARGUNAUGHT_TRACE("Done parsing command option, %lu args left\n", args.remaining());
+        }
+
+        // Streaming commands pull the rest straight from argv when they run.
+        if(com->streamingHandler && args.argvTail() != nullptr && !result.hasPassThrough()) {
+            result.streamArgs = args;
+            result.hasStreamArgs = true;
+            result.currItemPos += args.remaining();
+            args.advance(args.remaining());
+            checkConstraints(result);
+            return;
         }
     }
     
@@ -472,28 +1174,60 @@ Parser::parse(std::deque<std::string> args, OptionResultList existingOptions) co
     }
 
     for(const auto& subCom : allSubParsers) {
-        if(subCom->name == args[0]) {
+        if(!args.empty() && subCom->name == args.front()) {
             ARGUNAUGHT_TRACE("Found sub command '%s'\n", subCom->name.c_str());
             
-            args.pop_front();
+            args.advance();
             result.currItemPos++;
-            result = subCom->handler(*this, result.options, args);
-            
-            return result;
+
+            // The global options end here, so their rules are checked before
+            // the subparser takes the result over with its own option ids.
+            std::vector<ParseError> globalErrors;
+            mConstraintRules.evaluate(result.presentOptions, globalErrors);
+
+            if(subCom->cursorHandler) {
+                subCom->cursorHandler(*this, args, result);
+            }
+            else {
+                result = subCom->handler(*this, result.optionResults(), args.toDeque());
+            }
+
+            result.errors.insert(result.errors.begin(), globalErrors.begin(), globalErrors.end());
+            return;
         }
     }
 
     // Fall through in case of no command, sub command, or remaining args for command.
-    ARGUNAUGHT_TRACE("Checking positional args, %lu left", args.size());
+    ARGUNAUGHT_TRACE("Checking positional args, %lu left", args.remaining());
 
     // Anything left over is a positional argument.
+    if(result.useColumns) {
+        std::size_t numValues = 0;
+        std::size_t numChars = 0;
+        for(auto ii = args.position(); ii < args.position() + args.remaining(); ++ii) {
+            auto arg = args.at(ii);
+            if(mPassThrough && args.argvTail() != nullptr && arg == "--") {
+                break;
+            }
+
+            numChars += arg.size();
+            numValues++;
+        }
+        result.columns.reserve(numValues, numChars);
+    }
+
     while(!args.empty()) {
-        ARGUNAUGHT_TRACE("Got positional arg: '%s'\n", args.front().c_str());
-        result.positionalArgs.push_back(args.front());
-        args.pop_front();
+        if(passThroughAt()) {
+            takePassThrough();
+            break;
+        }
+
+        result.addPositionalArg(args.front());
+        args.advance();
         result.currItemPos++;
     }
-    return result;
+
+    checkConstraints(result);
 }
 
 }
@@ -0,0 +1,439 @@
+#include <argunaught/plugins.hpp>
+
+#include <dlfcn.h>
+
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace argunaught
+{
+
+namespace detail
+{
+
+//! A plugin library and the parser its commands were registered into.
+struct LoadedPlugin
+{
+    void* handle = nullptr;
+    Parser parser{"plugin"};
+};
+
+//! Plugin libraries loaded so far, shared by the commands registered from them.
+class PluginLibraries
+{
+private:
+    mutable std::mutex mMutex;
+    std::map<std::string, std::unique_ptr<LoadedPlugin>> mPlugins;
+
+public:
+    //! Loads a plugin and runs its registration, or returns it if already loaded.
+    LoadedPlugin& load(const std::string& library)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto& plugin = mPlugins[library];
+        if(plugin != nullptr) {
+            return *plugin;
+        }
+
+        void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if(handle == nullptr) {
+            mPlugins.erase(library);
+            throw std::runtime_error("Could not load plugin '" + library + "': " + dlerror());
+        }
+
+        using VersionFunc = int (*)();
+        using RegisterFunc = void (*)(Parser&);
+        auto version = reinterpret_cast<VersionFunc>(dlsym(handle, "argunaught_plugin_abi_version"));
+        auto registerPlugin = reinterpret_cast<RegisterFunc>(dlsym(handle, "argunaught_register_plugin"));
+        if(version == nullptr || registerPlugin == nullptr) {
+            dlclose(handle);
+            mPlugins.erase(library);
+            throw std::runtime_error("Plugin has no argunaught entry point: '" + library + "'");
+        }
+
+        if(version() != ARGUNAUGHT_PLUGIN_ABI_VERSION) {
+            dlclose(handle);
+            mPlugins.erase(library);
+            throw std::runtime_error("Plugin was built for a different argunaught version: '" + library + "'");
+        }
+
+        // Handlers live in the library, so it's never unloaded once registered.
+        plugin = std::make_unique<LoadedPlugin>();
+        plugin->handle = handle;
+        registerPlugin(plugin->parser);
+        return *plugin;
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mPlugins.size();
+    }
+};
+
+}
+
+namespace
+{
+
+const char* IndexHeader = "argunaught-plugin-index 1";
+
+//! Index fields are tab separated, so tabs, newlines and backslashes are escaped.
+std::string
+escapeField(const std::string& value)
+{
+    std::string result;
+    for(auto c : value) {
+        switch(c) {
+            case '\\': result += "\\\\"; break;
+            case '\t': result += "\\t"; break;
+            case '\n': result += "\\n"; break;
+            default: result += c;
+        }
+    }
+
+    return result;
+}
+
+std::string
+unescapeField(const std::string& value)
+{
+    std::string result;
+    for(std::size_t ii = 0; ii < value.size(); ++ii) {
+        if(value[ii] == '\\' && ii + 1 < value.size()) {
+            ++ii;
+            result += value[ii] == 't' ? '\t' : (value[ii] == 'n' ? '\n' : value[ii]);
+        }
+        else {
+            result += value[ii];
+        }
+    }
+
+    return result;
+}
+
+std::vector<std::string>
+splitFields(const std::string& line)
+{
+    std::vector<std::string> fields;
+    std::size_t start = 0;
+    while(true) {
+        auto end = line.find('\t', start);
+        fields.push_back(unescapeField(line.substr(start, end - start)));
+        if(end == std::string::npos) {
+            return fields;
+        }
+        start = end + 1;
+    }
+}
+
+//! Identifies a version of a library file, a change in either means rescanning it.
+struct LibraryStamp
+{
+    long long mtime = 0;
+    unsigned long long size = 0;
+
+    bool operator==(const LibraryStamp& other) const { return mtime == other.mtime && size == other.size; }
+};
+
+//! Returns the library's stamp, or nothing if it can't be read, e.g. it was 
+//! removed while scanning.
+std::optional<LibraryStamp>
+stampOf(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if(ec) return std::nullopt;
+
+    auto size = std::filesystem::file_size(path, ec);
+    if(ec) return std::nullopt;
+
+    return LibraryStamp{
+        static_cast<long long>(mtime.time_since_epoch().count()),
+        static_cast<unsigned long long>(size)
+    };
+}
+
+//! Parses a whole index field as a number, returning false if it isn't one.
+template<typename T>
+bool
+parseNumber(const std::string& field, T& value)
+{
+    auto end = field.data() + field.size();
+    auto result = std::from_chars(field.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+struct IndexedLibrary
+{
+    LibraryStamp stamp;
+    std::vector<PluginCommandInfo> commands;
+
+    //! Why the library failed to load, so it isn't retried until it changes.
+    std::string error;
+};
+
+std::map<std::string, IndexedLibrary>
+readIndex(const std::string& indexPath)
+{
+    std::map<std::string, IndexedLibrary> libraries;
+    std::ifstream in(indexPath);
+    std::string line;
+    if(!std::getline(in, line) || line != IndexHeader) {
+        return libraries;
+    }
+
+    std::string library;
+    while(std::getline(in, line)) {
+        auto fields = splitFields(line);
+        if(fields[0] == "lib" && fields.size() == 4) {
+            library = fields[1];
+            auto& stamp = libraries[library].stamp;
+            if(!parseNumber(fields[2], stamp.mtime) || !parseNumber(fields[3], stamp.size)) {
+                return {};
+            }
+        }
+        else if((fields[0] == "cmd" || fields[0] == "sub") && fields.size() == 4 && !library.empty()) {
+            libraries[library].commands.push_back({fields[1], fields[2], library, fields[3], fields[0] == "sub"});
+        }
+        else if(fields[0] == "err" && fields.size() == 2 && !library.empty()) {
+            libraries[library].error = fields[1];
+        }
+        else {
+            // Anything unexpected means the index is rebuilt from scratch.
+            return {};
+        }
+    }
+
+    return libraries;
+}
+
+void
+writeIndex(const std::string& indexPath, const std::map<std::string, IndexedLibrary>& libraries)
+{
+    // Write to a temporary file and rename so concurrent readers never see a partial index.
+    auto tmpPath = indexPath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if(!out) {
+            return;
+        }
+
+        out << IndexHeader << "\n";
+        for(const auto& el : libraries) {
+            out << "lib\t" << escapeField(el.first) << "\t" << el.second.stamp.mtime << "\t" << el.second.stamp.size << "\n";
+            if(!el.second.error.empty()) {
+                out << "err\t" << escapeField(el.second.error) << "\n";
+            }
+            for(const auto& com : el.second.commands) {
+                out << (com.isSubParser ? "sub" : "cmd") << "\t"
+                    << escapeField(com.name) << "\t"
+                    << escapeField(com.shortHelp) << "\t"
+                    << escapeField(com.optionsSummary) << "\n";
+            }
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, indexPath, ec);
+}
+
+std::string
+firstLine(const std::string& text)
+{
+    return text.substr(0, text.find('\n'));
+}
+
+std::string
+summarizeOptions(const OptionList& options)
+{
+    std::string summary;
+    for(const auto& opt : options) {
+        if(!summary.empty()) summary += " ";
+        summary += "--" + opt.longName;
+        if(!opt.shortName.empty()) summary += ",-" + opt.shortName;
+    }
+
+    return summary;
+}
+
+}
+
+PluginLoader::PluginLoader(std::string pluginDir, std::string indexPath)
+    : mPluginDir(pluginDir),
+      mIndexPath(indexPath),
+      mLibraries(std::make_shared<detail::PluginLibraries>())
+{
+    if(mIndexPath.empty()) {
+        mIndexPath = (std::filesystem::path(mPluginDir) / "argunaught-plugins.index").string();
+    }
+}
+
+std::vector<PluginCommandInfo>
+PluginLoader::describePlugin(const Parser& parser, const std::string& library)
+{
+    std::vector<PluginCommandInfo> commands;
+    auto addCommands = [&] (const CommandList& list) {
+        for(const auto& com : list) {
+            commands.push_back({com->name, firstLine(com->description), library, summarizeOptions(com->options), false});
+        }
+    };
+
+    auto addLazyCommands = [&] (const std::vector<LazyCommandPtr>& list) {
+        for(const auto& com : list) {
+            commands.push_back({com->name, com->shortHelp, library, "", false});
+        }
+    };
+
+    auto addSubParsers = [&] (const SubParserList& list) {
+        for(const auto& sub : list) {
+            commands.push_back({sub->name, firstLine(sub->description), library, summarizeOptions(sub->options), true});
+        }
+    };
+
+    addCommands(parser.mCommands);
+    addLazyCommands(parser.mLazyCommands);
+    addSubParsers(parser.mSubParsers);
+    for(const auto& group : parser.mGroups) {
+        addCommands(group.commands);
+        addLazyCommands(group.lazyCommands);
+        addSubParsers(group.subParsers);
+    }
+
+    return commands;
+}
+
+const std::vector<PluginCommandInfo>&
+PluginLoader::scan()
+{
+    mCommands.clear();
+    mErrors.clear();
+
+    auto indexed = readIndex(mIndexPath);
+    std::map<std::string, IndexedLibrary> current;
+    bool changed = false;
+
+    std::vector<std::filesystem::path> paths;
+    std::error_code ec;
+    for(const auto& entry : std::filesystem::directory_iterator(mPluginDir, ec)) {
+        std::error_code typeEc;
+        if(entry.is_regular_file(typeEc) && entry.path().extension() == ".so") {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    for(const auto& path : paths) {
+        auto absolute = std::filesystem::absolute(path, ec);
+        auto stamp = stampOf(path);
+
+        // Libraries removed since listing the directory are left out.
+        if(ec || !stamp.has_value()) {
+            continue;
+        }
+
+        auto library = absolute.string();
+        auto found = indexed.find(library);
+        if(found != indexed.end() && found->second.stamp == stamp.value()) {
+            if(!found->second.error.empty()) {
+                mErrors.push_back(found->second.error);
+            }
+            current[library] = found->second;
+            continue;
+        }
+
+        changed = true;
+        try {
+            auto& plugin = mLibraries->load(library);
+            current[library] = {stamp.value(), describePlugin(plugin.parser, library), {}};
+        }
+        catch(const std::runtime_error& e) {
+            mErrors.push_back(e.what());
+            current[library] = {stamp.value(), {}, e.what()};
+        }
+    }
+
+    // Removed libraries also mean the index is out of date.
+    changed = changed || current.size() != indexed.size();
+    if(changed) {
+        writeIndex(mIndexPath, current);
+    }
+
+    for(const auto& el : current) {
+        mCommands.insert(mCommands.end(), el.second.commands.begin(), el.second.commands.end());
+    }
+
+    return mCommands;
+}
+
+std::size_t
+PluginLoader::loadedLibraries() const
+{
+    return mLibraries->size();
+}
+
+template<typename Target>
+void
+PluginLoader::registerCommands(Target& target) const
+{
+    for(const auto& info : mCommands) {
+        auto libraries = mLibraries;
+        if(info.isSubParser) {
+            target.cursorSubParser(info.name, info.shortHelp,
+                [libraries, info] (const Parser& parent, ArgCursor& args, ParseResult& result) {
+                    auto& plugin = libraries->load(info.library);
+                    SubParserPtr found = nullptr;
+                    auto findIn = [&found, &info] (const SubParserList& list) {
+                        for(const auto& el : list) {
+                            if(found == nullptr && el->name == info.name) found = el;
+                        }
+                    };
+
+                    findIn(plugin.parser.mSubParsers);
+                    for(const auto& group : plugin.parser.mGroups) {
+                        findIn(group.subParsers);
+                    }
+
+                    if(found == nullptr) {
+                        throw std::runtime_error("Plugin no longer provides subparser '" + info.name + "': '" + info.library + "'");
+                    }
+
+                    if(found->cursorHandler) {
+                        found->cursorHandler(parent, args, result);
+                    }
+                    else {
+                        result = found->handler(parent, result.optionResults(), args.toDeque());
+                    }
+                });
+        }
+        else {
+            target.lazyCommand(info.name, info.shortHelp,
+                [libraries, info] () {
+                    auto& plugin = libraries->load(info.library);
+                    auto com = plugin.parser.getCommand(info.name);
+                    if(com == nullptr) {
+                        throw std::runtime_error("Plugin no longer provides command '" + info.name + "': '" + info.library + "'");
+                    }
+
+                    return com;
+                });
+        }
+    }
+}
+
+void
+PluginLoader::registerInto(Parser& parser) const
+{
+    registerCommands(parser);
+}
+
+void
+PluginLoader::registerInto(CommandGroup& group) const
+{
+    registerCommands(group);
+}
+
+}
@@ -0,0 +1,98 @@
+#include <argunaught/argunaught.hpp>
+
+#include <fstream>
+#include <iostream>
+
+namespace argunaught
+{
+
+PositionalStream::PositionalStream(ArgCursor args)
+    : PositionalStream(args, std::cin)
+{
+}
+
+PositionalStream::PositionalStream(ArgCursor args, std::istream& in)
+    : mArgs(args), mStdin(in)
+{
+}
+
+PositionalStream::PositionalStream(const std::vector<std::string>& args)
+    : PositionalStream(args, std::cin)
+{
+}
+
+PositionalStream::PositionalStream(const std::vector<std::string>& args, std::istream& in)
+    : mStrings(&args), mStdin(in)
+{
+}
+
+PositionalStream::~PositionalStream() = default;
+
+bool 
+PositionalStream::nextArg(std::string_view& arg)
+{
+    if(mStrings != nullptr) {
+        if(mStringPos >= mStrings->size()) {
+            return false;
+        }
+
+        arg = (*mStrings)[mStringPos++];
+        return true;
+    }
+
+    if(mArgs.empty()) {
+        return false;
+    }
+
+    arg = mArgs.front();
+    mArgs.advance();
+    return true;
+}
+
+bool 
+PositionalStream::next()
+{
+    while(true) {
+        // Drain any file being read first, one line per argument.
+        if(mLines != nullptr) {
+            while(std::getline(*mLines, mLine)) {
+                if(!mLine.empty() && mLine.back() == '\r') {
+                    mLine.pop_back();
+                }
+
+                if(!mLine.empty()) {
+                    mCurrent = mLine;
+                    return true;
+                }
+            }
+
+            mLines = nullptr;
+            mFile.reset();
+        }
+
+        std::string_view arg;
+        if(!nextArg(arg)) {
+            mCurrent = {};
+            return false;
+        }
+
+        if(arg == "-") {
+            mLines = &mStdin;
+        }
+        else if(arg.size() > 1 && arg[0] == '@') {
+            std::string path(arg.substr(1));
+            mFile = std::make_unique<std::ifstream>(path);
+            if(!*mFile) {
+                mFile.reset();
+                throw std::runtime_error("Could not open response file: '" + path + "'");
+            }
+            mLines = mFile.get();
+        }
+        else {
+            mCurrent = arg;
+            return true;
+        }
+    }
+}
+
+}
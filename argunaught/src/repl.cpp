@@ -0,0 +1,850 @@
+#include <termios.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+
+#include <argunaught/repl.hpp>
+
+namespace argunaught
+{
+
+namespace
+{
+
+//! The most candidates listed when completing, the rest are counted.
+constexpr std::size_t MaxListedCandidates = 100;
+
+bool
+isBlank(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+//! Returns whether a token starts an option, matching the parser.
+bool
+isOptionToken(std::string_view arg)
+{
+    if(arg.empty() || arg[0] != '-') {
+        return false;
+    }
+
+    return !(arg.size() > 1 && std::isdigit(static_cast<unsigned char>(arg[1])));
+}
+
+bool
+startsWith(std::string_view text, std::string_view prefix)
+{
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+//! Finds the next word at or after `pos`, following the quoting rules of
+//! `tokenizeCommandLine`.  Returns false when there are no more words.
+bool
+scanWord(std::string_view line, std::size_t pos, ReplWord& word, std::vector<ParseError>& errors, std::size_t wordIndex)
+{
+    while(pos < line.size() && isBlank(line[pos])) {
+        pos++;
+    }
+
+    // A `#` starting a word comments out the rest of the line.
+    if(pos >= line.size() || line[pos] == '#') {
+        return false;
+    }
+
+    word.begin = pos;
+    bool plain = true;
+    std::optional<ParseErrorType> error;
+
+    // What closes an unfinished word, so its text can still be completed.
+    std::string_view closing;
+    while(pos < line.size() && !isBlank(line[pos])) {
+        const char ch = line[pos];
+        if(ch == '\'') {
+            plain = false;
+            auto close = line.find('\'', pos + 1);
+            if(close == std::string_view::npos) {
+                error = ParseErrorType::UnterminatedQuote;
+                closing = "'";
+                pos = line.size();
+                break;
+            }
+            pos = close + 1;
+        }
+        else if(ch == '"') {
+            plain = false;
+            pos++;
+            while(pos < line.size() && line[pos] != '"') {
+                pos += line[pos] == '\\' ? 2 : 1;
+            }
+
+            if(pos >= line.size()) {
+                error = ParseErrorType::UnterminatedQuote;
+                closing = pos > line.size() ? "\\\"" : "\"";
+                pos = line.size();
+                break;
+            }
+            pos++;
+        }
+        else if(ch == '\\') {
+            plain = false;
+            if(pos + 1 >= line.size()) {
+                error = ParseErrorType::TrailingEscape;
+                closing = "\\";
+            }
+            pos = std::min(pos + 2, line.size());
+        }
+        else {
+            pos++;
+        }
+    }
+
+    word.end = pos;
+    auto raw = line.substr(word.begin, word.end - word.begin);
+    if(plain) {
+        word.text = std::string(raw);
+    }
+    else {
+        auto tokens = tokenizeCommandLine(std::string(raw) + std::string(closing));
+        word.text = tokens.size() > 0 ? std::string(tokens[0]) : std::string();
+    }
+
+    if(error.has_value()) {
+        errors.push_back({error.value(), static_cast<int>(wordIndex), word.text});
+    }
+
+    return true;
+}
+
+bool
+isContinuation(char ch)
+{
+    return (static_cast<unsigned char>(ch) & 0xC0) == 0x80;
+}
+
+//! Puts a terminal in raw mode while enabled, restoring it afterwards.
+class RawMode
+{
+private:
+    bool mActive = false;
+    termios mSaved{};
+
+public:
+    explicit RawMode(bool useTerminal)
+    {
+        if(useTerminal && isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &mSaved) == 0) {
+            mActive = true;
+            enable();
+        }
+    }
+
+    ~RawMode() { disable(); }
+
+    RawMode(const RawMode&) = delete;
+    RawMode& operator=(const RawMode&) = delete;
+
+    void enable()
+    {
+        if(!mActive) return;
+
+        // Output processing is left on, so new lines still return the carriage.
+        termios raw = mSaved;
+        raw.c_iflag &= ~static_cast<tcflag_t>(ICRNL | IXON);
+        raw.c_lflag &= ~static_cast<tcflag_t>(ECHO | ICANON | ISIG | IEXTEN);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+    }
+
+    void disable()
+    {
+        if(mActive) tcsetattr(STDIN_FILENO, TCSAFLUSH, &mSaved);
+    }
+};
+
+}
+
+std::string
+ReplCompletion::commonPrefix() const
+{
+    if(candidates.empty()) {
+        return {};
+    }
+
+    std::string_view prefix = candidates.front();
+    for(const auto& candidate : candidates) {
+        auto len = std::min(prefix.size(), candidate.size());
+        std::size_t same = 0;
+        while(same < len && prefix[same] == candidate[same]) same++;
+        prefix = prefix.substr(0, same);
+    }
+
+    return std::string(prefix);
+}
+
+ReplLine::ReplLine(const Parser& parser)
+    : mParser(parser)
+{
+}
+
+void
+ReplLine::buildIndex()
+{
+    // Added in the order the parser looks names up, so the first entry for a
+    // name is the one it would find.
+    for(const auto& com : mParser.mCommands) {
+        mIndex.push_back({com->name, com, nullptr, nullptr});
+    }
+
+    for(const auto& group : mParser.mGroups) {
+        for(const auto& com : group.commands) {
+            mIndex.push_back({com->name, com, nullptr, nullptr});
+        }
+    }
+
+    for(const auto& lazy : mParser.mLazyCommands) {
+        mIndex.push_back({lazy->name, nullptr, lazy, nullptr});
+    }
+
+    for(const auto& group : mParser.mGroups) {
+        for(const auto& lazy : group.lazyCommands) {
+            mIndex.push_back({lazy->name, nullptr, lazy, nullptr});
+        }
+    }
+
+    for(const auto& sub : mParser.mSubParsers) {
+        mIndex.push_back({sub->name, nullptr, nullptr, sub});
+    }
+
+    for(const auto& group : mParser.mGroups) {
+        for(const auto& sub : group.subParsers) {
+            mIndex.push_back({sub->name, nullptr, nullptr, sub});
+        }
+    }
+
+    auto byName = [] (const CommandEntry& lhs, const CommandEntry& rhs) { return lhs.name < rhs.name; };
+    std::stable_sort(mIndex.begin(), mIndex.end(), byName);
+
+    auto sameName = [] (const CommandEntry& lhs, const CommandEntry& rhs) { return lhs.name == rhs.name; };
+    mIndex.erase(std::unique(mIndex.begin(), mIndex.end(), sameName), mIndex.end());
+    mIndexBuilt = true;
+}
+
+const ReplLine::CommandEntry*
+ReplLine::findCommand(std::string_view name)
+{
+    if(!mIndexBuilt) {
+        buildIndex();
+    }
+
+    auto it = std::lower_bound(mIndex.begin(), mIndex.end(), name, [] (const CommandEntry& entry, std::string_view value) {
+        return entry.name < value;
+    });
+
+    if(it != mIndex.end() && it->name == name) {
+        return &*it;
+    }
+
+    return nullptr;
+}
+
+const Option*
+ReplLine::findOption(const State& state, std::string_view token, std::size_t& optionId) const
+{
+    const bool isLongName = token.size() > 1 && token[1] == '-';
+    auto name = token.substr(isLongName ? 2 : 1);
+    auto findIndex = [name, isLongName] (const OptionList& list) {
+        return isLongName ? list.findLongOptionIndex(name) : list.findShortOptionIndex(name);
+    };
+
+    // The same precedence and ids as `Parser::parseOption`.
+    if(state.command != nullptr) {
+        auto index = findIndex(state.command->options);
+        if(index.has_value()) {
+            optionId = mParser.mOptions->size() + index.value();
+            return &state.command->options.at(index.value());
+        }
+    }
+
+    auto index = findIndex(*mParser.mOptions);
+    if(index.has_value()) {
+        optionId = index.value();
+        return &mParser.mOptions->at(index.value());
+    }
+
+    optionId = ColumnarArgs::UnknownOptionId;
+    if(mParser.mInheritedScope != nullptr) {
+        return isLongName ? mParser.mInheritedScope->findLongOption(name) : mParser.mInheritedScope->findShortOption(name);
+    }
+
+    return nullptr;
+}
+
+ReplLine::State
+ReplLine::stateBefore(std::size_t wordIndex) const
+{
+    return wordIndex == 0 ? State() : mWords[wordIndex - 1].state;
+}
+
+void
+ReplLine::analyzeWord(WordRecord& record, const State& before)
+{
+    State state = before;
+    const auto& token = record.word.text;
+    const int wordIndex = static_cast<int>(mWords.size());
+
+    auto endOptions = [&state] () {
+        state.phase = state.phase == Phase::GlobalOptions ? Phase::Command : Phase::Positional;
+    };
+
+    if(state.phase == Phase::Positional || state.phase == Phase::SubParser) {
+        record.state = state;
+        return;
+    }
+
+    if(state.pending != nullptr) {
+        const auto& opt = *state.pending;
+        const bool canTakeValue = opt.maxNumParams == -1 || state.numValues < opt.maxNumParams;
+        const bool looksLikeOption = token.size() > 1 && token[0] == '-' &&
+                                     !std::isdigit(static_cast<unsigned char>(token[1]));
+        if(canTakeValue && !looksLikeOption) {
+            state.numValues++;
+            record.state = state;
+            return;
+        }
+
+        if(state.numValues < opt.minNumParams) {
+            record.errors.push_back({ParseErrorType::TooFewOptionParams, static_cast<int>(state.pendingWord), opt.longName});
+        }
+        state.pending = nullptr;
+    }
+
+    const bool optionsAllowed = state.phase == Phase::GlobalOptions || state.phase == Phase::CommandOptions;
+    if(optionsAllowed && isOptionToken(token)) {
+        if(token == "-" || token == "--") {
+            endOptions();
+        }
+        else if(auto opt = findOption(state, token, record.optionId); opt != nullptr) {
+            state.pending = opt;
+            state.pendingWord = static_cast<std::size_t>(wordIndex);
+            state.numValues = 0;
+        }
+        else {
+            const auto nameStart = token.size() > 1 && token[1] == '-' ? 2 : 1;
+            record.errors.push_back({ParseErrorType::UnknownOption, wordIndex, token.substr(nameStart)});
+            endOptions();
+        }
+
+        record.state = state;
+        return;
+    }
+
+    state.phase = Phase::Positional;
+    if(before.phase == Phase::GlobalOptions || before.phase == Phase::Command) {
+        if(auto entry = findCommand(token); entry != nullptr) {
+            if(entry->subParser != nullptr) {
+                state.phase = Phase::SubParser;
+                state.subParser = entry->subParser;
+            }
+            else {
+                state.phase = Phase::CommandOptions;
+                state.command = entry->command != nullptr ? entry->command : mParser.materialize(*entry->lazy);
+            }
+        }
+    }
+
+    record.state = state;
+}
+
+void
+ReplLine::finish()
+{
+    mErrors.clear();
+    for(const auto& record : mWords) {
+        mErrors.insert(mErrors.end(), record.errors.begin(), record.errors.end());
+    }
+
+    if(mWords.empty()) {
+        return;
+    }
+
+    const auto& last = mWords.back().state;
+    if(last.pending != nullptr && last.numValues < last.pending->minNumParams) {
+        mErrors.push_back({ParseErrorType::TooFewOptionParams, static_cast<int>(last.pendingWord), last.pending->longName});
+    }
+
+    OptionMask present;
+    for(const auto& record : mWords) {
+        if(record.optionId != ColumnarArgs::UnknownOptionId) {
+            present.set(record.optionId);
+        }
+    }
+
+    // Only the global options before a subparser are ours to check, it 
+    // checks the rest itself.
+    mParser.mConstraintRules.evaluate(present, mErrors);
+    if(last.phase != Phase::SubParser && last.command != nullptr) {
+        last.command->constraintRules.evaluate(present, mErrors);
+    }
+}
+
+void
+ReplLine::update(std::string_view line)
+{
+    std::size_t same = 0;
+    const auto limit = std::min(mText.size(), line.size());
+    while(same < limit && mText[same] == line[same]) {
+        same++;
+    }
+
+    if(same == mText.size() && same == line.size()) {
+        mLastRescan = line.size();
+        return;
+    }
+
+    // Words ending before the first change are untouched, along with the state after them.
+    auto firstChanged = std::find_if(mWords.begin(), mWords.end(), [same] (const WordRecord& record) {
+        return record.word.end >= same;
+    });
+    mWords.erase(firstChanged, mWords.end());
+    mText = std::string(line);
+
+    std::size_t pos = mWords.empty() ? 0 : mWords.back().word.end;
+    mLastRescan = pos;
+
+    WordRecord record;
+    while(scanWord(mText, pos, record.word, record.errors, mWords.size())) {
+        pos = record.word.end;
+        analyzeWord(record, stateBefore(mWords.size()));
+        mWords.push_back(std::move(record));
+        record = WordRecord();
+    }
+
+    finish();
+}
+
+std::vector<ReplWord>
+ReplLine::words() const
+{
+    std::vector<ReplWord> result;
+    result.reserve(mWords.size());
+    for(const auto& record : mWords) {
+        result.push_back(record.word);
+    }
+
+    return result;
+}
+
+ReplLine::Phase
+ReplLine::phase() const
+{
+    return mWords.empty() ? Phase::GlobalOptions : mWords.back().state.phase;
+}
+
+ReplCompletion
+ReplLine::complete(std::size_t cursor)
+{
+    cursor = std::min(cursor, mText.size());
+
+    ReplCompletion completion{cursor, cursor, {}};
+    std::string prefix;
+    std::size_t wordIndex = 0;
+    while(wordIndex < mWords.size() && mWords[wordIndex].word.end < cursor) {
+        wordIndex++;
+    }
+
+    if(wordIndex < mWords.size() && mWords[wordIndex].word.begin <= cursor) {
+        const auto& word = mWords[wordIndex].word;
+        completion.begin = word.begin;
+        completion.end = word.end;
+        prefix = cursor == word.end ? word.text : mText.substr(word.begin, cursor - word.begin);
+    }
+
+    const auto state = stateBefore(wordIndex);
+    auto& candidates = completion.candidates;
+
+    if(!isOptionToken(prefix)) {
+        // A value for an option, or a positional argument, can't be completed.
+        const bool takesValue = state.pending != nullptr &&
+                                (state.pending->maxNumParams == -1 || state.numValues < state.pending->maxNumParams);
+        const bool commandNext = state.phase == Phase::GlobalOptions || state.phase == Phase::Command;
+        if(takesValue || !commandNext) {
+            return completion;
+        }
+
+        if(!mIndexBuilt) {
+            buildIndex();
+        }
+
+        auto it = std::lower_bound(mIndex.begin(), mIndex.end(), prefix, [] (const CommandEntry& entry, const std::string& value) {
+            return entry.name < value;
+        });
+
+        for(; it != mIndex.end() && startsWith(it->name, prefix); ++it) {
+            candidates.emplace_back(it->name);
+        }
+
+        return completion;
+    }
+
+    if(state.phase == Phase::Positional || state.phase == Phase::Command) {
+        return completion;
+    }
+
+    const bool onlyLong = startsWith(prefix, "--");
+    auto addOptions = [&] (const OptionList& options) {
+        for(const auto& opt : options) {
+            auto longName = "--" + opt.longName;
+            if(startsWith(longName, prefix)) {
+                candidates.push_back(longName);
+            }
+
+            if(!onlyLong && !opt.shortName.empty() && startsWith("-" + opt.shortName, prefix)) {
+                candidates.push_back("-" + opt.shortName);
+            }
+        }
+    };
+
+    if(state.phase == Phase::SubParser) {
+        addOptions(state.subParser->options);
+    }
+    else {
+        if(state.command != nullptr) {
+            addOptions(state.command->options);
+        }
+
+        addOptions(*mParser.mOptions);
+        if(mParser.mInheritedScope != nullptr) {
+            for(const auto* layer : mParser.mInheritedScope->layers()) {
+                addOptions(*layer);
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return completion;
+}
+
+Repl::Repl(const Parser& parser, ReplOptions opts)
+    : mParser(parser),
+      mOptions(opts),
+      mLine(parser)
+{
+    if(!mOptions.dispatch) {
+        mOptions.dispatch = [] (const ParseResult& result) {
+            return result.runCommand();
+        };
+    }
+
+    loadHistory();
+    mHistoryPos = mHistory.size();
+}
+
+void
+Repl::loadHistory()
+{
+    if(mOptions.historyFile.empty()) {
+        return;
+    }
+
+    std::ifstream file(mOptions.historyFile);
+    std::string line;
+    std::size_t numLines = 0;
+    while(std::getline(file, line)) {
+        numLines++;
+        if(!line.empty()) mHistory.push_back(line);
+    }
+
+    if(mHistory.size() > mOptions.maxHistory) {
+        mHistory.erase(mHistory.begin(), mHistory.end() - static_cast<std::ptrdiff_t>(mOptions.maxHistory));
+    }
+
+    // Appending keeps growing the file, so it's trimmed once it's twice the limit.
+    if(numLines > 2 * mOptions.maxHistory) {
+        std::ofstream trimmed(mOptions.historyFile, std::ios::trunc);
+        for(const auto& entry : mHistory) {
+            trimmed << entry << "\n";
+        }
+    }
+}
+
+void
+Repl::addHistory(const std::string& line)
+{
+    if(line.empty() || (!mHistory.empty() && mHistory.back() == line)) {
+        return;
+    }
+
+    mHistory.push_back(line);
+    if(mHistory.size() > mOptions.maxHistory) {
+        mHistory.erase(mHistory.begin());
+    }
+
+    if(!mOptions.historyFile.empty()) {
+        std::ofstream file(mOptions.historyFile, std::ios::app);
+        file << line << "\n";
+    }
+}
+
+void
+Repl::setText(std::string text, std::size_t cursor)
+{
+    mText = std::move(text);
+    mCursor = std::min(cursor, mText.size());
+    mLine.update(mText);
+}
+
+void
+Repl::refresh(std::ostream& out)
+{
+    out << "\r" << mOptions.prompt << mText << "\x1b[K";
+    if(mOptions.showErrors && !mLine.errors().empty()) {
+        out << "  \x1b[2m" << describeParseError(mLine.errors().front()) << "\x1b[0m";
+    }
+
+    auto column = displayWidth(mOptions.prompt) + displayWidth(std::string_view(mText).substr(0, mCursor));
+    out << "\r";
+    if(column > 0) {
+        out << "\x1b[" << column << "C";
+    }
+    out.flush();
+}
+
+void
+Repl::completeWord(std::ostream& out)
+{
+    auto completion = mLine.complete(mCursor);
+    const auto& candidates = completion.candidates;
+    if(candidates.empty()) {
+        out << '\a';
+        return;
+    }
+
+    auto current = mText.substr(completion.begin, mCursor - completion.begin);
+    std::string replacement;
+    if(candidates.size() == 1) {
+        replacement = candidates.front();
+        if(completion.end >= mText.size() || !isBlank(mText[completion.end])) {
+            replacement += " ";
+        }
+    }
+    else {
+        replacement = completion.commonPrefix();
+        if(replacement.size() <= current.size()) {
+            if(!mCompletionPending) {
+                mCompletionPending = true;
+                out << '\a';
+                return;
+            }
+
+            // A second tab lists the candidates.
+            out << "\n";
+            for(std::size_t ii = 0; ii < candidates.size() && ii < MaxListedCandidates; ++ii) {
+                out << candidates[ii] << "  ";
+            }
+            if(candidates.size() > MaxListedCandidates) {
+                out << "(" << candidates.size() - MaxListedCandidates << " more)";
+            }
+            out << "\n";
+            mCompletionPending = false;
+            return;
+        }
+    }
+
+    auto text = mText.substr(0, completion.begin) + replacement + mText.substr(completion.end);
+    setText(text, completion.begin + replacement.size());
+}
+
+int
+Repl::runLine(const std::string& line, std::ostream& out)
+{
+    auto result = mParser.parseCommandLine(line);
+    if(result.hasError()) {
+        for(const auto& error : result.errors) {
+            out << "error: " << describeParseError(error) << "\n";
+        }
+        return 1;
+    }
+
+    try {
+        return mOptions.dispatch(result);
+    }
+    catch(const std::exception& e) {
+        out << "error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int
+Repl::run(std::istream& in, std::ostream& out)
+{
+    RawMode rawMode(&in == &std::cin);
+    int exitCode = 0;
+
+    auto prevBoundary = [this] (std::size_t pos) {
+        while(pos > 0 && isContinuation(mText[--pos])) {}
+        return pos;
+    };
+
+    auto nextBoundary = [this] (std::size_t pos) {
+        while(pos < mText.size() && isContinuation(mText[++pos])) {}
+        return std::min(pos, mText.size());
+    };
+
+    // Replaces part of the line, leaving the cursor after the new text.
+    auto replace = [this] (std::size_t start, std::size_t end, std::string_view text) {
+        auto line = mText.substr(0, start);
+        line.append(text);
+        line.append(mText, end, std::string::npos);
+        setText(line, start + text.size());
+    };
+
+    auto showHistory = [this] (std::size_t pos) {
+        if(mHistoryPos == mHistory.size()) mStash = mText;
+        mHistoryPos = pos;
+        auto text = pos == mHistory.size() ? mStash : mHistory[pos];
+        setText(text, text.size());
+    };
+
+    setText("", 0);
+    refresh(out);
+
+    char ch = 0;
+    while(in.get(ch)) {
+        const auto key = static_cast<unsigned char>(ch);
+        if(key != '\t') {
+            mCompletionPending = false;
+        }
+
+        switch(key)
+        {
+            case '\r':
+            case '\n': {
+                auto line = mText;
+                setText("", 0);
+                mHistoryPos = mHistory.size();
+
+                // Drop the error hint from the finished line.
+                out << "\x1b[K\n";
+
+                auto words = tokenizeCommandLine(line);
+                if(words.size() == 1 && words[0] == mOptions.exitCommand) {
+                    addHistory(line);
+                    return exitCode;
+                }
+
+                if(words.size() > 0 || words.hasError()) {
+                    addHistory(line);
+                    out.flush();
+                    rawMode.disable();
+                    exitCode = runLine(line, out);
+                    rawMode.enable();
+                }
+                break;
+            }
+
+            case 0x03: // Ctrl-C abandons the line.
+                out << "^C\n";
+                mHistoryPos = mHistory.size();
+                setText("", 0);
+                break;
+
+            case 0x04: // Ctrl-D ends the session on an empty line, otherwise deletes.
+                if(mText.empty()) {
+                    out << "\n";
+                    return exitCode;
+                }
+                replace(mCursor, nextBoundary(mCursor), {});
+                break;
+
+            case '\t':
+                completeWord(out);
+                break;
+
+            case 0x7F:
+            case 0x08:
+                replace(prevBoundary(mCursor), mCursor, {});
+                break;
+
+            case 0x01: mCursor = 0; break;
+            case 0x05: mCursor = mText.size(); break;
+            case 0x02: mCursor = prevBoundary(mCursor); break;
+            case 0x06: mCursor = nextBoundary(mCursor); break;
+            case 0x0B: replace(mCursor, mText.size(), {}); break;
+            case 0x15: replace(0, mCursor, {}); break;
+
+            case 0x17: { // Ctrl-W deletes the word before the cursor.
+                auto start = mCursor;
+                while(start > 0 && isBlank(mText[start - 1])) start--;
+                while(start > 0 && !isBlank(mText[start - 1])) start--;
+                replace(start, mCursor, {});
+                break;
+            }
+
+            case 0x10: if(mHistoryPos > 0) showHistory(mHistoryPos - 1); break;
+            case 0x0E: if(mHistoryPos < mHistory.size()) showHistory(mHistoryPos + 1); break;
+            case 0x0C: out << "\x1b[H\x1b[2J"; break;
+
+            case 0x1B: { // Escape sequences for the arrow, home, end and delete keys.
+                char introducer = 0;
+                char code = 0;
+                if(!in.get(introducer) || (introducer != '[' && introducer != 'O') || !in.get(code)) {
+                    break;
+                }
+
+                // CSI sequences have parameter and intermediate bytes before
+                // their final byte, e.g. `ESC[1;5D` for ctrl+left.  They're
+                // read up to the final byte, only the first parameter picks
+                // the key and any modifiers are ignored.
+                int param = -1;
+                bool firstParam = true;
+                while(introducer == '[' && code >= 0x20 && code <= 0x3F) {
+                    if(code == ';') {
+                        firstParam = false;
+                    }
+                    else if(firstParam && std::isdigit(static_cast<unsigned char>(code)) && param < 1000) {
+                        param = (param < 0 ? 0 : param * 10) + (code - '0');
+                    }
+
+                    if(!in.get(code)) {
+                        code = 0;
+                        break;
+                    }
+                }
+
+                if(code == '~') {
+                    if(param == 3) code = 'P';
+                    else if(param == 1 || param == 7) code = 'H';
+                    else if(param == 4 || param == 8) code = 'F';
+                }
+
+                switch(code)
+                {
+                    case 'A': if(mHistoryPos > 0) showHistory(mHistoryPos - 1); break;
+                    case 'B': if(mHistoryPos < mHistory.size()) showHistory(mHistoryPos + 1); break;
+                    case 'C': mCursor = nextBoundary(mCursor); break;
+                    case 'D': mCursor = prevBoundary(mCursor); break;
+                    case 'H': mCursor = 0; break;
+                    case 'F': mCursor = mText.size(); break;
+                    case 'P': replace(mCursor, nextBoundary(mCursor), {}); break;
+                    default: break;
+                }
+                break;
+            }
+
+            default:
+                if(key >= 0x20) {
+                    replace(mCursor, mCursor, std::string_view(&ch, 1));
+                }
+                break;
+        }
+
+        refresh(out);
+    }
+
+    out << "\n";
+    return exitCode;
+}
+
+}
@@ -0,0 +1,732 @@
+#include <argunaught/schema.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace argunaught
+{
+
+namespace
+{
+
+constexpr char Magic[8] = {'A', 'R', 'G', 'U', 'S', 'C', 'H', 'M'};
+
+//! Written as is, so a blob from a machine with the other byte order won't match.
+constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+constexpr std::uint32_t PassThroughFlag = 1;
+constexpr std::uint32_t ColumnarResultsFlag = 2;
+
+//! A string in the string section.
+struct StringRef
+{
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+//! A run of records in one of the sections.
+struct Range
+{
+    std::uint32_t first;
+    std::uint32_t count;
+};
+
+//! Where a section's records start in the blob, and how many there are.
+struct Section
+{
+    std::uint32_t offset;
+    std::uint32_t count;
+};
+
+struct Header
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t totalSize;
+    std::uint32_t flags;
+    StringRef name;
+    StringRef banner;
+    StringRef description;
+    StringRef usage;
+    std::uint32_t numGlobalOptions;
+    Section options;
+    Section names;
+    Section commands;
+    Section commandIndex;
+    Section groups;
+    Section constraints;
+    Section strings;
+};
+
+struct OptionRecord
+{
+    StringRef longName;
+    StringRef shortName;
+    StringRef description;
+    std::int32_t maxNumParams;
+    std::int32_t minNumParams;
+    std::uint32_t required;
+    std::uint32_t repeat;
+    Range conflictsWith;
+    Range dependsOn;
+};
+
+struct CommandRecord
+{
+    StringRef name;
+    StringRef description;
+    std::uint32_t kind;
+    std::int32_t group;
+    Range options;
+};
+
+struct GroupRecord
+{
+    StringRef name;
+    StringRef description;
+};
+
+struct ConstraintRecord
+{
+    std::uint32_t type;
+    Range options;
+};
+
+static_assert(std::is_trivially_copyable_v<Header> && sizeof(Header) % 4 == 0);
+static_assert(sizeof(OptionRecord) % 4 == 0 && sizeof(CommandRecord) % 4 == 0);
+
+//! Collects a parser's definition into records and writes them out as a blob.
+class SchemaWriter
+{
+private:
+    std::string mStrings;
+    std::unordered_map<std::string, StringRef> mStringRefs;
+    std::vector<OptionRecord> mOptions;
+    std::vector<StringRef> mNames;
+    std::vector<CommandRecord> mCommands;
+    std::vector<GroupRecord> mGroups;
+    std::vector<ConstraintRecord> mConstraints;
+
+public:
+    StringRef addString(const std::string& value)
+    {
+        auto found = mStringRefs.find(value);
+        if(found != mStringRefs.end()) {
+            return found->second;
+        }
+
+        StringRef ref{static_cast<std::uint32_t>(mStrings.size()), static_cast<std::uint32_t>(value.size())};
+        mStrings += value;
+        mStringRefs.emplace(value, ref);
+        return ref;
+    }
+
+    Range addNames(const std::vector<std::string>& names)
+    {
+        Range range{static_cast<std::uint32_t>(mNames.size()), static_cast<std::uint32_t>(names.size())};
+        for(const auto& name : names) {
+            mNames.push_back(addString(name));
+        }
+
+        return range;
+    }
+
+    Range addOptions(const OptionList& options)
+    {
+        Range range{static_cast<std::uint32_t>(mOptions.size()), static_cast<std::uint32_t>(options.size())};
+        for(const auto& opt : options) {
+            mOptions.push_back({
+                addString(opt.longName),
+                addString(opt.shortName),
+                addString(opt.description),
+                opt.maxNumParams,
+                opt.minNumParams,
+                opt.required ? 1u : 0u,
+                static_cast<std::uint32_t>(opt.repeat),
+                addNames(opt.conflictsWith),
+                addNames(opt.dependsOn)
+            });
+        }
+
+        return range;
+    }
+
+    void addCommand(const Command& com, int group)
+    {
+        auto kind = com.streamingHandler ? SchemaCommandKind::StreamingCommand : SchemaCommandKind::Command;
+        mCommands.push_back({
+            addString(com.name), addString(com.description), static_cast<std::uint32_t>(kind), group, addOptions(com.options)
+        });
+    }
+
+    void addSubParser(const SubParser& sub, int group)
+    {
+        mCommands.push_back({
+            addString(sub.name),
+            addString(sub.description),
+            static_cast<std::uint32_t>(SchemaCommandKind::SubParser),
+            group,
+            addOptions(sub.options)
+        });
+    }
+
+    void addGroup(const CommandGroup& group)
+    {
+        mGroups.push_back({addString(group.name), addString(group.description)});
+    }
+
+    void addConstraint(const Constraint& constraint)
+    {
+        mConstraints.push_back({static_cast<std::uint32_t>(constraint.type), addNames(constraint.options)});
+    }
+
+    std::string finish(Header header)
+    {
+        // The command index lists command indexes sorted by name, for binary searching.
+        std::vector<std::uint32_t> index(mCommands.size());
+        for(std::uint32_t ii = 0; ii < index.size(); ++ii) {
+            index[ii] = ii;
+        }
+
+        auto nameOf = [this] (std::uint32_t com) {
+            return std::string_view(mStrings).substr(mCommands[com].name.offset, mCommands[com].name.size);
+        };
+        std::sort(index.begin(), index.end(), [&nameOf] (auto a, auto b) { return nameOf(a) < nameOf(b); });
+
+        std::string blob(sizeof(Header), '\0');
+        auto append = [&blob] (const auto& records) {
+            Section section{static_cast<std::uint32_t>(blob.size()), static_cast<std::uint32_t>(records.size())};
+            blob.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(records[0]));
+            return section;
+        };
+
+        header.options = append(mOptions);
+        header.names = append(mNames);
+        header.commands = append(mCommands);
+        header.commandIndex = append(index);
+        header.groups = append(mGroups);
+        header.constraints = append(mConstraints);
+        header.strings = {static_cast<std::uint32_t>(blob.size()), static_cast<std::uint32_t>(mStrings.size())};
+        blob += mStrings;
+
+        header.totalSize = static_cast<std::uint32_t>(blob.size());
+        std::memcpy(&blob[0], &header, sizeof(header));
+        return blob;
+    }
+};
+
+Option
+buildOption(const SchemaOption& opt)
+{
+    Option built{std::string(opt.longName), std::string(opt.shortName), std::string(opt.description),
+                 opt.maxNumParams, opt.minNumParams, opt.required};
+    for(std::size_t ii = 0; ii < opt.conflictsWith.size(); ++ii) {
+        built.conflictsWith.emplace_back(opt.conflictsWith[ii]);
+    }
+    for(std::size_t ii = 0; ii < opt.dependsOn.size(); ++ii) {
+        built.dependsOn.emplace_back(opt.dependsOn[ii]);
+    }
+
+    built.repeat = opt.repeat;
+    return built;
+}
+
+//! Registers a schema command into a parser or command group.
+template<typename Target>
+void
+registerCommand(Target& target, const Schema& schema, std::size_t index, const SchemaHandlers& handlers)
+{
+    auto com = schema.command(index);
+    std::string name(com.name);
+    auto description = std::string(com.description);
+
+    auto findHandler = [&name] (const auto& map) {
+        auto found = map.find(name);
+        if(found == map.end()) {
+            throw std::runtime_error("No handler bound for schema command: '" + name + "'!");
+        }
+        return found->second;
+    };
+
+    auto buildOptions = [schema, com] () {
+        std::vector<Option> options;
+        options.reserve(com.numOptions);
+        for(std::uint32_t ii = 0; ii < com.numOptions; ++ii) {
+            options.push_back(buildOption(schema.option(com.firstOption + ii)));
+        }
+        return options;
+    };
+
+    if(com.kind == SchemaCommandKind::SubParser) {
+        target.cursorSubParser(name, description, buildOptions(), findHandler(handlers.subParsers));
+        return;
+    }
+
+    auto shortHelp = description.substr(0, description.find('\n'));
+    if(com.kind == SchemaCommandKind::StreamingCommand) {
+        auto handler = findHandler(handlers.streamingCommands);
+        target.lazyCommand(name, shortHelp, [name, description, buildOptions, handler] () {
+            auto built = std::make_shared<Command>(name, description, buildOptions(), nullptr);
+            built->streamingHandler = handler;
+            return built;
+        });
+    }
+    else {
+        auto handler = findHandler(handlers.commands);
+        target.lazyCommand(name, shortHelp, [name, description, buildOptions, handler] () {
+            return std::make_shared<Command>(name, description, buildOptions(), handler);
+        });
+    }
+}
+
+}
+
+std::string_view
+SchemaNames::operator[](std::size_t index) const
+{
+    auto header = mSchema->read<Header>(0);
+    return mSchema->string(header.names.offset + (mFirst + index) * sizeof(StringRef));
+}
+
+Schema::Schema(std::shared_ptr<const void> owner, const char* data, std::size_t size)
+    : mOwner(std::move(owner)),
+      mData(data),
+      mSize(size)
+{
+    validate();
+}
+
+template<typename T>
+T
+Schema::read(std::size_t offset) const
+{
+    // Copied out rather than cast, so the blob needn't be aligned.
+    T value;
+    std::memcpy(&value, mData + offset, sizeof(T));
+    return value;
+}
+
+std::string_view
+Schema::string(std::size_t refOffset) const
+{
+    auto ref = read<StringRef>(refOffset);
+    auto strings = read<Header>(0).strings.offset;
+    return std::string_view(mData + strings + ref.offset, ref.size);
+}
+
+void
+Schema::validate() const
+{
+    auto fail = [] (const std::string& reason) {
+        throw std::runtime_error("Invalid argunaught schema: " + reason);
+    };
+
+    if(mSize < sizeof(Header)) {
+        fail("too small");
+    }
+
+    auto header = read<Header>(0);
+    if(std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) fail("bad magic");
+    if(header.byteOrder != ByteOrderMark) fail("written with a different byte order");
+    if(header.version != Version) fail("unsupported version " + std::to_string(header.version));
+    if(header.totalSize != mSize) fail("truncated");
+
+    auto checkSection = [this, &fail] (const Section& section, std::size_t recordSize) {
+        if(section.offset > mSize || section.count > (mSize - section.offset) / recordSize) {
+            fail("section out of bounds");
+        }
+    };
+
+    checkSection(header.options, sizeof(OptionRecord));
+    checkSection(header.names, sizeof(StringRef));
+    checkSection(header.commands, sizeof(CommandRecord));
+    checkSection(header.commandIndex, sizeof(std::uint32_t));
+    checkSection(header.groups, sizeof(GroupRecord));
+    checkSection(header.constraints, sizeof(ConstraintRecord));
+    checkSection(header.strings, 1);
+
+    auto checkString = [&header, &fail] (const StringRef& ref) {
+        if(ref.offset > header.strings.count || ref.size > header.strings.count - ref.offset) {
+            fail("string out of bounds");
+        }
+    };
+
+    auto checkRange = [&fail] (const Range& range, std::uint32_t count) {
+        if(range.first > count || range.count > count - range.first) {
+            fail("range out of bounds");
+        }
+    };
+
+    checkString(header.name);
+    checkString(header.banner);
+    checkString(header.description);
+    checkString(header.usage);
+    if(header.numGlobalOptions > header.options.count) fail("range out of bounds");
+
+    for(std::uint32_t ii = 0; ii < header.names.count; ++ii) {
+        checkString(read<StringRef>(header.names.offset + ii * sizeof(StringRef)));
+    }
+
+    for(std::uint32_t ii = 0; ii < header.options.count; ++ii) {
+        auto opt = read<OptionRecord>(header.options.offset + ii * sizeof(OptionRecord));
+        checkString(opt.longName);
+        checkString(opt.shortName);
+        checkString(opt.description);
+        checkRange(opt.conflictsWith, header.names.count);
+        checkRange(opt.dependsOn, header.names.count);
+        if(opt.repeat > static_cast<std::uint32_t>(RepeatPolicy::Error)) fail("unknown repeat policy");
+    }
+
+    for(std::uint32_t ii = 0; ii < header.commands.count; ++ii) {
+        auto com = read<CommandRecord>(header.commands.offset + ii * sizeof(CommandRecord));
+        checkString(com.name);
+        checkString(com.description);
+        checkRange(com.options, header.options.count);
+        if(com.kind > static_cast<std::uint32_t>(SchemaCommandKind::SubParser)) fail("unknown command kind");
+        if(com.group < -1 || com.group >= static_cast<std::int32_t>(header.groups.count)) fail("unknown group");
+    }
+
+    if(header.commandIndex.count != header.commands.count) fail("command index size mismatch");
+    for(std::uint32_t ii = 0; ii < header.commandIndex.count; ++ii) {
+        if(read<std::uint32_t>(header.commandIndex.offset + ii * sizeof(std::uint32_t)) >= header.commands.count) {
+            fail("command index out of bounds");
+        }
+    }
+
+    for(std::uint32_t ii = 0; ii < header.groups.count; ++ii) {
+        auto group = read<GroupRecord>(header.groups.offset + ii * sizeof(GroupRecord));
+        checkString(group.name);
+        checkString(group.description);
+    }
+
+    for(std::uint32_t ii = 0; ii < header.constraints.count; ++ii) {
+        auto constraint = read<ConstraintRecord>(header.constraints.offset + ii * sizeof(ConstraintRecord));
+        checkRange(constraint.options, header.names.count);
+        if(constraint.type > static_cast<std::uint32_t>(ConstraintType::AtLeastOne)) fail("unknown constraint type");
+    }
+}
+
+std::string
+Schema::serialize(const Parser& parser)
+{
+    SchemaWriter writer;
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.flags = (parser.mPassThrough ? PassThroughFlag : 0) | (parser.mColumnarResults ? ColumnarResultsFlag : 0);
+    header.name = writer.addString(parser.mName);
+    header.banner = writer.addString(parser.mBanner);
+    header.description = writer.addString(parser.mDescription);
+    header.usage = writer.addString(parser.mUsage);
+
+    // Global options come first, so they're the first records.
+    header.numGlobalOptions = writer.addOptions(*parser.mOptions).count;
+
+    // Ungrouped commands come before each group's in turn, so each group's
+    // commands are contiguous.
+    for(const auto& com : parser.mCommands) {
+        writer.addCommand(*com, -1);
+    }
+    for(const auto& lazy : parser.mLazyCommands) {
+        writer.addCommand(*parser.materialize(*lazy), -1);
+    }
+    for(const auto& sub : parser.mSubParsers) {
+        writer.addSubParser(*sub, -1);
+    }
+
+    for(std::size_t ii = 0; ii < parser.mGroups.size(); ++ii) {
+        const auto& group = parser.mGroups[ii];
+        writer.addGroup(group);
+        for(const auto& com : group.commands) {
+            writer.addCommand(*com, static_cast<int>(ii));
+        }
+        for(const auto& lazy : group.lazyCommands) {
+            writer.addCommand(*parser.materialize(*lazy), static_cast<int>(ii));
+        }
+        for(const auto& sub : group.subParsers) {
+            writer.addSubParser(*sub, static_cast<int>(ii));
+        }
+    }
+
+    for(const auto& constraint : parser.mConstraints) {
+        writer.addConstraint(constraint);
+    }
+
+    return writer.finish(header);
+}
+
+void
+Schema::write(const Parser& parser, const std::string& path)
+{
+    auto blob = serialize(parser);
+
+    // Truncating the file in place would pull the pages out from under any
+    // process that has it mapped, so write a new file and rename it over.
+    auto tmpPath = path + ".XXXXXX";
+    int fd = mkstemp(tmpPath.data());
+    if(fd < 0) {
+        throw std::runtime_error("Unable to write schema: '" + path + "'!");
+    }
+
+    bool written = fchmod(fd, 0644) == 0;
+    for(std::size_t pos = 0; written && pos < blob.size(); ) {
+        auto len = ::write(fd, blob.data() + pos, blob.size() - pos);
+        if(len < 0 && errno == EINTR) continue;
+        written = len > 0;
+        pos += written ? static_cast<std::size_t>(len) : 0;
+    }
+
+    written = close(fd) == 0 && written;
+    if(!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        throw std::runtime_error("Unable to write schema: '" + path + "'!");
+    }
+}
+
+Schema
+Schema::fromBuffer(std::string data)
+{
+    auto owned = std::make_shared<const std::string>(std::move(data));
+    return Schema(owned, owned->data(), owned->size());
+}
+
+Schema
+Schema::fromStatic(const void* data, std::size_t size)
+{
+    return Schema(nullptr, static_cast<const char*>(data), size);
+}
+
+Schema
+Schema::map(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("Unable to open schema: '" + path + "'!");
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Unable to read schema: '" + path + "'!");
+    }
+
+    auto size = static_cast<std::size_t>(info.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED) {
+        throw std::runtime_error("Unable to map schema: '" + path + "'!");
+    }
+
+    std::shared_ptr<const void> owner(mapped, [size] (const void* data) {
+        munmap(const_cast<void*>(data), size);
+    });
+    return Schema(owner, static_cast<const char*>(mapped), size);
+}
+
+Parser
+Schema::instantiate(const SchemaHandlers& handlers) const
+{
+    Parser parser{std::string(name()), std::string(banner())};
+    parser.description(std::string(description()));
+    parser.usage(std::string(usage()));
+    parser.passThrough(passThrough());
+    parser.columnarResults(columnarResults());
+
+    std::vector<Option> globals;
+    for(std::size_t ii = 0; ii < numGlobalOptions(); ++ii) {
+        globals.push_back(buildOption(option(ii)));
+    }
+    parser.options(globals);
+
+    std::vector<Constraint> constraints;
+    for(std::size_t ii = 0; ii < numConstraints(); ++ii) {
+        auto con = constraint(ii);
+        Constraint built{con.type, {}};
+        for(std::size_t jj = 0; jj < con.options.size(); ++jj) built.options.emplace_back(con.options[jj]);
+        constraints.push_back(std::move(built));
+    }
+    if(!constraints.empty()) {
+        parser.constraints(constraints);
+    }
+
+    // Commands are stored ungrouped first and then group by group, so each
+    // group is created once and filled before moving on to the next.
+    CommandGroup* currentGroup = nullptr;
+    int groupsCreated = 0;
+    for(std::size_t ii = 0; ii < numCommands(); ++ii) {
+        auto com = command(ii);
+        if(com.group < 0) {
+            registerCommand(parser, *this, ii, handlers);
+            continue;
+        }
+
+        while(groupsCreated <= com.group) {
+            auto g = group(groupsCreated++);
+            currentGroup = &parser.group(std::string(g.name), std::string(g.description));
+        }
+        registerCommand(*currentGroup, *this, ii, handlers);
+    }
+
+    // Keep any trailing empty groups.
+    while(groupsCreated < static_cast<int>(numGroups())) {
+        auto g = group(groupsCreated++);
+        parser.group(std::string(g.name), std::string(g.description));
+    }
+
+    return parser;
+}
+
+std::string_view
+Schema::name() const
+{
+    return string(offsetof(Header, name));
+}
+
+std::string_view
+Schema::banner() const
+{
+    return string(offsetof(Header, banner));
+}
+
+std::string_view
+Schema::description() const
+{
+    return string(offsetof(Header, description));
+}
+
+std::string_view
+Schema::usage() const
+{
+    return string(offsetof(Header, usage));
+}
+
+bool
+Schema::passThrough() const
+{
+    return (read<Header>(0).flags & PassThroughFlag) != 0;
+}
+
+bool
+Schema::columnarResults() const
+{
+    return (read<Header>(0).flags & ColumnarResultsFlag) != 0;
+}
+
+std::size_t
+Schema::numGlobalOptions() const
+{
+    return read<Header>(0).numGlobalOptions;
+}
+
+std::size_t
+Schema::numOptions() const
+{
+    return read<Header>(0).options.count;
+}
+
+SchemaOption
+Schema::option(std::size_t index) const
+{
+    auto offset = read<Header>(0).options.offset + index * sizeof(OptionRecord);
+    auto rec = read<OptionRecord>(offset);
+
+    SchemaOption opt;
+    opt.longName = string(offset + offsetof(OptionRecord, longName));
+    opt.shortName = string(offset + offsetof(OptionRecord, shortName));
+    opt.description = string(offset + offsetof(OptionRecord, description));
+    opt.maxNumParams = rec.maxNumParams;
+    opt.minNumParams = rec.minNumParams;
+    opt.required = rec.required != 0;
+    opt.repeat = static_cast<RepeatPolicy>(rec.repeat);
+    opt.conflictsWith = SchemaNames(this, rec.conflictsWith.first, rec.conflictsWith.count);
+    opt.dependsOn = SchemaNames(this, rec.dependsOn.first, rec.dependsOn.count);
+    return opt;
+}
+
+std::size_t
+Schema::numCommands() const
+{
+    return read<Header>(0).commands.count;
+}
+
+SchemaCommand
+Schema::command(std::size_t index) const
+{
+    auto offset = read<Header>(0).commands.offset + index * sizeof(CommandRecord);
+    auto rec = read<CommandRecord>(offset);
+
+    SchemaCommand com;
+    com.name = string(offset + offsetof(CommandRecord, name));
+    com.description = string(offset + offsetof(CommandRecord, description));
+    com.kind = static_cast<SchemaCommandKind>(rec.kind);
+    com.group = rec.group;
+    com.firstOption = rec.options.first;
+    com.numOptions = rec.options.count;
+    return com;
+}
+
+std::optional<std::size_t>
+Schema::findCommand(std::string_view name) const
+{
+    auto index = read<Header>(0).commandIndex;
+    std::size_t low = 0;
+    std::size_t high = index.count;
+    while(low < high) {
+        auto mid = low + (high - low) / 2;
+        auto com = read<std::uint32_t>(index.offset + mid * sizeof(std::uint32_t));
+        auto comName = command(com).name;
+        if(comName == name) {
+            return com;
+        }
+
+        if(comName < name) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::size_t
+Schema::numGroups() const
+{
+    return read<Header>(0).groups.count;
+}
+
+SchemaGroup
+Schema::group(std::size_t index) const
+{
+    auto offset = read<Header>(0).groups.offset + index * sizeof(GroupRecord);
+    return {
+        string(offset + offsetof(GroupRecord, name)),
+        string(offset + offsetof(GroupRecord, description))
+    };
+}
+
+std::size_t
+Schema::numConstraints() const
+{
+    return read<Header>(0).constraints.count;
+}
+
+SchemaConstraint
+Schema::constraint(std::size_t index) const
+{
+    auto rec = read<ConstraintRecord>(read<Header>(0).constraints.offset + index * sizeof(ConstraintRecord));
+    return {static_cast<ConstraintType>(rec.type), SchemaNames(this, rec.options.first, rec.options.count)};
+}
+
+}
@@ -0,0 +1,289 @@
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <streambuf>
+
+#include <argunaught/server.hpp>
+
+#include "socket_io.hpp"
+#include "worker_pool.hpp"
+
+namespace argunaught
+{
+
+namespace
+{
+
+//! The server whose request the current thread is handling, if any.
+thread_local const CommandServer* handlingServer = nullptr;
+
+//! A stream buffer that forwards command output to a client as output messages.
+class SocketOutputBuffer : public std::streambuf
+{
+private:
+    int mFd;
+    char mBuffer[4096];
+    bool mFailed = false;
+
+    bool flushBuffer()
+    {
+        auto len = static_cast<std::uint32_t>(pptr() - pbase());
+        if(len == 0 || mFailed) {
+            setp(mBuffer, mBuffer + sizeof(mBuffer));
+            return !mFailed;
+        }
+
+        char header[1 + sizeof(len)];
+        header[0] = detail::OutputMessage;
+        std::memcpy(header + 1, &len, sizeof(len));
+
+        mFailed = !detail::writeAll(mFd, header, sizeof(header)) ||
+                  !detail::writeAll(mFd, pbase(), len);
+
+        setp(mBuffer, mBuffer + sizeof(mBuffer));
+        return !mFailed;
+    }
+
+protected:
+    int_type overflow(int_type ch) override
+    {
+        if(!flushBuffer()) return traits_type::eof();
+
+        if(!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override
+    {
+        return flushBuffer() ? 0 : -1;
+    }
+
+public:
+    explicit SocketOutputBuffer(int fd) : mFd(fd)
+    {
+        setp(mBuffer, mBuffer + sizeof(mBuffer));
+    }
+};
+
+}
+
+CommandServer::CommandServer(
+        const Parser& parser, 
+        std::string socketPath, 
+        ServerOptions opts
+    )
+    : mParser(parser),
+      mSocketPath(socketPath),
+      mOptions(opts)
+{
+    if(!mOptions.dispatch) {
+        mOptions.dispatch = [] (const ParseResult& result) {
+            return result.runCommand();
+        };
+    }
+}
+
+CommandServer::~CommandServer()
+{
+    stop();
+}
+
+void 
+CommandServer::start()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if(mRunning) return;
+
+    mListenFd = detail::listenUnixSocket(mSocketPath, mOptions.backlog);
+    if(mListenFd < 0) {
+        throw std::runtime_error("Unable to listen on command server socket: '" + mSocketPath + "'!");
+    }
+
+    if(!detail::openWakePipe(mWakeFds)) {
+        close(mListenFd);
+        mListenFd = -1;
+        throw std::runtime_error("Unable to create command server wake pipe!");
+    }
+
+    mWorkers = std::make_unique<detail::WorkerPool>(mOptions.numWorkers);
+    mRunning = true;
+    mAcceptThread = std::thread([this] { acceptLoop(); });
+}
+
+void 
+CommandServer::stop()
+{
+    // Stopping joins the worker threads, so a handler would be waiting on itself.
+    if(handlingServer == this) {
+        throw std::runtime_error("CommandServer::stop() can't be called from one of its request handlers!");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(!mRunning) return;
+        mRunning = false;
+    }
+
+    // Wake the accepting thread and let it exit.
+    char wake = 0;
+    detail::writeAll(mWakeFds[1], &wake, 1);
+    mAcceptThread.join();
+
+    // Destroying the pool finishes any requests already accepted.
+    mWorkers.reset();
+
+    close(mListenFd);
+    close(mWakeFds[0]);
+    close(mWakeFds[1]);
+    mListenFd = -1;
+    mWakeFds[0] = mWakeFds[1] = -1;
+
+    unlink(mSocketPath.c_str());
+    mStopped.notify_all();
+}
+
+void 
+CommandServer::wait()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mStopped.wait(lock, [this] { return !mRunning; });
+}
+
+bool 
+CommandServer::running()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRunning;
+}
+
+void 
+CommandServer::acceptLoop()
+{
+    pollfd fds[2] = {
+        {mListenFd, POLLIN, 0},
+        {mWakeFds[0], POLLIN, 0}
+    };
+
+    while(true) {
+        if(poll(fds, 2, -1) < 0) {
+            if(errno == EINTR) continue;
+            return;
+        }
+
+        // Asked to stop.
+        if(fds[1].revents != 0) return;
+
+        if(fds[0].revents & POLLIN) {
+            int conn = detail::acceptConnection(mListenFd);
+            if(conn < 0) continue;
+
+            mWorkers->post([this, conn] { handleConnection(conn); });
+        }
+    }
+}
+
+void 
+CommandServer::handleConnection(int fd)
+{
+    // A client that connects and then stalls mustn't hold a worker, or `stop()`, for long.
+    timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    handlingServer = this;
+
+    std::deque<std::string> args;
+    if(detail::readArgs(fd, args)) {
+        SocketOutputBuffer buffer(fd);
+        std::ostream out(&buffer);
+
+        std::int32_t exitCode = 0;
+        {
+            CommandOutputRedirect redirect(out);
+            SharedParsing shared;
+            try {
+                auto result = mParser.parse(args);
+                if(result.hasError()) {
+                    for(const auto& error : result.errors) {
+                        out << "error: " << describeParseError(error) << "\n";
+                    }
+                    exitCode = 1;
+                }
+                else {
+                    exitCode = mOptions.dispatch(result);
+                }
+            }
+            catch(const std::exception& e) {
+                out << "error: " << e.what() << "\n";
+                exitCode = 1;
+            }
+        }
+
+        out.flush();
+
+        char header[1 + sizeof(exitCode)];
+        header[0] = detail::ExitCodeMessage;
+        std::memcpy(header + 1, &exitCode, sizeof(exitCode));
+        detail::writeAll(fd, header, sizeof(header));
+    }
+
+    close(fd);
+    handlingServer = nullptr;
+}
+
+int 
+runRemoteCommand(
+        const std::string& socketPath, 
+        const std::deque<std::string>& args, 
+        std::ostream& out)
+{
+    int fd = detail::connectUnixSocket(socketPath);
+    if(fd < 0) {
+        throw std::runtime_error("Unable to connect to command server: '" + socketPath + "'!");
+    }
+
+    if(!detail::writeArgs(fd, args)) {
+        close(fd);
+        throw std::runtime_error("Unable to send command to server: '" + socketPath + "'!");
+    }
+
+    std::string chunk;
+    while(true) {
+        char type = 0;
+        if(!detail::readAll(fd, &type, 1)) break;
+
+        if(type == detail::OutputMessage) {
+            std::uint32_t len = 0;
+            if(!detail::readAll(fd, &len, sizeof(len))) break;
+
+            chunk.resize(len);
+            if(!detail::readAll(fd, chunk.data(), len)) break;
+
+            out.write(chunk.data(), len);
+            out.flush();
+        }
+        else if(type == detail::ExitCodeMessage) {
+            std::int32_t exitCode = 0;
+            if(!detail::readAll(fd, &exitCode, sizeof(exitCode))) break;
+
+            close(fd);
+            return exitCode;
+        }
+        else {
+            break;
+        }
+    }
+
+    close(fd);
+    throw std::runtime_error("Command server closed the connection before sending an exit code!");
+}
+
+}
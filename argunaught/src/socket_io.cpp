@@ -0,0 +1,315 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "socket_io.hpp"
+
+namespace argunaught
+{
+namespace detail
+{
+
+namespace
+{
+
+#ifdef MSG_NOSIGNAL
+constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+constexpr int SendFlags = 0;
+#endif
+
+// Descriptors are opened close-on-exec so they don't leak into anything a
+// command handler runs.
+#ifdef SOCK_CLOEXEC
+constexpr int SocketFlags = SOCK_CLOEXEC;
+#else
+constexpr int SocketFlags = 0;
+#endif
+
+#ifdef MSG_CMSG_CLOEXEC
+constexpr int ReceiveFlags = MSG_CMSG_CLOEXEC;
+#else
+constexpr int ReceiveFlags = 0;
+#endif
+
+//! Marks a descriptor close-on-exec, where it couldn't be created that way.
+int
+closeOnExec(int fd)
+{
+    if(fd >= 0) {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    return fd;
+}
+
+// Guards against allocating absurd amounts of memory for a corrupt request.
+constexpr std::uint32_t MaxArgCount = 1u << 24;
+constexpr std::uint32_t MaxArgLength = 1u << 26;
+
+//! The most a whole request may take, including the length prefixes.
+constexpr std::size_t MaxRequestSize = std::size_t(1) << 26;
+
+bool
+fillAddress(const std::string& path, sockaddr_un& addr)
+{
+    if(path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+//! Removes a socket file left over from a previous run.  Fails if the path 
+//! isn't a socket, or a server is still accepting connections on it.
+bool
+removeStaleSocket(const std::string& path, const sockaddr_un& addr)
+{
+    struct stat info;
+    if(lstat(path.c_str(), &info) != 0) {
+        return errno == ENOENT;
+    }
+
+    if(!S_ISSOCK(info.st_mode)) {
+        return false;
+    }
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SocketFlags, 0);
+    if(probe < 0) return false;
+
+    const bool live = connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    const bool refused = !live && errno == ECONNREFUSED;
+    close(probe);
+
+    return refused && unlink(path.c_str()) == 0;
+}
+
+}
+
+bool 
+writeAll(int fd, const void* data, std::size_t len)
+{
+    auto ptr = static_cast<const char*>(data);
+    while(len > 0) {
+        auto written = send(fd, ptr, len, SendFlags);
+        if(written < 0 && errno == ENOTSOCK) {
+            written = write(fd, ptr, len);
+        }
+
+        if(written < 0) {
+            if(errno == EINTR) continue;
+            return false;
+        }
+
+        ptr += written;
+        len -= static_cast<std::size_t>(written);
+    }
+
+    return true;
+}
+
+bool 
+readAll(int fd, void* data, std::size_t len)
+{
+    auto ptr = static_cast<char*>(data);
+    while(len > 0) {
+        auto amount = read(fd, ptr, len);
+        if(amount < 0) {
+            if(errno == EINTR) continue;
+            return false;
+        }
+
+        // End of stream before the full message arrived.
+        if(amount == 0) return false;
+
+        ptr += amount;
+        len -= static_cast<std::size_t>(amount);
+    }
+
+    return true;
+}
+
+bool 
+writeArgs(int fd, const std::deque<std::string>& args)
+{
+    std::string frame;
+    auto appendU32 = [&frame] (std::uint32_t val) {
+        frame.append(reinterpret_cast<const char*>(&val), sizeof(val));
+    };
+
+    appendU32(static_cast<std::uint32_t>(args.size()));
+    for(const auto& arg : args) {
+        appendU32(static_cast<std::uint32_t>(arg.size()));
+        frame += arg;
+    }
+
+    return writeAll(fd, frame.data(), frame.size());
+}
+
+bool 
+readArgs(int fd, std::deque<std::string>& args)
+{
+    std::uint32_t count = 0;
+    if(!readAll(fd, &count, sizeof(count)) || count > MaxArgCount) {
+        return false;
+    }
+
+    std::size_t total = sizeof(count);
+    for(std::uint32_t ii = 0; ii < count; ++ii) {
+        std::uint32_t len = 0;
+        if(!readAll(fd, &len, sizeof(len)) || len > MaxArgLength) {
+            return false;
+        }
+
+        total += sizeof(len) + len;
+        if(total > MaxRequestSize) {
+            return false;
+        }
+
+        std::string arg(len, '\0');
+        if(len > 0 && !readAll(fd, arg.data(), len)) {
+            return false;
+        }
+
+        args.push_back(std::move(arg));
+    }
+
+    return true;
+}
+
+int 
+listenUnixSocket(const std::string& path, int backlog)
+{
+    sockaddr_un addr;
+    if(!fillAddress(path, addr)) return -1;
+
+    if(!removeStaleSocket(path, addr)) return -1;
+
+    int fd = closeOnExec(socket(AF_UNIX, SOCK_STREAM | SocketFlags, 0));
+    if(fd < 0) return -1;
+
+    if(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+       listen(fd, backlog) != 0) 
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int 
+connectUnixSocket(const std::string& path)
+{
+    sockaddr_un addr;
+    if(!fillAddress(path, addr)) return -1;
+
+    int fd = closeOnExec(socket(AF_UNIX, SOCK_STREAM | SocketFlags, 0));
+    if(fd < 0) return -1;
+
+    if(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int 
+acceptConnection(int listenFd)
+{
+#ifdef SOCK_CLOEXEC
+    return accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+#else
+    return closeOnExec(accept(listenFd, nullptr, nullptr));
+#endif
+}
+
+bool 
+openWakePipe(int* fds)
+{
+    if(pipe(fds) != 0) {
+        return false;
+    }
+
+    closeOnExec(fds[0]);
+    closeOnExec(fds[1]);
+    return true;
+}
+
+bool 
+sendFds(int fd, const int* fds, std::size_t count)
+{
+    char payload = 'f';
+    iovec iov = {&payload, 1};
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * count), 0);
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * count);
+
+    while(true) {
+        auto sent = sendmsg(fd, &msg, SendFlags);
+        if(sent == 1) return true;
+        if(sent < 0 && errno == EINTR) continue;
+        return false;
+    }
+}
+
+bool 
+receiveFds(int fd, int* fds, std::size_t count)
+{
+    char payload = 0;
+    iovec iov = {&payload, 1};
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * count), 0);
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t received = 0;
+    do {
+        received = recvmsg(fd, &msg, ReceiveFlags);
+    } while(received < 0 && errno == EINTR);
+
+    cmsghdr* cmsg = received == 1 ? CMSG_FIRSTHDR(&msg) : nullptr;
+    if(cmsg == nullptr || 
+       cmsg->cmsg_level != SOL_SOCKET || 
+       cmsg->cmsg_type != SCM_RIGHTS ||
+       cmsg->cmsg_len != CMSG_LEN(sizeof(int) * count)) 
+    {
+        // Don't leak whatever descriptors did arrive.
+        if(cmsg != nullptr && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            const auto numFds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            std::vector<int> stray(numFds);
+            std::memcpy(stray.data(), CMSG_DATA(cmsg), numFds * sizeof(int));
+            for(auto el : stray) close(el);
+        }
+        return false;
+    }
+
+    std::memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * count);
+    return true;
+}
+
+} // detail
+}
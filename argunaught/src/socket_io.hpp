@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+namespace argunaught
+{
+namespace detail
+{
+
+//! Message tags used in command server responses.
+constexpr char OutputMessage = 'o';
+constexpr char ExitCodeMessage = 'x';
+constexpr char ErrorMessage = 'e';
+
+//! Writes the whole buffer, retrying on short writes.  Returns false on failure.
+bool writeAll(int fd, const void* data, std::size_t len);
+
+//! Reads exactly `len` bytes.  Returns false on failure or end of stream.
+bool readAll(int fd, void* data, std::size_t len);
+
+//! Writes an argument vector as a count followed by length prefixed strings.
+bool writeArgs(int fd, const std::deque<std::string>& args);
+
+//! Reads an argument vector written with `writeArgs`.  Fails if the request
+//! is larger than 64MiB in total.
+bool readArgs(int fd, std::deque<std::string>& args);
+
+//! Binds and listens on a Unix domain socket, replacing a stale socket file 
+//! that refuses connections.  Returns the listening fd or -1 on failure, 
+//! including when the path is some other kind of file or a live socket.
+int listenUnixSocket(const std::string& path, int backlog);
+
+//! Connects to a Unix domain socket, returning the fd or -1 on failure.
+int connectUnixSocket(const std::string& path);
+
+//! Accepts a connection on a listening socket, returning the fd or -1.
+int acceptConnection(int listenFd);
+
+//! Creates the pipe used to wake a serving loop.  Returns false on failure.
+bool openWakePipe(int* fds);
+
+//! Sends file descriptors over a Unix domain socket with `SCM_RIGHTS`.
+bool sendFds(int fd, const int* fds, std::size_t count);
+
+//! Receives exactly `count` file descriptors sent with `sendFds`.  Like the
+//! sockets opened here, they're close-on-exec.
+bool receiveFds(int fd, int* fds, std::size_t count);
+
+} // detail
+}
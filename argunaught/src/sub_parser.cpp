@@ -5,7 +5,7 @@ namespace argunaught
 
 SubParser::SubParser(
         std::string n, 
-        std::string h, 
+        HelpText h, 
         std::vector<Option> opt, 
         SubParserHandler f
     )
@@ -13,4 +13,14 @@ SubParser::SubParser(
 {
 }
 
+SubParser::SubParser(
+        std::string n, 
+        HelpText h, 
+        std::vector<Option> opt, 
+        SubParserCursorHandler f
+    )
+    : name(n), description(h), options(opt), cursorHandler(f)
+{
+}
+
 }
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace argunaught
+{
+namespace detail
+{
+
+//! A fixed size pool of threads running queued tasks in FIFO order.
+class WorkerPool
+{
+private:
+    std::vector<std::thread> mThreads;
+    std::deque<std::function<void()>> mTasks;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopping = false;
+
+    void workerLoop()
+    {
+        while(true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this] { return mStopping || !mTasks.empty(); });
+
+                // Drain anything still queued before exiting.
+                if(mTasks.empty()) return;
+
+                task = std::move(mTasks.front());
+                mTasks.pop_front();
+            }
+
+            task();
+        }
+    }
+
+public:
+    explicit WorkerPool(std::size_t numThreads)
+    {
+        if(numThreads == 0) numThreads = 1;
+
+        for(std::size_t ii = 0; ii < numThreads; ++ii) {
+            mThreads.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    //! Finishes all queued tasks and joins the worker threads.
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mCondition.notify_all();
+
+        for(auto& t : mThreads) {
+            t.join();
+        }
+    }
+
+    //! Queues a task to be run on the next free worker.
+    void post(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTasks.push_back(std::move(task));
+        }
+        mCondition.notify_one();
+    }
+};
+
+} // detail
+}
@@ -0,0 +1,267 @@
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include <argunaught/zygote.hpp>
+
+#include "socket_io.hpp"
+
+namespace argunaught
+{
+
+namespace
+{
+
+//! The number of descriptors passed with each request: stdin, stdout and stderr.
+constexpr std::size_t NumStdioFds = 3;
+
+//! How long the serving loop waits before reaping finished children again.
+constexpr int ReapIntervalMs = 200;
+
+void
+closeAll(const int* fds, std::size_t count)
+{
+    for(std::size_t ii = 0; ii < count; ++ii) {
+        if(fds[ii] >= 0) close(fds[ii]);
+    }
+}
+
+}
+
+Zygote::Zygote(const Parser& parser, std::string socketPath, ZygoteOptions opts)
+    : mParser(parser),
+      mSocketPath(socketPath),
+      mOptions(opts)
+{
+    if(!mOptions.dispatch) {
+        mOptions.dispatch = [] (const ParseResult& result) {
+            return result.runCommand();
+        };
+    }
+}
+
+Zygote::~Zygote()
+{
+    closeAll(mWakeFds, 2);
+    if(mListenFd >= 0) {
+        close(mListenFd);
+        unlink(mSocketPath.c_str());
+    }
+}
+
+void
+Zygote::run()
+{
+    if(mOptions.buildLazyCommands) {
+        mParser.buildLazyCommands();
+    }
+
+    if(mWakeFds[0] < 0 && !detail::openWakePipe(mWakeFds)) {
+        throw std::runtime_error("Unable to create zygote wake pipe!");
+    }
+
+    mListenFd = detail::listenUnixSocket(mSocketPath, mOptions.backlog);
+    if(mListenFd < 0) {
+        throw std::runtime_error("Unable to listen on zygote socket: '" + mSocketPath + "'!");
+    }
+
+    pollfd fds[2] = {
+        {mListenFd, POLLIN, 0},
+        {mWakeFds[0], POLLIN, 0}
+    };
+
+    while(true) {
+        reapChildren();
+
+        int ready = poll(fds, 2, ReapIntervalMs);
+        if(ready < 0) {
+            if(errno == EINTR) continue;
+            break;
+        }
+
+        // Asked to stop.
+        if(fds[1].revents != 0) break;
+
+        if(fds[0].revents & POLLIN) {
+            int conn = detail::acceptConnection(mListenFd);
+            if(conn < 0) continue;
+
+            handleRequest(conn);
+            close(conn);
+        }
+    }
+
+    close(mListenFd);
+    mListenFd = -1;
+    unlink(mSocketPath.c_str());
+    reapChildren();
+}
+
+void
+Zygote::stop()
+{
+    char wake = 1;
+    if(mWakeFds[1] >= 0) {
+        auto written = write(mWakeFds[1], &wake, 1);
+        (void)written;
+    }
+}
+
+void
+Zygote::reapChildren()
+{
+    auto finished = [] (pid_t pid) {
+        pid_t result = 0;
+        do {
+            result = waitpid(pid, nullptr, WNOHANG);
+        } while(result < 0 && errno == EINTR);
+
+        // Also drop children that can no longer be waited for.
+        return result != 0;
+    };
+
+    mChildren.erase(std::remove_if(mChildren.begin(), mChildren.end(), finished), mChildren.end());
+}
+
+void
+Zygote::handleRequest(int fd)
+{
+    // A client that connects and then stalls mustn't hold up other requests for long.
+    timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    int stdioFds[NumStdioFds] = {-1, -1, -1};
+    if(!detail::receiveFds(fd, stdioFds, NumStdioFds)) {
+        return;
+    }
+
+    std::deque<std::string> args;
+    if(!detail::readArgs(fd, args)) {
+        closeAll(stdioFds, NumStdioFds);
+        return;
+    }
+
+    // Anything still buffered would otherwise be written by every child too.
+    std::cout.flush();
+    std::cerr.flush();
+
+    pid_t pid = fork();
+    if(pid == 0) {
+        runChild(fd, stdioFds, args);
+    }
+    else if(pid > 0) {
+        mChildren.push_back(pid);
+    }
+    else {
+        // Tell the client rather than leaving it waiting for an exit code.
+        std::string error = std::strerror(errno);
+        auto len = static_cast<std::uint32_t>(error.size());
+        char header[1 + sizeof(len)];
+        header[0] = detail::ErrorMessage;
+        std::memcpy(header + 1, &len, sizeof(len));
+        if(detail::writeAll(fd, header, sizeof(header))) {
+            detail::writeAll(fd, error.data(), error.size());
+        }
+    }
+
+    closeAll(stdioFds, NumStdioFds);
+}
+
+void
+Zygote::runChild(int fd, const int* stdioFds, const std::deque<std::string>& args)
+{
+    close(mListenFd);
+    closeAll(mWakeFds, 2);
+
+    for(int ii = 0; ii < static_cast<int>(NumStdioFds); ++ii) {
+        dup2(stdioFds[ii], ii);
+    }
+    closeAll(stdioFds, NumStdioFds);
+
+    std::int32_t exitCode = 0;
+    try {
+        auto result = mParser.parse(args);
+        if(result.hasError()) {
+            for(const auto& error : result.errors) {
+                std::cerr << "error: " << describeParseError(error) << "\n";
+            }
+            exitCode = 1;
+        }
+        else {
+            exitCode = mOptions.dispatch(result);
+        }
+    }
+    catch(const std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        exitCode = 1;
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+
+    char message[1 + sizeof(exitCode)];
+    message[0] = detail::ExitCodeMessage;
+    std::memcpy(message + 1, &exitCode, sizeof(exitCode));
+    detail::writeAll(fd, message, sizeof(message));
+
+    // Skip the parent's atexit handlers and static destructors.
+    _exit(exitCode & 0xFF);
+}
+
+int
+runZygoteCommand(
+        const std::string& socketPath,
+        const std::deque<std::string>& args,
+        int inFd,
+        int outFd,
+        int errFd)
+{
+    int fd = detail::connectUnixSocket(socketPath);
+    if(fd < 0) {
+        throw std::runtime_error("Unable to connect to zygote: '" + socketPath + "'!");
+    }
+
+    const int stdioFds[NumStdioFds] = {inFd, outFd, errFd};
+    if(!detail::sendFds(fd, stdioFds, NumStdioFds) || !detail::writeArgs(fd, args)) {
+        close(fd);
+        throw std::runtime_error("Unable to send command to zygote: '" + socketPath + "'!");
+    }
+
+    char type = 0;
+    std::int32_t exitCode = 0;
+    bool gotType = detail::readAll(fd, &type, 1);
+
+    if(gotType && type == detail::ErrorMessage) {
+        std::uint32_t len = 0;
+        std::string error;
+        if(detail::readAll(fd, &len, sizeof(len)) && len <= 4096) {
+            error.resize(len);
+            if(len > 0 && !detail::readAll(fd, error.data(), len)) {
+                error.clear();
+            }
+        }
+
+        close(fd);
+        throw std::runtime_error("Zygote couldn't start the command: " + error);
+    }
+
+    bool gotExitCode = gotType &&
+                       type == detail::ExitCodeMessage &&
+                       detail::readAll(fd, &exitCode, sizeof(exitCode));
+    close(fd);
+
+    if(!gotExitCode) {
+        throw std::runtime_error("Zygote child exited without sending an exit code!");
+    }
+
+    return exitCode;
+}
+
+}
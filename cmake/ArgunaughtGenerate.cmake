@@ -0,0 +1,38 @@
+# argunaught_generate(<target> SCHEMA <file.json> [NAME <base_name>] [NAMESPACE <namespace>])
+#
+# Runs argunaught-gen on a JSON command line schema and compiles the generated
+# sources into <target>.  The generated header is `<base_name>.hpp`, which
+# defaults to the schema's file name without its extension, and is added to 
+# the target's include path.  The code is generated again whenever the schema
+# changes.  <target> must link against argunaught itself, with whichever
+# target_link_libraries() signature it already uses.
+function(argunaught_generate target)
+    cmake_parse_arguments(ARG "" "SCHEMA;NAME;NAMESPACE" "" ${ARGN})
+
+    if(NOT ARG_SCHEMA)
+        message(FATAL_ERROR "argunaught_generate: SCHEMA is required")
+    endif()
+
+    get_filename_component(schema "${ARG_SCHEMA}" ABSOLUTE)
+    if(NOT ARG_NAME)
+        get_filename_component(ARG_NAME "${schema}" NAME_WE)
+    endif()
+    if(NOT ARG_NAMESPACE)
+        set(ARG_NAMESPACE ${ARG_NAME})
+    endif()
+
+    set(out_dir ${CMAKE_CURRENT_BINARY_DIR}/argunaught_generated/${target})
+    set(outputs ${out_dir}/${ARG_NAME}.hpp ${out_dir}/${ARG_NAME}.cpp)
+
+    add_custom_command(
+        OUTPUT ${outputs}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${out_dir}
+        COMMAND argunaught-gen --output ${out_dir}/${ARG_NAME} --namespace ${ARG_NAMESPACE} ${schema}
+        DEPENDS argunaught-gen ${schema}
+        COMMENT "Generating ${ARG_NAME} from ${ARG_SCHEMA}"
+        VERBATIM
+      )
+
+    target_sources(${target} PRIVATE ${outputs})
+    target_include_directories(${target} PUBLIC ${out_dir})
+endfunction()
@@ -0,0 +1,28 @@
+// A tiny client for a parser served with `argunaught::CommandServer`.
+//
+// Usage: command_client <socket path> [command line arguments...]
+
+#include <argunaught/server.hpp>
+#include <iostream>
+#include <stdio.h>
+
+int main(int argc, const char* argv[])
+{
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s <socket path> [args...]\n", argv[0]);
+        return 1;
+    }
+
+    std::deque<std::string> args;
+    for(int ii = 2; ii < argc; ++ii) {
+        args.emplace_back(argv[ii]);
+    }
+
+    try {
+        return argunaught::runRemoteCommand(argv[1], args, std::cout);
+    }
+    catch(const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,23 @@
+#include <argunaught/plugins.hpp>
+
+// A plugin used by the unit tests, providing one command and one subparser.
+ARGUNAUGHT_PLUGIN(parser)
+{
+    parser
+        .command("hello", "Says hello\nto whoever is named.", 
+            {{"name", "n", "Who to greet", 1}},
+            [] (auto& parseResult) -> int 
+            {
+                argunaught::commandOutput() << "Hello " << parseResult.getOption("name", "world").values[0] << "\n";
+                return 7;
+            })
+        .cursorSubParser("remote", "Manages remotes",
+            [] (const auto& parent, auto& args, auto& result) 
+            {
+                static auto remote = argunaught::Parser("remote")
+                    .command("add", "Adds a remote", {}, 
+                        [] (auto& parseResult) -> int { return 3; });
+
+                remote.parseInto(args, result);
+            });
+}
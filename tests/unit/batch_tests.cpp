@@ -0,0 +1,168 @@
+#include "catch2/catch.hpp"
+#include <argunaught/batch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+TEST_CASE( "Test batch script runner", "[batch]" ) {
+    std::atomic<int> runCount{0};
+    auto argu = argunaught::Parser("Cool Test App")
+        .command("say", "Writes its positional arguments", 
+            {
+                {"delay", "d", "Milliseconds to sleep first", 1}
+            },
+            [&runCount] (auto& parseResult) -> int 
+            {
+                runCount++;
+                auto delay = std::stoi(parseResult.getOption("delay", "0").values[0]);
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+                auto& out = argunaught::commandOutput();
+                for(auto& arg : parseResult.positionalArgs) {
+                    out << arg << ";";
+                }
+                out << "\n";
+                return 0;
+            })
+        .command("fail", "Returns its first positional argument", 
+            [&runCount] (auto& parseResult) -> int 
+            {
+                runCount++;
+                argunaught::commandOutput() << "failing\n";
+                return std::stoi(parseResult.positionalArgs[0]);
+            });
+
+    argunaught::BatchOptions opts;
+    opts.numThreads = 4;
+
+    SECTION( "Output should be written in script order") {
+        std::istringstream script(
+            "# A comment line\n"
+            "say -d 30 one 'two three'\n"
+            "\n"
+            "say -d 0 four\n"
+            "say -d 10 five\n"
+            "say six # trailing comment\n"
+        );
+
+        std::ostringstream out;
+        auto result = argunaught::runBatch(argu, script, out, opts);
+        REQUIRE(out.str() == "one;two three;\nfour;\nfive;\nsix;\n");
+        REQUIRE(result.commandsRun == 4);
+        REQUIRE(result.commandsFailed == 0);
+        REQUIRE(result.exitCode == 0);
+        REQUIRE(result.firstFailedLine == 0);
+    }
+
+    SECTION( "Failures should be aggregated without stopping") {
+        std::istringstream script(
+            "say a\n"
+            "fail 3\n"
+            "say b\n"
+            "fail 4\n"
+            "unknown\n"
+        );
+
+        std::ostringstream out;
+        auto result = argunaught::runBatch(argu, script, out, opts);
+        REQUIRE(out.str() == "a;\nfailing\nb;\nfailing\n");
+        REQUIRE(result.commandsRun == 5);
+        REQUIRE(result.commandsFailed == 3);
+        REQUIRE(result.exitCode == 3);
+        REQUIRE(result.firstFailedLine == 2);
+    }
+
+    SECTION( "Parse errors should be reported without running the command") {
+        std::istringstream script(
+            "say a\n"
+            "say --bogus b\n"
+            "say c\n"
+        );
+
+        std::ostringstream out;
+        auto result = argunaught::runBatch(argu, script, out, opts);
+        REQUIRE(out.str() == "a;\nerror: unknown option: bogus\nc;\n");
+        REQUIRE(runCount == 2);
+        REQUIRE(result.commandsFailed == 1);
+        REQUIRE(result.exitCode == 1);
+        REQUIRE(result.firstFailedLine == 2);
+    }
+
+    SECTION( "Options bound to a variable should be refused") {
+        int level = 0;
+        auto bound = argunaught::Parser("Bound")
+            .options({argunaught::Option{"level", "l", "A level", 1, 1}.bindTo(level)})
+            .command("noop", "Does nothing", [] (auto& parseResult) -> int { return 0; });
+
+        std::istringstream script("noop\n-l 2 noop\n");
+        std::ostringstream out;
+        auto result = argunaught::runBatch(bound, script, out, opts);
+        REQUIRE(out.str().find("error: Option 'level' is bound") == 0);
+        REQUIRE(result.commandsFailed == 1);
+        REQUIRE(result.firstFailedLine == 2);
+        REQUIRE(level == 0);
+    }
+
+    SECTION( "Continued lines and open quotes should join the next line") {
+        std::istringstream script(
+            "say one \\\n"
+            "    two\n"
+            "say 'three\n"
+            "four'\n"
+            "fail 5\n"
+            "say \"never closed\n"
+        );
+
+        std::ostringstream out;
+        auto result = argunaught::runBatch(argu, script, out, opts);
+        REQUIRE(out.str().find("one;two;\nthree\nfour;\nfailing\nerror: ") == 0);
+        REQUIRE(result.commandsRun == 4);
+        REQUIRE(result.commandsFailed == 2);
+        REQUIRE(result.exitCode == 5);
+        REQUIRE(result.firstFailedLine == 5);
+    }
+
+    SECTION( "Fail fast should stop after the first failure") {
+        std::string text = "say -d 20 first\nfail 7\n";
+        for(int ii = 0; ii < 1000; ii++) {
+            text += "say later\n";
+        }
+
+        std::istringstream script(text);
+        std::ostringstream out;
+        opts.failFast = true;
+        opts.maxInFlight = 8;
+        auto result = argunaught::runBatch(argu, script, out, opts);
+        REQUIRE(out.str() == "first;\nfailing\n");
+        REQUIRE(result.commandsRun == 2);
+        REQUIRE(result.commandsFailed == 1);
+        REQUIRE(result.exitCode == 7);
+        REQUIRE(result.firstFailedLine == 2);
+        REQUIRE(runCount < 100);
+    }
+
+    SECTION( "Many lines should all be run in order") {
+        std::string text;
+        std::string expected;
+        for(int ii = 0; ii < 5000; ii++) {
+            text += "say " + std::to_string(ii) + "\n";
+            expected += std::to_string(ii) + ";\n";
+        }
+
+        std::istringstream script(text);
+        std::ostringstream out;
+        opts.maxInFlight = 64;
+        auto result = argunaught::runBatch(argu, script, out, opts);
+        REQUIRE(result.commandsRun == 5000);
+        REQUIRE(out.str() == expected);
+    }
+
+    SECTION( "A missing script file should throw") {
+        std::ostringstream out;
+        REQUIRE_THROWS_AS(
+            argunaught::runBatchFile(argu, "/nonexistent/script.txt", out, opts), 
+            std::runtime_error);
+    }
+}
@@ -0,0 +1,98 @@
+#include "catch2/catch.hpp"
+#include <argunaught/argunaught.hpp>
+
+TEST_CASE( "Test columnar parse results", "[columnar]" ) {
+    auto argu = argunaught::Parser("Cool Test App")
+        .columnarResults()
+        .options({
+            {"global", "g", "A global option", 1},
+            {"flag", "f", "A flag", 0}
+        })
+        .command("sub", "Unit test sub-command", 
+            {
+                {"list", "l", "A list of things", -1}
+            },
+            [] (auto& parseResult) -> int { return 0; });
+
+    SECTION( "Options and positional args should be stored in columns") {
+        auto parseResult = argu.parseCommandLine("-g one -f sub --list a b c -- x y");
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.hasColumns());
+        REQUIRE(parseResult.options.empty());
+        REQUIRE(parseResult.positionalArgs.empty());
+
+        const auto& columns = parseResult.columns;
+        REQUIRE(columns.size() == 6);
+
+        const auto& records = columns.optionRecords();
+        REQUIRE(records.size() == 3);
+        REQUIRE(records[0].optionId == 0);
+        REQUIRE(columns.optionName(records[0]) == "global");
+        REQUIRE(columns.values(records[0]).size() == 1);
+        REQUIRE(columns.values(records[0])[0] == "one");
+
+        REQUIRE(records[1].optionId == 1);
+        REQUIRE(columns.values(records[1]).empty());
+
+        // Command option ids follow the global options.
+        REQUIRE(records[2].optionId == 2);
+        REQUIRE(columns.optionName(records[2]) == "list");
+        std::vector<std::string_view> listValues;
+        for(auto val : columns.values(records[2])) {
+            listValues.push_back(val);
+        }
+        REQUIRE(listValues == std::vector<std::string_view>{"a", "b", "c"});
+
+        auto positionals = columns.positionalArgs();
+        REQUIRE(positionals.size() == 2);
+        REQUIRE(positionals[0] == "x");
+        REQUIRE(positionals[1] == "y");
+    }
+
+    SECTION( "Option helpers should look in the columns") {
+        auto parseResult = argu.parseCommandLine("-g one sub -l a b");
+        REQUIRE(parseResult.hasOption("global"));
+        REQUIRE(!parseResult.hasOption("flag"));
+        REQUIRE(parseResult.getOption("list")->values == std::vector<std::string>{"a", "b"});
+        REQUIRE(parseResult.getOption("flag", "default").values[0] == "default");
+
+        auto options = parseResult.optionResults();
+        REQUIRE(options.size() == 2);
+        REQUIRE(options[0].optionName == "global");
+    }
+
+    SECTION( "Many positional args should share one pool") {
+        std::deque<std::string> args = {"sub", "--"};
+        for(int ii = 0; ii < 100000; ii++) {
+            args.push_back("file_" + std::to_string(ii) + ".txt");
+        }
+
+        auto parseResult = argu.parse(args);
+        auto positionals = parseResult.columns.positionalArgs();
+        REQUIRE(positionals.size() == 100000);
+
+        std::size_t count = 0;
+        for(auto val : positionals) {
+            if(val == "file_" + std::to_string(count) + ".txt") count++;
+        }
+        REQUIRE(count == 100000);
+        REQUIRE(parseResult.positionalArgStrings().size() == 100000);
+    }
+
+    SECTION( "Sub parsers should still receive the options found") {
+        std::vector<std::string> seen;
+        auto parent = argunaught::Parser("Parent")
+            .columnarResults()
+            .options({{"global", "g", "A global option", 1}})
+            .subParser("nested", "A nested parser",
+                [&seen] (const auto& parser, auto optionResults, auto args) -> argunaught::ParseResult
+                {
+                    for(auto& opt : optionResults) seen.push_back(opt.optionName);
+                    return argunaught::Parser("Child").options(parser.options()).parse(args, optionResults);
+                });
+
+        auto parseResult = parent.parseCommandLine("-g 1 nested");
+        REQUIRE(seen == std::vector<std::string>{"global"});
+        REQUIRE(parseResult.getOption("global")->values[0] == "1");
+    }
+}
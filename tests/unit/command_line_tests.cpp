@@ -0,0 +1,127 @@
+#include "catch2/catch.hpp"
+#include <argunaught/argunaught.hpp>
+
+namespace
+{
+
+std::vector<std::string> 
+words(std::string_view commandLine)
+{
+    auto tokens = argunaught::tokenizeCommandLine(commandLine);
+    REQUIRE(!tokens.hasError());
+
+    std::vector<std::string> result;
+    for(std::size_t ii = 0; ii < tokens.size(); ii++) {
+        result.emplace_back(tokens[ii]);
+    }
+    return result;
+}
+
+}
+
+TEST_CASE( "Test command line tokenizer", "[command-line]" ) {
+
+    SECTION( "Words should be split on whitespace") {
+        REQUIRE(words("") == std::vector<std::string>{});
+        REQUIRE(words("   \t\n ") == std::vector<std::string>{});
+        REQUIRE(words("sub -a  one\ttwo\n three ") == 
+                std::vector<std::string>{"sub", "-a", "one", "two", "three"});
+    }
+
+    SECTION( "Single quotes should be literal") {
+        REQUIRE(words(R"('hello world' 'a\b' 'x"y')") == 
+                std::vector<std::string>{"hello world", R"(a\b)", R"(x"y)"});
+    }
+
+    SECTION( "Double quotes should only allow a few escapes") {
+        REQUIRE(words(R"("hello world" "a\"b" "c\\d" "e\f" "$\$")") == 
+                std::vector<std::string>{"hello world", R"(a"b)", R"(c\d)", R"(e\f)", "$$"});
+    }
+
+    SECTION( "Quoted sections should join with adjacent text") {
+        REQUIRE(words(R"(--name="John Smith" a'b'"c"d '' "")") == 
+                std::vector<std::string>{"--name=John Smith", "abcd", "", ""});
+    }
+
+    SECTION( "Backslashes should escape outside of quotes") {
+        REQUIRE(words(R"(a\ b \'c\' d\\e)") == 
+                std::vector<std::string>{"a b", "'c'", R"(d\e)"});
+        REQUIRE(words("one\\\ntwo") == std::vector<std::string>{"onetwo"});
+    }
+
+    SECTION( "A line continuation between words shouldn't make an empty word") {
+        REQUIRE(words("a \\\n b") == std::vector<std::string>{"a", "b"});
+        REQUIRE(words("cmd --opt \\\n    value \\\n") == 
+                std::vector<std::string>{"cmd", "--opt", "value"});
+        REQUIRE(words("a \\\n\\\n'' b") == std::vector<std::string>{"a", "", "b"});
+    }
+
+    SECTION( "A # should only start a comment at the beginning of a word") {
+        REQUIRE(words("run a#b # a comment\nnext #more") == 
+                std::vector<std::string>{"run", "a#b", "next"});
+    }
+
+    SECTION( "Long lines should split the same as short ones") {
+        std::string line;
+        std::vector<std::string> expected;
+        for(int ii = 0; ii < 200; ii++) {
+            auto word = "word_number_" + std::to_string(ii);
+            line += (ii % 3 == 0) ? "'" + word + " q'  " : word + "\t";
+            expected.push_back((ii % 3 == 0) ? word + " q" : word);
+        }
+        REQUIRE(words(line) == expected);
+    }
+
+    SECTION( "Unterminated quotes should be an error") {
+        auto tokens = argunaught::tokenizeCommandLine(R"(one "two three)");
+        REQUIRE(tokens.hasError());
+        REQUIRE(tokens.error()->type == argunaught::ParseErrorType::UnterminatedQuote);
+        REQUIRE(tokens.error()->pos == 1);
+        REQUIRE(tokens.error()->value == "two three");
+
+        tokens = argunaught::tokenizeCommandLine("one 'two");
+        REQUIRE(tokens.hasError());
+        REQUIRE(tokens.error()->type == argunaught::ParseErrorType::UnterminatedQuote);
+    }
+
+    SECTION( "A trailing backslash should be an error") {
+        auto tokens = argunaught::tokenizeCommandLine("one two\\");
+        REQUIRE(tokens.hasError());
+        REQUIRE(tokens.error()->type == argunaught::ParseErrorType::TrailingEscape);
+        REQUIRE(tokens.error()->pos == 1);
+    }
+}
+
+TEST_CASE( "Test parsing a command line string", "[command-line]" ) {
+    auto argu = argunaught::Parser("Cool Test App")
+        .options({
+            {"global", "g", "A global option", 1}
+        })
+        .command("sub", "Unit test sub-command", 
+            {
+                {"name", "n", "A name", 1}
+            },
+            [] (auto& parseResult) -> int { return 0; });
+
+    SECTION( "Should parse the same as pre-split arguments") {
+        auto parseResult = argu.parseCommandLine(R"(-g 'global value' sub --name "John \"JJ\" Smith" pos\ one two)");
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.hasCommand());
+        REQUIRE(parseResult.getOption("global")->values[0] == "global value");
+        REQUIRE(parseResult.getOption("name")->values[0] == R"(John "JJ" Smith)");
+        REQUIRE(parseResult.positionalArgs == std::vector<std::string>{"pos one", "two"});
+    }
+
+    SECTION( "Tokenizer errors should be reported as parse errors") {
+        auto parseResult = argu.parseCommandLine("sub 'oops");
+        REQUIRE(parseResult.hasError());
+        REQUIRE(parseResult.errors[0].type == argunaught::ParseErrorType::UnterminatedQuote);
+        REQUIRE(!parseResult.hasCommand());
+    }
+
+    SECTION( "Braced argument lists still parse as pre-split arguments") {
+        auto parseResult = argu.parse({"sub", "-n", "a b"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.getOption("name")->values[0] == "a b");
+    }
+}
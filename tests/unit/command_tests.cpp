@@ -1,6 +1,9 @@
 #include "catch2/catch.hpp"
 #include <argunaught/argunaught.hpp>
 
+#include <atomic>
+#include <thread>
+
 TEST_CASE( "Test commands", "[command]" ) {
     int counter = 0;
     auto argu = argunaught::Parser("Cool Test App")
@@ -180,3 +183,158 @@ TEST_CASE( "Test various command conditions", "[command]" ) {
     }
 }
 
+
+TEST_CASE( "Test lazy commands", "[command]" ) {
+    std::atomic<int> built{0};
+    int counter = 0;
+    auto factory = [&built, &counter] (std::string name) {
+        return [&built, &counter, name] () {
+            built++;
+            return std::make_shared<argunaught::Command>(name, "The full description of " + name, 
+                std::vector<argunaught::Option>{{"fast", "f", "Run quickly", 0, 0, true}},
+                [&counter] (auto& parseResult) -> int 
+                { 
+                    counter = 100;
+                    return 0;
+                });
+        };
+    };
+
+    auto argu = argunaught::Parser("Cool Test App")
+        .lazyCommand("build", "Builds things", factory("build"))
+        .lazyCommand("clean", "Cleans things", factory("clean"))
+        .group("More", "Grouped lazy commands")
+            .lazyCommand("deploy", "Deploys things", factory("deploy"))
+        .endGroup();
+
+    SECTION( "Only the dispatched command is built") {
+        const char* args[] = {"test", "build", "-f"};
+        auto parseResult = argu.parse(3, args);
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(built == 1);
+        REQUIRE(parseResult.command->name == "build");
+        REQUIRE(parseResult.hasOption("fast"));
+
+        parseResult.runCommand();
+        REQUIRE(counter == 100);
+
+        argu.parse(3, args);
+        REQUIRE(built == 1);
+    }
+
+    SECTION( "Constraints of a built command are checked") {
+        auto parseResult = argu.parseCommandLine("deploy");
+        REQUIRE(parseResult.hasError());
+        REQUIRE(parseResult.errors[0].type == argunaught::ParseErrorType::MissingRequiredOption);
+    }
+
+    SECTION( "Main help only shows the short help") {
+        auto help = argunaught::DefaultHelpFormatter(argu, {}, true).helpString();
+        REQUIRE(help.find("Builds things") != std::string::npos);
+        REQUIRE(help.find("Deploys things") != std::string::npos);
+        REQUIRE(built == 0);
+    }
+
+    SECTION( "Command help builds the command") {
+        auto help = argunaught::DefaultHelpFormatter(argu, {}, true).commandHelpString("clean");
+        REQUIRE(help.find("The full description of clean") != std::string::npos);
+        REQUIRE(help.find("--fast") != std::string::npos);
+        REQUIRE(built == 1);
+    }
+
+    SECTION( "Concurrent parses build a command once") {
+        std::vector<std::thread> threads;
+        for(int ii = 0; ii < 8; ++ii) {
+            threads.emplace_back([&argu] {
+                const char* args[] = {"test", "clean", "-f"};
+                argu.parse(3, args);
+            });
+        }
+
+        for(auto& t : threads) t.join();
+        REQUIRE(built == 1);
+    }
+
+    SECTION( "Lazy command names must be unique") {
+        argu.lazyCommand("build", "Again", factory("build"));
+        argu.command("clean", "Eager", [] (auto& parseResult) -> int { return 0; });
+        REQUIRE(argu.parserConfigErrors().size() == 2);
+    }
+}
+
+TEST_CASE( "Test peeking at the command", "[command]" ) {
+    auto argu = argunaught::Parser("Cool Test App")
+        .options({
+            {"verbose", "v", "Verbose output", 0},
+            {"config", "c", "A config file", 1},
+        })
+        .command("build", "Builds things", 
+            {{"fast", "f", "Build quickly", 0}},
+            [] (auto& parseResult) -> int { return 0; })
+        .lazyCommand("deploy", "Deploys things", [] () -> argunaught::CommandPtr { return nullptr; })
+        .subParser("remote", "Manages remotes", 
+            [] (const auto& parser, auto optionResults, auto args) { return argunaught::ParseResult(); });
+
+    SECTION( "Global options are skipped and reported") {
+        const char* args[] = {"app", "-v", "--config", "a.cfg", "build", "-f", "x"};
+        std::vector<std::pair<std::string, int>> seen;
+        auto peeked = argu.peek(7, args, [&seen] (const auto& option, int index, int numValues) {
+            seen.push_back({option.longName, numValues});
+        });
+
+        REQUIRE(peeked.found());
+        REQUIRE(peeked.name == "build");
+        REQUIRE(peeked.command->name == "build");
+        REQUIRE(peeked.commandIndex == 4);
+        REQUIRE(peeked.argsIndex == 5);
+        REQUIRE(seen == std::vector<std::pair<std::string, int>>{{"verbose", 0}, {"config", 1}});
+    }
+
+    SECTION( "Lazy commands aren't built and subparsers are found") {
+        const char* lazyArgs[] = {"app", "deploy", "now"};
+        auto peeked = argu.peek(3, lazyArgs);
+        REQUIRE(peeked.found());
+        REQUIRE(peeked.lazyCommand);
+        REQUIRE(peeked.command == nullptr);
+
+        const char* subArgs[] = {"app", "remote", "add"};
+        peeked = argu.peek(3, subArgs);
+        REQUIRE(peeked.subParser->name == "remote");
+        REQUIRE(peeked.argsIndex == 2);
+    }
+
+    SECTION( "Unknown options are skipped the same way parsing skips them") {
+        const char* args[] = {"app", "--bogus", "build", "-f"};
+        auto peeked = argu.peek(4, args);
+        auto parsed = argu.parse(4, args);
+        REQUIRE(parsed.hasError());
+        REQUIRE(parsed.command->name == "build");
+        REQUIRE(peeked.found());
+        REQUIRE(peeked.command == parsed.command);
+        REQUIRE(peeked.commandIndex == 2);
+    }
+
+    SECTION( "Inherited options are skipped along with their values") {
+        auto child = argunaught::Parser("Child")
+            .inheritOptions(argu)
+            .command("status", "Shows the status", [] (auto& parseResult) -> int { return 0; });
+
+        const char* args[] = {"app", "--config", "a.cfg", "status"};
+        std::vector<std::string> seen;
+        auto peeked = child.peek(4, args, [&seen] (const auto& option, int index, int numValues) {
+            seen.push_back(option.longName);
+        });
+
+        REQUIRE(peeked.name == "status");
+        REQUIRE(peeked.commandIndex == 3);
+        REQUIRE(seen == std::vector<std::string>{"config"});
+        REQUIRE(child.parse(4, args).command == peeked.command);
+    }
+
+    SECTION( "No command gives the start of the positional arguments") {
+        const char* args[] = {"app", "-v", "file.txt"};
+        auto peeked = argu.peek(3, args);
+        REQUIRE(!peeked.found());
+        REQUIRE(peeked.argsIndex == 2);
+    }
+}
@@ -0,0 +1,160 @@
+#include "catch2/catch.hpp"
+#include <argunaught/argunaught.hpp>
+
+using argunaught::ParseErrorType;
+
+TEST_CASE( "Test option constraints", "[constraints]" ) {
+    argunaught::Option output{"output", "o", "Where to write", 1};
+    output.required = true;
+
+    argunaught::Option json{"json", "j", "Write json", 0};
+    json.conflictsWith = {"csv"};
+
+    argunaught::Option user{"user", "u", "User name", 1};
+    user.dependsOn = {"password"};
+
+    argunaught::Option range{"range", "r", "A numeric range", 2};
+    range.minNumParams = 2;
+
+    argunaught::Option name{"name", "n", "Required for the command", 1};
+    name.required = true;
+
+    auto argu = argunaught::Parser("Cool Test App")
+        .options({
+            output, json, user, range,
+            {"csv", "c", "Write csv", 0},
+            {"password", "p", "A password", 1},
+            {"quiet", "q", "Less output", 0},
+            {"verbose", "v", "More output", 0},
+        })
+        .constraints({
+            {argunaught::ConstraintType::MutuallyExclusive, {"quiet", "verbose"}},
+        })
+        .command("create", "Needs a name", 
+            {name},
+            [] (auto& parseResult) -> int { return 0; })
+        .group("Other")
+            .command("list", "Needs a filter", 
+                {
+                    {"all", "a", "Everything", 0},
+                    {"filter", "f", "A filter", 1},
+                },
+                [] (auto& parseResult) -> int { return 0; })
+        .endGroup()
+        .constraints({
+            {argunaught::ConstraintType::AtLeastOne, {"output", "csv"}},
+        });
+
+    REQUIRE(!argu.hasConfigurationError());
+
+    SECTION( "Satisfied constraints should not add errors") {
+        auto parseResult = argu.parseCommandLine("-o out.txt -u bob -p secret -r 1 2 create -n thing");
+        REQUIRE(!parseResult.hasError());
+    }
+
+    SECTION( "Required options should be reported when missing") {
+        auto parseResult = argu.parseCommandLine("-q");
+        REQUIRE(parseResult.errors.size() == 2);
+        REQUIRE(parseResult.errors[0].type == ParseErrorType::MissingRequiredOption);
+        REQUIRE(parseResult.errors[0].value == "output");
+        REQUIRE(parseResult.errors[0].pos == -1);
+
+        // The at least one constraint is also unsatisfied.
+        REQUIRE(parseResult.errors[1].type == ParseErrorType::MissingRequiredOption);
+        REQUIRE(parseResult.errors[1].value == "output | csv");
+
+        parseResult = argu.parseCommandLine("-c");
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].value == "output");
+    }
+
+    SECTION( "Command option constraints should only apply to that command") {
+        auto parseResult = argu.parseCommandLine("-o x create");
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].type == ParseErrorType::MissingRequiredOption);
+        REQUIRE(parseResult.errors[0].value == "name");
+
+        parseResult = argu.parseCommandLine("-o x list");
+        REQUIRE(!parseResult.hasError());
+    }
+
+    SECTION( "Conflicting options should be reported") {
+        auto parseResult = argu.parseCommandLine("-o x --json --csv");
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].type == ParseErrorType::ConflictingOptions);
+        REQUIRE(parseResult.errors[0].value == "json, csv");
+
+        parseResult = argu.parseCommandLine("-o x -v -q");
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].type == ParseErrorType::ConflictingOptions);
+        REQUIRE(parseResult.errors[0].value == "quiet, verbose");
+    }
+
+    SECTION( "Missing dependencies should be reported") {
+        auto parseResult = argu.parseCommandLine("-o x -u bob");
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].type == ParseErrorType::MissingDependentOption);
+        REQUIRE(parseResult.errors[0].value == "password");
+    }
+
+    SECTION( "At least one of a group should be required") {
+        argunaught::Option optional = output;
+        optional.required = false;
+        auto other = argunaught::Parser("Other")
+            .options({optional, {"csv", "c", "Write csv", 0}})
+            .constraints({
+                {argunaught::ConstraintType::AtLeastOne, {"output", "csv"}},
+            });
+
+        auto parseResult = other.parse(std::deque<std::string>{});
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].type == ParseErrorType::MissingRequiredOption);
+        REQUIRE(parseResult.errors[0].value == "output | csv");
+
+        parseResult = other.parseCommandLine("-c");
+        REQUIRE(!parseResult.hasError());
+    }
+
+    SECTION( "Too few option parameters should be reported") {
+        auto parseResult = argu.parseCommandLine("-o x --range 1");
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].type == ParseErrorType::TooFewOptionParams);
+        REQUIRE(parseResult.errors[0].value == "range");
+        REQUIRE(parseResult.errors[0].pos == 3);
+    }
+
+    SECTION( "Constraints on unknown options should be configuration errors") {
+        argunaught::Option bad{"bad", "b", "Depends on nothing", 0};
+        bad.dependsOn = {"missing"};
+        auto other = argunaught::Parser("Other")
+            .options({bad})
+            .command("com", "A command", 
+                {{"thing", "t", "Conflicts with nothing", 0, 0, false, {"nope"}}},
+                [] (auto& parseResult) -> int { return 0; });
+
+        REQUIRE(other.hasConfigurationError());
+        auto errors = other.parserConfigErrors();
+        REQUIRE(errors.size() == 2);
+        REQUIRE(errors[0].type == argunaught::ParserConfigErrorType::UnknownConstraintOption);
+        REQUIRE(errors[1].type == argunaught::ParserConfigErrorType::UnknownConstraintOption);
+    }
+}
+
+TEST_CASE( "Test many options in a constraint mask", "[constraints]" ) {
+    std::vector<argunaught::Option> options;
+    std::vector<std::string> names;
+    for(int ii = 0; ii < 150; ii++) {
+        names.push_back("opt" + std::to_string(ii));
+        options.push_back({names.back(), "", "", 0});
+    }
+
+    auto argu = argunaught::Parser("Big App")
+        .options(options)
+        .constraints({{argunaught::ConstraintType::MutuallyExclusive, {"opt3", "opt70", "opt140"}}});
+
+    REQUIRE(!argu.parseCommandLine("--opt3 --opt69 --opt141").hasError());
+
+    auto parseResult = argu.parseCommandLine("--opt70 --opt140");
+    REQUIRE(parseResult.errors.size() == 1);
+    REQUIRE(parseResult.errors[0].value == "opt70, opt140");
+}
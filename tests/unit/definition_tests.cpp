@@ -0,0 +1,114 @@
+#include "catch2/catch.hpp"
+#include <argunaught/argunaught.hpp>
+
+#include <sstream>
+
+TEST_CASE( "Test JSON writer", "[definition]" ) {
+    std::ostringstream out;
+    argunaught::JsonWriter json(out);
+
+    SECTION( "Members and elements are separated by commas") {
+        json.beginObject()
+            .member("name", "tool")
+            .member("count", -3)
+            .member("enabled", true)
+            .member("tags", std::vector<std::string>{"a", "b"})
+            .key("empty").beginArray().endArray()
+            .endObject();
+        REQUIRE(json.complete());
+        REQUIRE(out.str() == R"({"name":"tool","count":-3,"enabled":true,"tags":["a","b"],"empty":[]})");
+    }
+
+    SECTION( "Strings are escaped and UTF-8 is passed through") {
+        json.value("say \"hi\"\\\n\t\x01 é");
+        REQUIRE(out.str() == "\"say \\\"hi\\\"\\\\\\n\\t\\u0001 é\"");
+    }
+
+    SECTION( "Unbalanced writes throw") {
+        REQUIRE_THROWS(json.endObject());
+        json.beginObject().key("a");
+        REQUIRE_THROWS(json.key("b"));
+        REQUIRE_THROWS(json.endObject());
+        REQUIRE(!json.complete());
+    }
+}
+
+TEST_CASE( "Test parser definition export", "[definition]" ) {
+    auto noop = [] (auto& parseResult) -> int { return 0; };
+    auto blob = argunaught::HelpResource::compress({"Be \"chatty\""});
+    argunaught::HelpResource resource(blob.data(), blob.size());
+
+    argunaught::Option jobs{"jobs", "j", "Parallel jobs", 1};
+    jobs.minNumParams = 1;
+    jobs.conflictsWith = {"serial"};
+
+    auto argu = argunaught::Parser("tool", "-= Tool =-")
+        .description("Does things")
+        .options({
+            {"verbose", "v", resource.at(0), 0},
+            {"define", "D", "Defines a value", -1}
+        })
+        .constraints({{argunaught::ConstraintType::AtLeastOne, {"verbose", "define"}}})
+        .command("build", "Builds", {jobs, {"serial", "", "", 0}}, noop)
+        .lazyCommand("clean", "Cleans up", [noop] () {
+            return std::make_shared<argunaught::Command>("clean", "Cleans up everything", std::vector<argunaught::Option>{}, noop);
+        })
+        .group("Remote", "Working with remotes")
+            .streamingCommand("fetch", "Fetches", {},
+                [] (const argunaught::ParseResult&, argunaught::PositionalStream&) { return 0; })
+            .cursorSubParser("remote", "Manages remotes",
+                [] (const argunaught::Parser&, argunaught::ArgCursor&, argunaught::ParseResult&) {})
+        .endGroup();
+
+    const std::string expected =
+        R"({"name":"tool","banner":"-= Tool =-","description":"Does things","usage":"",)"
+        R"("passThrough":false,"columnarResults":false,)"
+        R"("options":[)"
+            R"({"long":"verbose","short":"v","description":"Be \"chatty\"","params":0,"minParams":0,)"
+                R"("required":false,"repeat":"separate","conflictsWith":[],"dependsOn":[]},)"
+            R"({"long":"define","short":"D","description":"Defines a value","params":-1,"minParams":0,)"
+                R"("required":false,"repeat":"separate","conflictsWith":[],"dependsOn":[]}],)"
+        R"("constraints":[{"type":"atLeastOne","options":["verbose","define"]}],)"
+        R"("commands":[)"
+            R"({"name":"build","description":"Builds","kind":"command","options":[)"
+                R"({"long":"jobs","short":"j","description":"Parallel jobs","params":1,"minParams":1,)"
+                    R"("required":false,"repeat":"separate","conflictsWith":["serial"],"dependsOn":[]},)"
+                R"({"long":"serial","short":"","description":"","params":0,"minParams":0,)"
+                    R"("required":false,"repeat":"separate","conflictsWith":[],"dependsOn":[]}]},)"
+            R"({"name":"clean","description":"Cleans up everything","kind":"command","options":[]}],)"
+        R"("groups":[{"name":"Remote","description":"Working with remotes","commands":[)"
+            R"({"name":"fetch","description":"Fetches","kind":"streaming","options":[]},)"
+            R"({"name":"remote","description":"Manages remotes","kind":"subparser","options":[]}]}]})"
+        "\n";
+
+    SECTION( "The definition is exported in the argunaught-gen schema format") {
+        REQUIRE(argunaught::ParserDefinition::json(argu) == expected);
+    }
+
+    SECTION( "The hidden flag is off by default") {
+        const char* argv[] = {"tool", "--argunaught-definition"};
+        auto parseResult = argu.parse(2, argv);
+        REQUIRE(parseResult.hasError());
+        REQUIRE(parseResult.errors[0].type == argunaught::ParseErrorType::UnknownOption);
+    }
+
+    SECTION( "The hidden flag exports the definition without parsing the rest") {
+        argu.definitionFlag();
+        const char* argv[] = {"tool", "--argunaught-definition", "--bogus", "build"};
+        auto parseResult = argu.parse(4, argv);
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.hasCommand());
+
+        std::ostringstream out;
+        {
+            argunaught::CommandOutputRedirect redirect(out);
+            REQUIRE(parseResult.runCommand() == 0);
+        }
+        REQUIRE(out.str() == expected);
+
+        // It isn't a command of the parser, so it's left out of help.
+        REQUIRE(argu.getCommand("--argunaught-definition") == nullptr);
+        auto help = argunaught::DefaultHelpFormatter(argu, {}, true).helpString();
+        REQUIRE(help.find("argunaught-definition") == std::string::npos);
+    }
+}
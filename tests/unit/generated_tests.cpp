@@ -0,0 +1,44 @@
+#include "catch2/catch.hpp"
+#include "test_cli.hpp"
+
+TEST_CASE( "Test generated parsers", "[generated]" ) {
+    SECTION( "Commands are found with the perfect hash") {
+        REQUIRE(test_cli::findCommand("build") == test_cli::CommandId::Build);
+        REQUIRE(test_cli::findCommand("clean") == test_cli::CommandId::Clean);
+        REQUIRE(test_cli::findCommand("fetch") == test_cli::CommandId::Fetch);
+        REQUIRE(test_cli::findCommand("remote") == test_cli::CommandId::Remote);
+        REQUIRE(!test_cli::findCommand("missing").has_value());
+        REQUIRE(!test_cli::findCommand("").has_value());
+        REQUIRE(test_cli::schema().name() == "test-cli");
+    }
+
+    SECTION( "The embedded schema builds a parser with typed options") {
+        argunaught::SchemaHandlers handlers;
+        handlers.commands["build"] = [] (auto& parseResult) -> int { return 1; };
+        handlers.commands["clean"] = [] (auto& parseResult) -> int { return 2; };
+        handlers.streamingCommands["fetch"] = [] (auto& parseResult, auto& stream) -> int { return 3; };
+        handlers.subParsers["remote"] = [] (auto& parent, auto& args, auto& result) {};
+
+        auto argu = test_cli::makeParser(handlers);
+        auto parseResult = argu.parse(std::deque<std::string>{
+            "-v", "-v", "-D", "a=1", "-j", "4", "-D", "b=2", "build", "-n", "--ratio", "0.5", "--ids", "1", "2"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.runCommand() == 1);
+
+        test_cli::GlobalOptions globals;
+        REQUIRE(test_cli::readGlobalOptions(parseResult, globals));
+        REQUIRE(globals.verbose == 2);
+        REQUIRE(globals.define == std::vector<std::string>{"a=1", "b=2"});
+        REQUIRE(globals.jobs == 4);
+
+        test_cli::BuildOptions build;
+        REQUIRE(test_cli::readBuildOptions(parseResult, build));
+        REQUIRE(build.dryRun);
+        REQUIRE(build.ratio == 0.5);
+        REQUIRE(build.ids == std::vector<int>{1, 2});
+
+        parseResult = argu.parse(std::deque<std::string>{"-j", "many", "clean"});
+        REQUIRE(parseResult.runCommand() == 2);
+        REQUIRE(!test_cli::readGlobalOptions(parseResult, globals));
+    }
+}
@@ -0,0 +1,255 @@
+#include "catch2/catch.hpp"
+#include <argunaught/argunaught.hpp>
+
+namespace
+{
+
+//! A style fixed at compile time.
+struct CompactStyle
+{
+    static constexpr std::size_t initialIndentLevel = 1;
+    static constexpr std::size_t spacesPerIndentLevel = 1;
+    static constexpr std::size_t maxJustified = 8;
+    static constexpr std::size_t maxLineLength = 80;
+
+    static constexpr std::string_view programNameColor = "";
+    static constexpr std::string_view groupNameColor = "";
+    static constexpr std::string_view groupNameSuffix = "";
+    static constexpr std::string_view commandNameColor = "";
+    static constexpr std::string_view optionNameColor = "";
+    static constexpr std::string_view optionDashColor = "";
+    static constexpr std::string_view optionSeparatorColor = "";
+    static constexpr std::string_view optionSeparator = "|";
+    static constexpr std::string_view separatorColor = "";
+    static constexpr std::string_view separator = ": ";
+    static constexpr std::string_view programDescriptionColor = "";
+    static constexpr std::string_view programUsageColor = "";
+    static constexpr std::string_view groupDescriptionColor = "";
+    static constexpr std::string_view commandDescriptionColor = "";
+    static constexpr std::string_view optionDescriptionColor = "";
+};
+
+//! Shouts command names and counts the descriptions it's given.
+class ShoutingFormatter : public argunaught::BasicHelpFormatter<ShoutingFormatter, CompactStyle>
+{
+public:
+    using BasicHelpFormatter::BasicHelpFormatter;
+
+    int numDescriptions = 0;
+
+    void commandName(std::string_view name)
+    {
+        indent(mStyle.initialIndentLevel);
+        for(char ch : name) {
+            appendText(std::string(1, static_cast<char>(std::toupper(static_cast<unsigned char>(ch)))));
+        }
+    }
+
+    void commandDescription(std::string_view value)
+    {
+        numDescriptions++;
+        appendText(value, true);
+    }
+};
+
+
+//! Fixes the line width and whether colors are used, so output can be compared exactly.
+template<typename Formatter>
+class GoldenFormatter : public Formatter
+{
+public:
+    GoldenFormatter(argunaught::Parser& parser, bool colors)
+        : Formatter(parser, {}, !colors)
+    {
+        this->mIsTTY = colors;
+        this->mMaxLineWidth = 60;
+    }
+};
+
+//! Overrides a hook of the virtual interface the default formatter used to have.
+class BracketingFormatter : public argunaught::DefaultHelpFormatter
+{
+public:
+    using DefaultHelpFormatter::DefaultHelpFormatter;
+
+    void commandName(std::string key) override
+    {
+        indent(mStyle.initialIndentLevel);
+        appendText("[" + key + "]");
+    }
+};
+
+argunaught::Parser
+goldenParser()
+{
+    auto noop = [] (auto& parseResult) -> int { return 0; };
+    auto argu = argunaught::Parser("golden", "Golden Tool v1")
+        .description("Renders help for a tool with a bit of everything in it, so the layout is covered.")
+        .usage("golden [options] <command> [args]")
+        .options({
+            {"verbose", "v", "Be chatty", 0},
+            {"config", "c", "The configuration file to read settings from before anything else happens", 1},
+            {"quiet", "", "", 0}
+        })
+        .command("build", "Builds things", {{"jobs", "j", "Parallel jobs", 1}, {"release", "", "Optimized über build", 0}}, noop)
+        .command("clean", "", noop)
+        .lazyCommand("deploy", "Deploys the service", [] () {
+            return std::make_shared<argunaught::Command>("deploy", "Deploys the service",
+                std::vector<argunaught::Option>{}, [] (auto& parseResult) -> int { return 0; });
+        })
+        .subParser("remote", "Manages remotes", {{"all", "a", "Every remote", 0}},
+            [] (auto& parent, auto foundOptions, auto args) { return argunaught::ParseResult(); });
+
+    argu.group("Storage", "Commands for volumes and snapshots.\nEach acts on the current cluster.")
+        .command("mount", "Attaches a volume to the machine it's run on, waiting until the volume is ready for use",
+            {{"read-only", "r", "Mount without write access", 0}}, noop)
+        .command("snapshot", "Takes a snapshot", noop);
+
+    argu.group("Misc")
+        .command("version", "Shows the version", noop);
+
+    return argu;
+}
+
+// Rendered by the virtual formatter before the hooks were resolved at compile time.
+const std::string PlainHelp =
+    "Golden Tool v1\n"
+    "Renders help for a tool with a bit of everything in it, so\n"
+    "the layout is covered.\n"
+    "golden [options] <command> [args]\n"
+    "\n"
+    "Global Options:\n"
+    "    --verbose, -v        - Be chatty\n"
+    "    --config, -c         - The configuration file to read\n"
+    "                           settings from before anything\n"
+    "                           else happens\n"
+    "    --quiet             \n"
+    "\n"
+    "Commands:\n"
+    "    build                - Builds things\n"
+    "      --jobs, -j         - Parallel jobs\n"
+    "      --release          - Optimized über build\n"
+    "    clean\n"
+    "    deploy               - Deploys the service\n"
+    "    remote               - Manages remotes\n"
+    "      --all, -a          - Every remote\n"
+    "\n"
+    "Storage:\n"
+    "    Commands for volumes and snapshots.\n"
+    "    Each acts on the current cluster.\n"
+    "\n"
+    "    mount                - Attaches a volume to the machine\n"
+    "                           it's run on, waiting until the\n"
+    "                           volume is ready for use\n"
+    "      --read-only, -r    - Mount without write access\n"
+    "    snapshot             - Takes a snapshot\n"
+    "\n"
+    "Misc:\n"
+    "    version              - Shows the version\n"
+    "\n";
+
+const std::string PlainCommandHelp =
+    "    build                - Builds things\n"
+    "      --jobs, -j         - Parallel jobs\n"
+    "      --release          - Optimized über build\n";
+
+const std::string ColoredHelp =
+    "\x1b[0m\x1b[1;92mGolden Tool v1\x1b[0m\n"
+    "\x1b[0m\x1b[0m\x1b[3mRenders help for a tool with a bit of everything in it, so\n"
+    "the layout is covered.\n"
+    "\x1b[0m\x1b[0m\x1b[0m\x1b[1mgolden [options] <command> [args]\n"
+    "\x1b[0m\n"
+    "\x1b[0m\x1b[4m\x1b[34mGlobal Options:\x1b[0m\n"
+    "    \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mverbose\x1b[0m\x1b[0m\x1b[2;36m, \x1b[0m\x1b[0m\x1b[2;36m-\x1b[0m\x1b[0m\x1b[36mv\x1b[0m       \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mBe chatty\x1b[0m\n"
+    "    \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mconfig\x1b[0m\x1b[0m\x1b[2;36m, \x1b[0m\x1b[0m\x1b[2;36m-\x1b[0m\x1b[0m\x1b[36mc\x1b[0m        \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mThe configuration file to read\n"
+    "                           settings from before anything\n"
+    "                           else happens\x1b[0m\n"
+    "    \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mquiet\x1b[0m             \n"
+    "\n"
+    "\x1b[0m\x1b[4m\x1b[34mCommands:\x1b[0m\n"
+    "    \x1b[0m\x1b[33mbuild\x1b[0m               \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mBuilds things\x1b[0m\n"
+    "      \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mjobs\x1b[0m\x1b[0m\x1b[2;36m, \x1b[0m\x1b[0m\x1b[2;36m-\x1b[0m\x1b[0m\x1b[36mj\x1b[0m        \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mParallel jobs\x1b[0m\n"
+    "      \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mrelease\x1b[0m         \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mOptimized über build\x1b[0m\n"
+    "    \x1b[0m\x1b[33mclean\x1b[0m\n"
+    "    \x1b[0m\x1b[33mdeploy\x1b[0m              \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mDeploys the service\x1b[0m\n"
+    "    \x1b[0m\x1b[33mremote\x1b[0m              \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mManages remotes\x1b[0m\n"
+    "      \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mall\x1b[0m\x1b[0m\x1b[2;36m, \x1b[0m\x1b[0m\x1b[2;36m-\x1b[0m\x1b[0m\x1b[36ma\x1b[0m         \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mEvery remote\x1b[0m\n"
+    "\n"
+    "\x1b[0m\x1b[4m\x1b[34mStorage:\x1b[0m\n"
+    "    \x1b[0m\x1b[0m\x1b[3mCommands for volumes and snapshots.\n"
+    "    Each acts on the current cluster.\x1b[0m\n"
+    "\n"
+    "    \x1b[0m\x1b[33mmount\x1b[0m               \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mAttaches a volume to the machine\n"
+    "                           it's run on, waiting until the\n"
+    "                           volume is ready for use\x1b[0m\n"
+    "      \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mread-only\x1b[0m\x1b[0m\x1b[2;36m, \x1b[0m\x1b[0m\x1b[2;36m-\x1b[0m\x1b[0m\x1b[36mr\x1b[0m   \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mMount without write access\x1b[0m\n"
+    "    \x1b[0m\x1b[33msnapshot\x1b[0m            \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mTakes a snapshot\x1b[0m\n"
+    "\n"
+    "\x1b[0m\x1b[4m\x1b[34mMisc:\x1b[0m\n"
+    "    \x1b[0m\x1b[33mversion\x1b[0m             \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mShows the version\x1b[0m\n"
+    "\n";
+
+const std::string ColoredCommandHelp =
+    "    \x1b[0m\x1b[33mbuild\x1b[0m               \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mBuilds things\x1b[0m\n"
+    "      \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mjobs\x1b[0m\x1b[0m\x1b[2;36m, \x1b[0m\x1b[0m\x1b[2;36m-\x1b[0m\x1b[0m\x1b[36mj\x1b[0m        \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mParallel jobs\x1b[0m\n"
+    "      \x1b[0m\x1b[2;36m--\x1b[0m\x1b[0m\x1b[36mrelease\x1b[0m         \x1b[0m\x1b[2m - \x1b[0m\x1b[0m\x1b[0mOptimized über build\x1b[0m\n";
+
+}
+
+TEST_CASE( "Test help formatters", "[help]" ) {
+    auto noop = [] (auto& parseResult) -> int { return 0; };
+    auto argu = argunaught::Parser("Cool Test App")
+        .options({{"verbose", "v", "Be chatty", 0}})
+        .command("build", "Builds things", {{"jobs", "j", "Parallel jobs", 1}}, noop)
+        .command("clean", "Cleans up", noop);
+
+    SECTION( "The default formatter renders through the framework") {
+        static_assert(std::is_base_of_v<argunaught::BasicHelpFormatter<argunaught::DefaultHelpFormatter>, argunaught::DefaultHelpFormatter>);
+        auto help = argunaught::DefaultHelpFormatter(argu, {}, true).helpString();
+        REQUIRE(help.find("    build") != std::string::npos);
+        REQUIRE(help.find("--jobs, -j") != std::string::npos);
+        REQUIRE(help.find("\033[") == std::string::npos);
+    }
+
+    SECTION( "Hooks and styles are resolved at compile time") {
+        ShoutingFormatter formatter(argu, {}, true);
+        auto help = formatter.helpString();
+        REQUIRE(formatter.numDescriptions == 2);
+        REQUIRE(help.find(" BUILD") != std::string::npos);
+        REQUIRE(help.find(" CLEAN") != std::string::npos);
+        REQUIRE(help.find("build") == std::string::npos);
+        REQUIRE(help.find("--verbose|-v") != std::string::npos);
+        REQUIRE(help.find(": Builds things") != std::string::npos);
+        REQUIRE(help.find("Commands\n") != std::string::npos);
+
+        // Hooks apply to single command help too.
+        REQUIRE(formatter.commandHelpString("clean") == " CLEAN   : Cleans up\n");
+    }
+}
+
+TEST_CASE( "Test help formatter output", "[help]" ) {
+    auto argu = goldenParser();
+
+    SECTION( "Help is rendered as before, with and without colors") {
+        using argunaught::DefaultHelpFormatter;
+        REQUIRE(GoldenFormatter<DefaultHelpFormatter>(argu, false).helpString() == PlainHelp);
+        REQUIRE(GoldenFormatter<DefaultHelpFormatter>(argu, true).helpString() == ColoredHelp);
+        REQUIRE(GoldenFormatter<DefaultHelpFormatter>(argu, false).commandHelpString("build") == PlainCommandHelp);
+        REQUIRE(GoldenFormatter<DefaultHelpFormatter>(argu, true).commandHelpString("build") == ColoredCommandHelp);
+    }
+
+    SECTION( "The formatter without virtual hooks renders the same") {
+        using Formatter = argunaught::BasicHelpFormatter<>;
+        REQUIRE(GoldenFormatter<Formatter>(argu, false).helpString() == PlainHelp);
+        REQUIRE(GoldenFormatter<Formatter>(argu, true).helpString() == ColoredHelp);
+        REQUIRE(GoldenFormatter<Formatter>(argu, false).commandHelpString("build") == PlainCommandHelp);
+        REQUIRE(GoldenFormatter<Formatter>(argu, true).commandHelpString("build") == ColoredCommandHelp);
+    }
+
+    SECTION( "Overridden virtual hooks are still called") {
+        auto help = BracketingFormatter(argu, {}, true).helpString();
+        REQUIRE(help.find("    [build]") != std::string::npos);
+        REQUIRE(help.find("    [version]") != std::string::npos);
+        REQUIRE(help.find("    build") == std::string::npos);
+    }
+}
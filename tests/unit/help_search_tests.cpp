@@ -0,0 +1,95 @@
+#include "catch2/catch.hpp"
+#include <argunaught/help_search.hpp>
+
+TEST_CASE( "Test help search", "[help]" ) {
+    auto noop = [] (auto& parseResult) -> int { return 0; };
+    bool lazyBuilt = false;
+
+    auto argu = argunaught::Parser("Cool Test App")
+        .command("deploy", "Deploys the service to a cluster",
+            {{"dry-run", "n", "Only show what would change", 0}}, noop)
+        .command("rollback", "Reverts the last deployment", noop)
+        .command("logs", "Streams service logs", {{"follow", "f", "Keep streaming", 0}}, noop)
+        .lazyCommand("backup", "Backs up the cluster state", [&lazyBuilt] () {
+            lazyBuilt = true;
+            return std::make_shared<argunaught::Command>("backup", "Backs up the cluster state",
+                std::vector<argunaught::Option>{}, [] (auto& parseResult) -> int { return 0; });
+        });
+
+    argu.group("Storage", "Manages volumes")
+        .command("mount", "Attaches a volume", noop)
+        .command("snapshot", "Takes a snapshot", noop);
+
+    SECTION( "Names rank above descriptions") {
+        auto hits = argu.helpIndex()->search("deploy");
+        REQUIRE(hits.size() == 2);
+        REQUIRE(hits[0].name == "deploy");
+        REQUIRE(hits[1].name == "rollback");
+        REQUIRE(hits[0].score > hits[1].score);
+    }
+
+    SECTION( "Hits matching more terms rank first") {
+        auto hits = argu.helpIndex()->search("cluster service");
+        REQUIRE(hits.size() == 3);
+        REQUIRE(hits[0].name == "deploy");
+        REQUIRE(hits[0].matchedTerms == 2);
+        REQUIRE(hits[1].matchedTerms == 1);
+    }
+
+    SECTION( "Options, groups and prefixes are searched") {
+        auto hits = argu.helpIndex()->search("dry-run");
+        REQUIRE(hits.size() == 1);
+        REQUIRE(hits[0].name == "deploy");
+
+        hits = argu.helpIndex()->search("STORAGE");
+        REQUIRE(hits.size() == 2);
+        REQUIRE(hits[0].group == "Storage");
+
+        hits = argu.helpIndex()->search("snap");
+        REQUIRE(hits.size() == 1);
+        REQUIRE(hits[0].name == "snapshot");
+
+        REQUIRE(argu.helpIndex()->search("nothing-like-this").empty());
+    }
+
+    SECTION( "The index is built once and lazy commands aren't built") {
+        auto index = argu.helpIndex();
+        REQUIRE(argu.helpIndex() == index);
+        REQUIRE(index->numDocuments() == 6);
+
+        auto hits = index->search("backs");
+        REQUIRE(hits.size() == 1);
+        REQUIRE(hits[0].kind == argunaught::HelpSearchKind::LazyCommand);
+        REQUIRE(!lazyBuilt);
+
+        argu.command("restore", "Restores a backup", noop);
+        REQUIRE(argu.helpIndex() != index);
+        REQUIRE(argu.helpIndex()->search("restore").size() == 1);
+    }
+
+    SECTION( "Any change to the parser makes the index stale") {
+        auto index = argu.helpIndex();
+        auto copy = argu;
+        REQUIRE(index->isCurrent(copy));
+
+        copy.description("Changed without adding anything");
+        REQUIRE(!index->isCurrent(copy));
+        REQUIRE(index->isCurrent(argu));
+
+        argu.options({{"verbose", "v", "Be chatty", 0}});
+        REQUIRE(!index->isCurrent(argu));
+
+        index = argu.helpIndex();
+        argu.group("Network").subParser("proxy", "Runs a proxy", [] (auto& parent, auto foundOptions, auto args) { return argunaught::ParseResult(); });
+        REQUIRE(!index->isCurrent(argu));
+        REQUIRE(argu.helpIndex()->search("proxy").size() == 1);
+    }
+
+    SECTION( "Only matching commands are rendered") {
+        auto help = argunaught::DefaultHelpFormatter(argu, {}, true).searchHelpString("logs");
+        REQUIRE(help.find("logs") != std::string::npos);
+        REQUIRE(help.find("--follow") != std::string::npos);
+        REQUIRE(help.find("deploy") == std::string::npos);
+        REQUIRE(help.find("Global Options") == std::string::npos);
+    }
+}
@@ -0,0 +1,118 @@
+#include "catch2/catch.hpp"
+#include <argunaught/argunaught.hpp>
+
+#include <cstring>
+#include <sstream>
+
+using argunaught::HelpResource;
+
+TEST_CASE( "Test compressed help text", "[help]" ) {
+    std::vector<std::string> texts = {
+        "Shows the status of the service",
+        "",
+        "Starts the service",
+        "Stops the service",
+        "Output only the name of the service"
+    };
+    for(int ii = 0; ii < 2000; ++ii) {
+        texts.push_back("Option number " + std::to_string(ii) + " of the service, which does nothing much");
+    }
+
+    auto blob = HelpResource::compress(texts);
+    HelpResource resource(blob.data(), blob.size());
+
+    SECTION( "Texts round trip through several blocks") {
+        std::size_t rawSize = 0;
+        for(const auto& text : texts) rawSize += text.size();
+        REQUIRE(rawSize > 4 * HelpResource::BlockSize);
+        REQUIRE(blob.size() < rawSize / 2);
+
+        REQUIRE(resource.size() == texts.size());
+        for(std::uint32_t ii = 0; ii < texts.size(); ++ii) {
+            REQUIRE(resource.length(ii) == texts[ii].size());
+            REQUIRE(resource.text(ii) == texts[ii]);
+        }
+
+        // Out of order, so blocks are swapped in and out.
+        REQUIRE(resource.text(2004) == texts[2004]);
+        REQUIRE(resource.text(0) == texts[0]);
+    }
+
+    SECTION( "Help text references act like strings") {
+        argunaught::HelpText inlined = "Starts the service";
+        auto ref = resource.at(2);
+        REQUIRE(ref.isReference());
+        REQUIRE(!inlined.isReference());
+        REQUIRE(ref == "Starts the service");
+        REQUIRE(ref != "Stops the service");
+        REQUIRE(std::string(ref) == inlined.str());
+        REQUIRE(resource.at(1).empty());
+        REQUIRE(resource.at(1) == "");
+        REQUIRE_THROWS_AS(resource.at(100000), std::runtime_error);
+    }
+
+    SECTION( "Code written against string descriptions still compiles") {
+        argunaught::HelpText inlined = "Starts the service";
+        auto ref = resource.at(2);
+        const std::string expected = "Starts the service";
+
+        REQUIRE(ref == inlined);
+        REQUIRE(ref != resource.at(3));
+        REQUIRE(expected == ref);
+        REQUIRE("Stops the service" != ref);
+        REQUIRE(std::string_view("Starts the service") == inlined);
+        REQUIRE(std::strcmp(ref.c_str(), "Starts the service") == 0);
+        REQUIRE(ref.c_str() == ref.c_str());
+        REQUIRE(std::strcmp(inlined.c_str(), "Starts the service") == 0);
+        REQUIRE("[" + ref + "]" == "[Starts the service]");
+        REQUIRE(expected + ": " + inlined == "Starts the service: Starts the service");
+        REQUIRE(ref + inlined == expected + expected);
+
+        std::ostringstream out;
+        out << ref << "|" << inlined;
+        REQUIRE(out.str() == "Starts the service|Starts the service");
+    }
+
+    SECTION( "Descriptions are only decompressed for help") {
+        auto argu = argunaught::Parser("Cool Test App")
+            .description(resource.at(0))
+            .options({{"verbose", "v", resource.at(4), 0}})
+            .command("start", resource.at(2), {{"name", "n", resource.at(5), 1}},
+                [] (auto& parseResult) -> int { return 0; });
+
+        argu.group("Other", resource.at(3))
+            .command("stop", resource.at(3), [] (auto& parseResult) -> int { return 0; });
+
+        auto help = argunaught::DefaultHelpFormatter(argu, {}, true).helpString();
+        REQUIRE(help.find(texts[0]) != std::string::npos);
+        REQUIRE(help.find(texts[2]) != std::string::npos);
+        REQUIRE(help.find(texts[4]) != std::string::npos);
+        REQUIRE(help.find(texts[5]) != std::string::npos);
+
+        // Corrupting the compressed data doesn't affect parsing, as
+        // descriptions aren't read.
+        blob[blob.size() - 10] ^= 0x5A;
+        blob[blob.size() - 20] ^= 0x5A;
+        HelpResource corrupt(blob.data(), blob.size());
+        auto other = argunaught::Parser("Cool Test App")
+            .options({{"verbose", "v", corrupt.at(texts.size() - 1), 0}})
+            .command("start", corrupt.at(texts.size() - 2), [] (auto& parseResult) -> int { return 0; });
+
+        auto parseResult = other.parseCommandLine("-v start");
+        REQUIRE(parseResult.errors.empty());
+        REQUIRE(parseResult.hasOption("verbose"));
+    }
+
+    SECTION( "Invalid resources are rejected") {
+        REQUIRE_THROWS_AS(HelpResource(blob.data(), 8), std::runtime_error);
+        REQUIRE_THROWS_AS(HelpResource(blob.data(), blob.size() - 1), std::runtime_error);
+
+        auto bad = blob;
+        bad[0] = 'X';
+        REQUIRE_THROWS_AS(HelpResource(bad.data(), bad.size()), std::runtime_error);
+
+        auto empty = HelpResource::compress({"", ""});
+        HelpResource emptyResource(empty.data(), empty.size());
+        REQUIRE(emptyResource.text(1) == "");
+    }
+}
@@ -148,3 +148,318 @@ TEST_CASE( "Test global options only", "[options]" ) {
         REQUIRE(parseResult.options[0].values[0] == "one");
     }
 }
+
+TEST_CASE( "Test layered option scopes", "[options]" ) {
+    auto parent = argunaught::Parser("Parent")
+        .options({{"global", "g", "A global option", 1}})
+        .command("run", "Runs something", 
+            {{"fast", "f", "Run quickly", 0}},
+            [] (auto& parseResult) -> int { return 0; });
+
+    SECTION( "Results see command options in front of global ones") {
+        auto parseResult = parent.parse(std::deque<std::string>{"run", "-f", "-g", "1"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.knownOptions()->findLongOption("fast") != nullptr);
+        REQUIRE(parseResult.knownOptions()->findShortOption("g")->longName == "global");
+        REQUIRE(parseResult.knownOptions()->layers().size() == 2);
+        REQUIRE_THROWS(parseResult.getOption("missing"));
+    }
+
+    SECTION( "Inherited options are shared, not copied") {
+        auto child = argunaught::Parser("Child")
+            .inheritOptions(parent)
+            .options({{"local", "l", "A local option", 0}});
+
+        REQUIRE(child.options().values().size() == 1);
+        REQUIRE(child.optionScope()->parent() == parent.optionScope());
+
+        auto parseResult = child.parse(std::deque<std::string>{"-g", "2", "-l"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.getOption("global")->values[0] == "2");
+        REQUIRE(parseResult.hasOption("local"));
+    }
+
+    SECTION( "Copies of a parser share their option list until changed") {
+        auto copy = parent;
+        REQUIRE(&copy.options() == &parent.options());
+
+        copy.options({{"extra", "x", "Only on the copy", 0}});
+        REQUIRE(copy.options().values().size() == 2);
+        REQUIRE(parent.options().values().size() == 1);
+    }
+
+    SECTION( "Duplicate options are still rejected") {
+        auto dup = argunaught::Parser("Dup")
+            .options({{"global", "g", "A global option", 0}, {"other", "g", "Same short name", 0}});
+        REQUIRE(dup.hasConfigurationError());
+    }
+}
+
+TEST_CASE( "Test options bound to variables", "[options]" ) {
+    struct Config
+    {
+        bool verbose = false;
+        int level = 0;
+        double ratio = 0.0;
+        std::string name;
+        std::vector<int> ids;
+        std::optional<int> limit;
+    };
+
+    Config config;
+    std::string mode = "default";
+    auto argu = argunaught::Parser("Cool Test App")
+        .options({
+            argunaught::Option{"verbose", "v", "Be chatty", 0}.bindTo(config, &Config::verbose),
+            argunaught::Option{"level", "l", "A level", 1, 1}.bindTo(config, &Config::level),
+            argunaught::Option{"ratio", "r", "A ratio", 1, 1}.bindTo(config, &Config::ratio),
+            argunaught::Option{"name", "n", "A name", 1, 1}.bindTo(config, &Config::name),
+            argunaught::Option{"ids", "i", "Some ids", -1}.bindTo(config, &Config::ids),
+            argunaught::Option{"limit", "", "A limit", 1}.bindTo(config, &Config::limit),
+            argunaught::Option{"mode", "m", "A mode", 1}.bindTo(mode),
+            {"plain", "p", "An unbound option", 1}
+        });
+
+    SECTION( "Values are written into the bound variables") {
+        auto parseResult = argu.parse(std::deque<std::string>{
+            "-v", "--level", "-3", "-r", "0.5", "-n", "bob", "-i", "1", "2", "3", "--limit", "10", "-m", "fast", "-p", "x"});
+
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(config.verbose);
+        REQUIRE(config.level == -3);
+        REQUIRE(config.ratio == 0.5);
+        REQUIRE(config.name == "bob");
+        REQUIRE(config.ids == std::vector<int>{1, 2, 3});
+        REQUIRE(config.limit == 10);
+        REQUIRE(mode == "fast");
+
+        // Only unbound options are recorded.
+        REQUIRE(parseResult.options.size() == 1);
+        REQUIRE(parseResult.getOption("plain")->values[0] == "x");
+        REQUIRE(!parseResult.hasOption("level"));
+    }
+
+    SECTION( "Unset options leave the defaults alone") {
+        auto parseResult = argu.parse(std::deque<std::string>{"-l", "2"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(config.level == 2);
+        REQUIRE(!config.verbose);
+        REQUIRE(!config.limit.has_value());
+        REQUIRE(mode == "default");
+    }
+
+    SECTION( "Values that don't convert are errors") {
+        auto parseResult = argu.parse(std::deque<std::string>{"-l", "2x", "-i", "4", "five"});
+        REQUIRE(parseResult.errors.size() == 2);
+        REQUIRE(parseResult.errors[0].type == argunaught::ParseErrorType::InvalidOptionValue);
+        REQUIRE(parseResult.errors[0].pos == 1);
+        REQUIRE(parseResult.errors[0].value == "2x");
+        REQUIRE(parseResult.errors[1].value == "five");
+        REQUIRE(config.level == 0);
+        REQUIRE(config.ids == std::vector<int>{4});
+    }
+
+    SECTION( "Bound options still count for constraints") {
+        auto required = argunaught::Parser("Required")
+            .options({argunaught::Option{"level", "l", "A level", 1, 1, true}.bindTo(config.level)});
+
+        REQUIRE(!required.parse(std::deque<std::string>{"-l", "1"}).hasError());
+        REQUIRE(required.parse(std::deque<std::string>{}).errors[0].type == argunaught::ParseErrorType::MissingRequiredOption);
+    }
+
+    SECTION( "Bound options are refused while the parser is shared") {
+        argunaught::SharedParsing shared;
+        REQUIRE_THROWS_AS(argu.parse(std::deque<std::string>{"-l", "2"}), std::runtime_error);
+        REQUIRE(config.level == 0);
+        REQUIRE(!argu.parse(std::deque<std::string>{"-p", "x"}).hasError());
+    }
+}
+
+TEST_CASE( "Test repeated option policies", "[options]" ) {
+    auto makeOption = [] (std::string name, std::string shortName, int numParams, argunaught::RepeatPolicy policy) {
+        argunaught::Option opt{name, shortName, "", numParams};
+        opt.repeat = policy;
+        return opt;
+    };
+
+    auto argu = argunaught::Parser("Cool Test App")
+        .options({
+            makeOption("verbose", "v", 0, argunaught::RepeatPolicy::Count),
+            makeOption("define", "D", 1, argunaught::RepeatPolicy::Append),
+            makeOption("level", "l", 1, argunaught::RepeatPolicy::LastWins),
+            makeOption("config", "c", 1, argunaught::RepeatPolicy::FirstWins),
+            makeOption("output", "o", 1, argunaught::RepeatPolicy::Error),
+            {"plain", "p", "Repeats are kept separate", 1}
+        });
+
+    SECTION( "Repeats are merged into one result") {
+        auto parseResult = argu.parse(std::deque<std::string>{
+            "-v", "-D", "a=1", "-l", "1", "-c", "first", "-v", "-p", "x", "--define", "b=2", 
+            "-l", "2", "-c", "second", "-p", "y", "-v", "-o", "out"});
+
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.options.size() == 7);
+
+        REQUIRE(parseResult.getOption("verbose")->count == 3);
+        REQUIRE(parseResult.getOption("verbose")->values.empty());
+        REQUIRE(parseResult.getOption("define")->values == std::vector<std::string>{"a=1", "b=2"});
+        REQUIRE(parseResult.getOption("define")->count == 2);
+        REQUIRE(parseResult.getOption("level")->values == std::vector<std::string>{"2"});
+        REQUIRE(parseResult.getOption("config")->values == std::vector<std::string>{"first"});
+        REQUIRE(parseResult.getOption("output")->count == 1);
+        REQUIRE(parseResult.getOption("plain")->values == std::vector<std::string>{"x"});
+    }
+
+    SECTION( "Repeating an option that forbids it is an error") {
+        auto parseResult = argu.parse(std::deque<std::string>{"-o", "a", "-v", "--output", "b"});
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].type == argunaught::ParseErrorType::RepeatedOption);
+        REQUIRE(parseResult.errors[0].pos == 4);
+        REQUIRE(parseResult.errors[0].value == "output");
+        REQUIRE(parseResult.getOption("output")->values == std::vector<std::string>{"a"});
+    }
+
+    SECTION( "Merged options stay out of the columns") {
+        argu.columnarResults();
+        auto parseResult = argu.parse(std::deque<std::string>{"-D", "a", "-D", "b", "-p", "x", "pos"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.options.size() == 1);
+        REQUIRE(parseResult.columns.optionRecords().size() == 1);
+        REQUIRE(parseResult.getOption("define")->values == std::vector<std::string>{"a", "b"});
+        REQUIRE(parseResult.getOption("plain")->values == std::vector<std::string>{"x"});
+    }
+
+    SECTION( "Thousands of repeats merge into one result") {
+        std::deque<std::string> args;
+        for(int ii = 0; ii < 5000; ++ii) {
+            args.push_back("--define");
+            args.push_back("k" + std::to_string(ii));
+        }
+
+        auto parseResult = argu.parse(args);
+        REQUIRE(parseResult.options.size() == 1);
+        REQUIRE(parseResult.options[0].count == 5000);
+        REQUIRE(parseResult.options[0].values.back() == "k4999");
+    }
+}
+
+TEST_CASE( "Test option name indexes", "[options]" ) {
+    argunaught::OptionList opts;
+    for(int ii = 0; ii < 300; ++ii) {
+        auto shortName = (ii % 2 == 0) ? "s" + std::to_string(ii) : "";
+        REQUIRE(opts.addOption({"opt" + std::to_string(ii), shortName, "An option", 0}) == argunaught::ParserConfigErrorType::NoError);
+    }
+
+    SECTION( "Names are found through every resize") {
+        for(std::size_t ii = 0; ii < 300; ++ii) {
+            REQUIRE(opts.findLongOptionIndex("opt" + std::to_string(ii)) == ii);
+        }
+
+        REQUIRE(opts.findShortOptionIndex("s298") == 298u);
+        REQUIRE(!opts.findShortOptionIndex("s299").has_value());
+        REQUIRE(!opts.findLongOptionIndex("opt300").has_value());
+        REQUIRE(!opts.findLongOptionIndex("").has_value());
+        REQUIRE(!opts.findShortOptionIndex("").has_value());
+    }
+
+    SECTION( "Copies keep working after the original changes") {
+        auto copy = opts;
+        REQUIRE(opts.addOption({"extra", "x", "Only in the original", 0}) == argunaught::ParserConfigErrorType::NoError);
+
+        REQUIRE(copy.findLongOptionIndex("opt150") == 150u);
+        REQUIRE(!copy.findLongOptionIndex("extra").has_value());
+        REQUIRE(opts.findShortOptionIndex("x") == 300u);
+        REQUIRE(copy.addOption({"opt7", "", "A duplicate", 0}) == argunaught::ParserConfigErrorType::DuplicateOption);
+        REQUIRE(copy.addOption({"other", "s8", "A duplicate short name", 0}) == argunaught::ParserConfigErrorType::DuplicateOption);
+    }
+}
+
+TEST_CASE( "Test shared option packs", "[options]" ) {
+    std::vector<argunaught::Option> common;
+    for(int ii = 0; ii < 40; ++ii) {
+        common.push_back({"common-" + std::to_string(ii), "", "A common option", 1});
+    }
+
+    auto pack = argunaught::makeOptionPack(common);
+    auto noop = [] (auto& parseResult) -> int { return 0; };
+
+    SECTION( "Commands reference the pack rather than copying it") {
+        auto argu = argunaught::Parser("Cool Test App");
+        for(int ii = 0; ii < 300; ++ii) {
+            argu.command("cmd-" + std::to_string(ii), "A command", {{"fast", "f", "Go fast", 0}}, {pack}, noop);
+        }
+
+        REQUIRE(!argu.hasConfigurationError());
+        REQUIRE(pack.use_count() == 301);
+
+        const auto& options = argu.getCommand("cmd-7")->options;
+        REQUIRE(options.values().size() == 1);
+        REQUIRE(options.size() == 41);
+        REQUIRE(options.at(1).longName == "common-0");
+        REQUIRE(&options.at(40) == &pack->values()[39]);
+        REQUIRE(options.findLongOptionIndex("common-39") == 40);
+
+        auto parseResult = argu.parse(std::deque<std::string>{"cmd-7", "--common-3", "value", "-f"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.getOption("common-3")->values[0] == "value");
+        REQUIRE(parseResult.hasOption("fast"));
+
+        auto help = argunaught::DefaultHelpFormatter(argu, {}, true).commandHelpString("cmd-7");
+        REQUIRE(help.find("--common-39") != std::string::npos);
+    }
+
+    SECTION( "Names clashing with a pack are configuration errors") {
+        auto argu = argunaught::Parser("Cool Test App")
+            .command("one", "First", {{"common-3", "", "Clashes", 0}}, {pack}, noop);
+
+        REQUIRE(argu.hasConfigurationError());
+        REQUIRE(argu.parserConfigErrors()[0].type == argunaught::ParserConfigErrorType::DuplicateOption);
+        REQUIRE(argu.getCommand("one")->options.packs().empty());
+
+        argunaught::OptionList list;
+        REQUIRE(list.include(pack) == argunaught::ParserConfigErrorType::NoError);
+        REQUIRE(list.addOption({"common-5", "", "Clashes", 0}) == argunaught::ParserConfigErrorType::DuplicateOption);
+        REQUIRE(list.size() == 40);
+    }
+
+    SECTION( "Packs included by packs are flattened and included once") {
+        auto outer = std::make_shared<argunaught::OptionList>(std::vector<argunaught::Option>{
+            {"outer", "o", "An outer option", 0, 0, true}
+        });
+        outer->include(pack);
+
+        argunaught::OptionList list;
+        list.include(pack);
+        REQUIRE(list.include(outer) == argunaught::ParserConfigErrorType::NoError);
+        REQUIRE(list.packs().size() == 2);
+        REQUIRE(list.size() == 41);
+        REQUIRE(list.at(40).longName == "outer");
+        REQUIRE(list.findShortOptionIndex("o") == 40);
+
+        std::size_t count = 0;
+        for(const auto& opt : list) {
+            REQUIRE(!opt.longName.empty());
+            count++;
+        }
+        REQUIRE(count == 41);
+    }
+
+    SECTION( "Constraints declared in a pack are checked") {
+        auto required = argunaught::makeOptionPack({{"token", "t", "An access token", 1, 1, true}});
+        auto argu = argunaught::Parser("Cool Test App")
+            .includeOptions(pack)
+            .command("one", "First", {}, {required}, noop);
+
+        REQUIRE(!argu.hasConfigurationError());
+        REQUIRE(argu.options().size() == 40);
+
+        auto parseResult = argu.parse(std::deque<std::string>{"--common-1", "x", "one"});
+        REQUIRE(parseResult.errors.size() == 1);
+        REQUIRE(parseResult.errors[0].type == argunaught::ParseErrorType::MissingRequiredOption);
+        REQUIRE(parseResult.errors[0].value == "token");
+
+        parseResult = argu.parse(std::deque<std::string>{"one", "-t", "secret"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.getOption("token")->values[0] == "secret");
+    }
+}
@@ -0,0 +1,126 @@
+#include "catch2/catch.hpp"
+#include <argunaught/plugins.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <stdlib.h>
+
+namespace
+{
+
+//! Copies the test plugin into a fresh directory so each test owns its index.
+std::filesystem::path
+makePluginDir()
+{
+    char dirTemplate[] = "/tmp/argunaught_plugins_XXXXXX";
+    std::filesystem::path dir = mkdtemp(dirTemplate);
+    std::filesystem::copy_file(
+        std::filesystem::path(ARGUNAUGHT_TEST_PLUGIN_DIR) / "test_plugin.so", 
+        dir / "test_plugin.so");
+    return dir;
+}
+
+}
+
+TEST_CASE( "Test plugin loading", "[plugins]" ) {
+    auto dir = makePluginDir();
+
+    argunaught::PluginLoader first(dir.string());
+    auto commands = first.scan();
+    REQUIRE(first.errors().empty());
+    REQUIRE(first.loadedLibraries() == 1);
+    REQUIRE(commands.size() == 2);
+    REQUIRE(commands[0].name == "hello");
+    REQUIRE(commands[0].shortHelp == "Says hello");
+    REQUIRE(commands[0].optionsSummary == "--name,-n");
+    REQUIRE(commands[1].name == "remote");
+    REQUIRE(commands[1].isSubParser);
+    REQUIRE(std::filesystem::exists(dir / "argunaught-plugins.index"));
+
+    SECTION( "A valid index is used without loading any plugin") {
+        argunaught::PluginLoader loader(dir.string());
+        REQUIRE(loader.scan().size() == 2);
+        REQUIRE(loader.loadedLibraries() == 0);
+
+        auto parser = argunaught::Parser("Host");
+        loader.registerInto(parser);
+        auto help = argunaught::DefaultHelpFormatter(parser, {}, true).helpString();
+        REQUIRE(help.find("Says hello") != std::string::npos);
+        REQUIRE(help.find("Manages remotes") != std::string::npos);
+        REQUIRE(loader.loadedLibraries() == 0);
+
+        auto parseResult = parser.parseCommandLine("hello -n Bob");
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(loader.loadedLibraries() == 1);
+
+        std::ostringstream out;
+        argunaught::CommandOutputRedirect redirect(out);
+        REQUIRE(parseResult.runCommand() == 7);
+        REQUIRE(out.str() == "Hello Bob\n");
+    }
+
+    SECTION( "Plugin subparsers continue parsing in place") {
+        argunaught::PluginLoader loader(dir.string());
+        loader.scan();
+
+        auto parser = argunaught::Parser("Host");
+        auto& group = parser.group("Plugins");
+        loader.registerInto(group);
+
+        auto parseResult = parser.parseCommandLine("remote add");
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.command->name == "add");
+        REQUIRE(parseResult.runCommand() == 3);
+    }
+
+    SECTION( "Changed and broken plugins are rescanned") {
+        auto plugin = dir / "test_plugin.so";
+        std::filesystem::last_write_time(plugin, std::filesystem::last_write_time(plugin) + std::chrono::seconds(5));
+        std::ofstream(dir / "broken.so") << "not a library";
+
+        argunaught::PluginLoader loader(dir.string());
+        REQUIRE(loader.scan().size() == 2);
+        REQUIRE(loader.loadedLibraries() == 1);
+        REQUIRE(loader.errors().size() == 1);
+
+        // The failure is remembered, so neither library is loaded again.
+        auto indexTime = std::filesystem::last_write_time(dir / "argunaught-plugins.index");
+        argunaught::PluginLoader again(dir.string());
+        REQUIRE(again.scan().size() == 2);
+        REQUIRE(again.loadedLibraries() == 0);
+        REQUIRE(again.errors() == loader.errors());
+        REQUIRE(std::filesystem::last_write_time(dir / "argunaught-plugins.index") == indexTime);
+
+        // Until the broken one changes.
+        std::ofstream(dir / "broken.so") << "still not a library";
+        argunaught::PluginLoader changed(dir.string());
+        REQUIRE(changed.scan().size() == 2);
+        REQUIRE(changed.errors().size() == 1);
+        REQUIRE(changed.errors()[0].find("broken.so") != std::string::npos);
+    }
+
+    SECTION( "A corrupt index is rebuilt") {
+        std::string index;
+        {
+            std::ifstream in(dir / "argunaught-plugins.index");
+            std::getline(in, index, '\0');
+        }
+
+        // Garble the library's stamp, which follows its path.
+        auto pathEnd = index.find('\t', index.find("lib\t") + 4);
+        std::ofstream(dir / "argunaught-plugins.index") << index.substr(0, pathEnd) << "\t12x\t\n";
+
+        argunaught::PluginLoader loader(dir.string());
+        REQUIRE(loader.scan().size() == 2);
+        REQUIRE(loader.loadedLibraries() == 1);
+        REQUIRE(loader.errors().empty());
+
+        argunaught::PluginLoader rebuilt(dir.string());
+        REQUIRE(rebuilt.scan().size() == 2);
+        REQUIRE(rebuilt.loadedLibraries() == 0);
+    }
+
+    std::filesystem::remove_all(dir);
+}
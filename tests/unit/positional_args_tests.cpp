@@ -1,6 +1,12 @@
 #include "catch2/catch.hpp"
 #include <argunaught/argunaught.hpp>
 
+#include <cstdio>
+#include <unistd.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+
 TEST_CASE( "Test positional args", "[options]" ) {
     auto argu = argunaught::Parser("Cool Test App")
         .options(    
@@ -80,3 +86,96 @@ TEST_CASE( "Test positional args", "[options]" ) {
         REQUIRE(!parseResult.hasCommand());
     }
 }
+
+TEST_CASE( "Test passing arguments through after --", "[options]" ) {
+    auto argu = argunaught::Parser("Wrapper")
+        .passThrough()
+        .options({{"verbose", "v", "Verbose output", 0}})
+        .command("run", "Runs a child process", 
+            {{"env", "e", "Environment to set", 1}},
+            [] (auto& parseResult) -> int { return 0; });
+
+    SECTION( "The tail points into argv and is null terminated") {
+        const char* argv[] = {"tool", "-v", "run", "-e", "A=1", "--", "ls", "-la", "--", "/tmp", nullptr};
+        auto parseResult = argu.parse(10, argv);
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.hasOption("env"));
+        REQUIRE(parseResult.positionalArgs.empty());
+        REQUIRE(parseResult.hasPassThrough());
+        REQUIRE(parseResult.passThroughSize() == 4);
+        REQUIRE(parseResult.passThroughArgv() == const_cast<char* const*>(&argv[6]));
+        REQUIRE(parseResult.passThroughArgv()[4] == nullptr);
+    }
+
+    SECTION( "Positional arguments before the boundary are still parsed") {
+        const char* argv[] = {"tool", "run", "a", "b", "--", "-x", nullptr};
+        auto parseResult = argu.parse(6, argv);
+        REQUIRE(parseResult.positionalArgs == std::vector<std::string>{"a", "b"});
+        REQUIRE(parseResult.passThroughSize() == 1);
+        REQUIRE(std::string(parseResult.passThroughArgv()[0]) == "-x");
+    }
+
+    SECTION( "Other sources keep treating the tail as positional arguments") {
+        auto parseResult = argu.parseCommandLine("run -- ls -la");
+        REQUIRE(!parseResult.hasPassThrough());
+        REQUIRE(parseResult.positionalArgs == std::vector<std::string>{"ls", "-la"});
+    }
+}
+
+TEST_CASE( "Test streaming positional args", "[options]" ) {
+    std::vector<std::string> seen;
+    auto argu = argunaught::Parser("Ingest")
+        .streamingCommand("ingest", "Ingests files", 
+            {{"dry-run", "n", "Don't write anything", 0}},
+            [&seen] (const auto& parseResult, auto& stream) -> int 
+            {
+                for(auto path : stream) {
+                    seen.emplace_back(path);
+                }
+                return parseResult.hasOption("dry-run") ? 1 : 0;
+            });
+
+    SECTION( "Arguments are pulled from argv when the command runs") {
+        const char* argv[] = {"tool", "ingest", "-n", "a", "b"};
+        auto parseResult = argu.parse(5, argv);
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.positionalArgs.empty());
+        REQUIRE(seen.empty());
+
+        REQUIRE(parseResult.runCommand() == 1);
+        REQUIRE(seen == std::vector<std::string>{"a", "b"});
+    }
+
+    SECTION( "Response files are read line by line") {
+        char path[] = "/tmp/argunaught_response_XXXXXX";
+        close(mkstemp(path));
+        std::ofstream(path) << "one\r\n\ntwo\n";
+
+        std::string fileArg = std::string("@") + path;
+        const char* argv[] = {"tool", "ingest", "a", fileArg.c_str(), "b"};
+        auto parseResult = argu.parse(5, argv);
+        REQUIRE(parseResult.runCommand() == 0);
+        REQUIRE(seen == std::vector<std::string>{"a", "one", "two", "b"});
+        std::remove(path);
+    }
+
+    SECTION( "A missing response file throws") {
+        const char* argv[] = {"tool", "ingest", "@/nonexistent/argunaught.txt"};
+        auto parseResult = argu.parse(3, argv);
+        REQUIRE_THROWS_AS(parseResult.runCommand(), std::runtime_error);
+    }
+
+    SECTION( "Stdin is read for -") {
+        std::istringstream in("x\ny\n");
+        std::vector<std::string> args = {"first", "-", "last"};
+        argunaught::PositionalStream stream(args, in);
+        std::vector<std::string> pulled(stream.begin(), stream.end());
+        REQUIRE(pulled == std::vector<std::string>{"first", "x", "y", "last"});
+    }
+
+    SECTION( "Other sources stream the collected arguments") {
+        auto parseResult = argu.parseCommandLine("ingest c d");
+        REQUIRE(parseResult.runCommand() == 0);
+        REQUIRE(seen == std::vector<std::string>{"c", "d"});
+    }
+}
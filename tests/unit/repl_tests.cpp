@@ -0,0 +1,197 @@
+#include "catch2/catch.hpp"
+#include <argunaught/repl.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using argunaught::ParseErrorType;
+using argunaught::ReplLine;
+
+TEST_CASE( "Test REPL line analysis", "[repl]" ) {
+    auto noop = [] (auto& parseResult) -> int { return 0; };
+    auto argu = argunaught::Parser("Cool Test App")
+        .options({
+            {"verbose", "v", "Be chatty", 0},
+            {"config", "c", "Config file", 1, 1}
+        })
+        .command("status", "Shows the status", {{"short", "s", "Short output", 0}}, noop)
+        .command("start", "Starts things", {{"name", "n", "Name to use", 1, 1, true}}, noop)
+        .command("stop", "Stops things", noop);
+
+    ReplLine line(argu);
+
+    SECTION( "Command names complete by prefix") {
+        line.update("st");
+        auto completion = line.complete(2);
+        REQUIRE(completion.candidates == std::vector<std::string>{"start", "status", "stop"});
+        REQUIRE(completion.begin == 0);
+        REQUIRE(completion.end == 2);
+        REQUIRE(completion.commonPrefix() == "st");
+
+        line.update("-v sta");
+        completion = line.complete(6);
+        REQUIRE(completion.candidates == std::vector<std::string>{"start", "status"});
+        REQUIRE(completion.commonPrefix() == "sta");
+    }
+
+    SECTION( "Options complete with the command's first") {
+        line.update("status --");
+        auto completion = line.complete(9);
+        REQUIRE(completion.candidates == std::vector<std::string>{"--config", "--short", "--verbose"});
+
+        line.update("status -");
+        completion = line.complete(8);
+        REQUIRE(completion.candidates.size() == 6);
+
+        // Option values and positional arguments aren't completed.
+        line.update("--config ");
+        REQUIRE(line.complete(9).candidates.empty());
+        line.update("stop x ");
+        REQUIRE(line.complete(7).candidates.empty());
+    }
+
+    SECTION( "Errors are reported as the line is typed") {
+        line.update("--bogus");
+        REQUIRE(line.errors().size() == 1);
+        REQUIRE(line.errors()[0].type == ParseErrorType::UnknownOption);
+        REQUIRE(line.errors()[0].value == "bogus");
+
+        line.update("--config");
+        REQUIRE(line.errors().size() == 1);
+        REQUIRE(line.errors()[0].type == ParseErrorType::TooFewOptionParams);
+
+        line.update("--config a.cfg start");
+        REQUIRE(line.phase() == ReplLine::Phase::CommandOptions);
+        REQUIRE(line.errors().size() == 1);
+        REQUIRE(line.errors()[0].type == ParseErrorType::MissingRequiredOption);
+        REQUIRE(line.errors()[0].value == "name");
+
+        line.update("--config a.cfg start -n x");
+        REQUIRE(line.errors().empty());
+
+        line.update("start -n 'unfinished");
+        REQUIRE(line.errors()[0].type == ParseErrorType::UnterminatedQuote);
+        REQUIRE(line.words()[2].text == "unfinished");
+    }
+
+    SECTION( "Global constraints are checked before a subparser") {
+        auto strict = argunaught::Parser("Cool Test App")
+            .options({{"config", "c", "Config file", 1, 1, true}})
+            .subParser("remote", "Manages remotes", 
+                [] (auto& parent, auto foundOptions, auto args) { return argunaught::ParseResult(); });
+
+        ReplLine strictLine(strict);
+        strictLine.update("remote --anything");
+        REQUIRE(strictLine.phase() == ReplLine::Phase::SubParser);
+        REQUIRE(strictLine.errors().size() == 1);
+        REQUIRE(strictLine.errors()[0].type == ParseErrorType::MissingRequiredOption);
+        REQUIRE(strictLine.errors()[0].value == "config");
+
+        strictLine.update("-c a.cfg remote --anything");
+        REQUIRE(strictLine.errors().empty());
+    }
+
+    SECTION( "Only the edited word is rescanned") {
+        line.update("--config a.cfg start -n x");
+        line.update("--config a.cfg start -n xy");
+        REQUIRE(line.lastRescan() == 23);
+
+        line.update("--config b.cfg start -n xy");
+        REQUIRE(line.lastRescan() == 8);
+        REQUIRE(line.errors().empty());
+
+        line.update("--config b.cfg stat -n xy");
+        REQUIRE(line.lastRescan() == 14);
+        REQUIRE(line.phase() == ReplLine::Phase::Positional);
+    }
+}
+
+TEST_CASE( "Test REPL with thousands of commands", "[repl]" ) {
+    auto argu = argunaught::Parser("Cool Test App");
+    for(int ii = 0; ii < 4000; ++ii) {
+        argu.command("command-" + std::to_string(ii), "A command", {{"opt", "o", "An option", 1}},
+            [] (auto& parseResult) -> int { return 0; });
+    }
+
+    ReplLine line(argu);
+    line.update("command-3999 --opt value ");
+
+    // Typing a long line a key at a time only looks at the last word each time.
+    std::string text = line.text();
+    for(int ii = 0; ii < 200; ++ii) {
+        text += "x";
+        line.update(text);
+        line.complete(text.size());
+    }
+
+    REQUIRE(line.errors().empty());
+    REQUIRE(line.lastRescan() == 24);
+
+    line.update("command-399");
+    auto completion = line.complete(11);
+    REQUIRE(completion.candidates.size() == 11);
+    REQUIRE(completion.candidates.front() == "command-399");
+}
+
+TEST_CASE( "Test REPL sessions", "[repl]" ) {
+    std::vector<std::string> ran;
+    auto argu = argunaught::Parser("Cool Test App")
+        .command("status", "Shows the status", {{"short", "s", "Short output", 0}},
+            [&ran] (auto& parseResult) -> int {
+                ran.push_back("status" + std::string(parseResult.hasOption("short") ? " short" : ""));
+                return 0;
+            })
+        .command("fail", "Fails",
+            [&ran] (auto& parseResult) -> int {
+                ran.push_back("fail");
+                return 3;
+            });
+
+    SECTION( "Lines are edited, completed and run") {
+        // Tab completes `stat`, then the arrow keys move back to insert `-s`.
+        std::istringstream in("stat\t\x1b[D -s\rxx\x7f\x7f" "fail\r" "--nope bogus\rexit\r");
+        std::ostringstream out;
+
+        argunaught::Repl repl(argu);
+        auto exitCode = repl.run(in, out);
+
+        REQUIRE(ran == std::vector<std::string>{"status short", "fail"});
+        REQUIRE(exitCode == 1);
+        REQUIRE(out.str().find("error: unknown option: nope") != std::string::npos);
+        REQUIRE(repl.history() == std::vector<std::string>{"status -s ", "fail", "--nope bogus", "exit"});
+    }
+
+    SECTION( "Escape sequences with parameters are read whole") {
+        // Ctrl+left, delete, then shift+end, as xterm sends them.
+        std::istringstream in("statusx\x1b[1;5D\x1b[3~\x1b[1;2F -s\x1b[200~\rexit\r");
+        std::ostringstream out;
+
+        argunaught::Repl repl(argu);
+        REQUIRE(repl.run(in, out) == 0);
+        REQUIRE(ran == std::vector<std::string>{"status short"});
+    }
+
+    SECTION( "History persists between sessions") {
+        auto path = "repl_history_test.txt";
+        std::remove(path);
+
+        argunaught::ReplOptions opts;
+        opts.historyFile = path;
+        {
+            std::istringstream in("fail\rstatus\r");
+            std::ostringstream out;
+            argunaught::Repl repl(argu, opts);
+            REQUIRE(repl.run(in, out) == 0);
+        }
+
+        // Up twice recalls the first line of the earlier session.
+        std::istringstream in("\x1b[A\x1b[A\r");
+        std::ostringstream out;
+        argunaught::Repl repl(argu, opts);
+        REQUIRE(repl.run(in, out) == 3);
+        REQUIRE(ran == std::vector<std::string>{"fail", "status", "fail"});
+
+        std::remove(path);
+    }
+}
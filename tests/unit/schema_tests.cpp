@@ -0,0 +1,118 @@
+#include "catch2/catch.hpp"
+#include <argunaught/schema.hpp>
+
+#include <unistd.h>
+
+#include <cstdio>
+
+TEST_CASE( "Test parser schemas", "[schema]" ) {
+    using argunaught::Schema;
+    using argunaught::SchemaCommandKind;
+
+    argunaught::Option define{"define", "D", "Defines a value", 1, 1};
+    define.repeat = argunaught::RepeatPolicy::Append;
+
+    int built = 0;
+    auto argu = argunaught::Parser("Cool Test App", "Cool Banner")
+        .description("Does cool things")
+        .options({
+            {"verbose", "v", "Be chatty", 0},
+            {"quiet", "q", "Be quiet", 0, 0, false, {"verbose"}},
+            define
+        })
+        .constraints({{argunaught::ConstraintType::MutuallyExclusive, {"verbose", "quiet"}}})
+        .command("build", "Builds things\nin detail", {{"fast", "f", "Go fast", 0}}, 
+            [] (auto& parseResult) -> int { return 1; })
+        .lazyCommand("lazy", "Lazily built", [&built] () {
+            built++;
+            return std::make_shared<argunaught::Command>("lazy", "A lazy command", std::vector<argunaught::Option>{}, 
+                [] (auto& parseResult) -> int { return 0; });
+        })
+        .group("Streaming")
+            .streamingCommand("cat", "Streams things", {}, 
+                [] (auto& parseResult, auto& stream) -> int { return 0; })
+            .cursorSubParser("sub", "A subparser", {{"all", "a", "Everything", 0}}, 
+                [] (auto& parent, auto& args, auto& result) {})
+        .endGroup();
+
+    auto blob = Schema::serialize(argu);
+    REQUIRE(built == 1);
+
+    SECTION( "The schema describes the parser without allocating") {
+        auto schema = Schema::fromBuffer(blob);
+        REQUIRE(schema.name() == "Cool Test App");
+        REQUIRE(schema.banner() == "Cool Banner");
+        REQUIRE(schema.description() == "Does cool things");
+        REQUIRE(schema.numGlobalOptions() == 3);
+        REQUIRE(schema.option(1).longName == "quiet");
+        REQUIRE(schema.option(1).conflictsWith.size() == 1);
+        REQUIRE(schema.option(1).conflictsWith[0] == "verbose");
+        REQUIRE(schema.option(2).repeat == argunaught::RepeatPolicy::Append);
+        REQUIRE(schema.numConstraints() == 1);
+        REQUIRE(schema.constraint(0).options[1] == "quiet");
+
+        REQUIRE(schema.numCommands() == 4);
+        REQUIRE(schema.numGroups() == 1);
+        REQUIRE(schema.group(0).name == "Streaming");
+
+        auto sub = schema.command(schema.findCommand("sub").value());
+        REQUIRE(sub.kind == SchemaCommandKind::SubParser);
+        REQUIRE(sub.group == 0);
+        REQUIRE(sub.numOptions == 1);
+        REQUIRE(schema.option(sub.firstOption).longName == "all");
+        REQUIRE(schema.command(schema.findCommand("cat").value()).kind == SchemaCommandKind::StreamingCommand);
+        REQUIRE(schema.command(schema.findCommand("lazy").value()).description == "A lazy command");
+        REQUIRE(!schema.findCommand("missing").has_value());
+    }
+
+    SECTION( "A mapped schema instantiates a working parser") {
+        auto path = "/tmp/argunaught_schema_test_" + std::to_string(getpid()) + ".bin";
+        Schema::write(argu, path);
+
+        argunaught::SchemaHandlers handlers;
+        handlers.commands["build"] = [] (auto& parseResult) -> int { return parseResult.hasOption("fast") ? 2 : 1; };
+        handlers.commands["lazy"] = [] (auto& parseResult) -> int { return 3; };
+        handlers.streamingCommands["cat"] = [] (auto& parseResult, auto& stream) -> int { return 4; };
+        handlers.subParsers["sub"] = [] (auto& parent, auto& args, auto& result) {};
+
+        auto loaded = Schema::map(path).instantiate(handlers);
+        std::remove(path.c_str());
+
+        REQUIRE(!loaded.hasConfigurationError());
+        auto parseResult = loaded.parse(std::deque<std::string>{"-v", "-D", "a", "-D", "b", "build", "-f"});
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.runCommand() == 2);
+        REQUIRE(parseResult.getOption("define")->values == std::vector<std::string>{"a", "b"});
+        REQUIRE(loaded.parse(std::deque<std::string>{"lazy"}).runCommand() == 3);
+
+        parseResult = loaded.parse(std::deque<std::string>{"-v", "-q"});
+        REQUIRE(parseResult.errors.size() >= 1);
+
+        REQUIRE(argunaught::Schema::serialize(loaded) == blob);
+    }
+
+    SECTION( "Rewriting a schema leaves existing mappings intact") {
+        auto path = "/tmp/argunaught_schema_rewrite_test_" + std::to_string(getpid()) + ".bin";
+        Schema::write(argu, path);
+        auto mapped = Schema::map(path);
+
+        Schema::write(argunaught::Parser("Other App"), path);
+        REQUIRE(mapped.name() == "Cool Test App");
+        REQUIRE(mapped.findCommand("build").has_value());
+        REQUIRE(Schema::map(path).name() == "Other App");
+
+        REQUIRE_THROWS(Schema::write(argu, "/tmp/argunaught_missing_dir_" + std::to_string(getpid()) + "/schema.bin"));
+        std::remove(path.c_str());
+    }
+
+    SECTION( "Missing handlers and bad data are rejected") {
+        auto schema = Schema::fromBuffer(blob);
+        REQUIRE_THROWS(schema.instantiate({}));
+
+        REQUIRE_THROWS(Schema::fromBuffer(blob.substr(0, blob.size() - 1)));
+        auto corrupt = blob;
+        corrupt[0] = 'X';
+        REQUIRE_THROWS(Schema::fromBuffer(corrupt));
+        REQUIRE_THROWS(Schema::map("/tmp/argunaught_missing_schema.bin"));
+    }
+}
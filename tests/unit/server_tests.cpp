@@ -0,0 +1,158 @@
+#include "catch2/catch.hpp"
+#include <argunaught/server.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+TEST_CASE( "Test command server", "[server]" ) {
+    argunaught::CommandServer* serverPtr = nullptr;
+    auto argu = argunaught::Parser("Cool Test App")
+        .options({
+            {"loud", "l", "Shout the output", 0}
+        })
+        .command("echo", "Echoes its positional arguments", 
+            [] (auto& parseResult) -> int 
+            {
+                auto& out = argunaught::commandOutput();
+                for(std::size_t ii = 0; ii < parseResult.positionalArgs.size(); ii++) {
+                    if(ii > 0) out << " ";
+                    out << parseResult.positionalArgs[ii];
+                }
+                if(parseResult.hasOption("loud")) out << "!";
+                out << "\n";
+                return static_cast<int>(parseResult.positionalArgs.size());
+            })
+        .command("halt", "Tries to stop the server from a handler", 
+            [&serverPtr] (auto&) -> int 
+            {
+                serverPtr->stop();
+                return 0;
+            });
+
+    std::string socketPath = "/tmp/argunaught_server_test_" + std::to_string(getpid()) + ".sock";
+    argunaught::ServerOptions serverOptions;
+    serverOptions.numWorkers = 2;
+    argunaught::CommandServer server(argu, socketPath, serverOptions);
+    serverPtr = &server;
+    server.start();
+    REQUIRE(server.running());
+
+    SECTION( "Output and exit code should be sent back to the client") {
+        std::ostringstream out;
+        auto exitCode = argunaught::runRemoteCommand(socketPath, {"-l", "echo", "a", "b"}, out);
+        REQUIRE(exitCode == 2);
+        REQUIRE(out.str() == "a b!\n");
+    }
+
+    SECTION( "An unknown command should return -1 with no output") {
+        std::ostringstream out;
+        auto exitCode = argunaught::runRemoteCommand(socketPath, {"nope"}, out);
+        REQUIRE(exitCode == -1);
+        REQUIRE(out.str() == "");
+    }
+
+    SECTION( "Parse errors should be sent back to the client") {
+        std::ostringstream out;
+        auto exitCode = argunaught::runRemoteCommand(socketPath, {"--bogus", "echo"}, out);
+        REQUIRE(exitCode == 1);
+        REQUIRE(out.str().find("error: unknown option") == 0);
+    }
+
+    SECTION( "A running server's socket isn't taken over") {
+        argunaught::CommandServer other(argu, socketPath);
+        REQUIRE_THROWS_AS(other.start(), std::runtime_error);
+
+        std::ostringstream out;
+        REQUIRE(argunaught::runRemoteCommand(socketPath, {"echo", "a"}, out) == 1);
+    }
+
+    SECTION( "Stopping the server from one of its handlers is refused") {
+        std::ostringstream out;
+        auto exitCode = argunaught::runRemoteCommand(socketPath, {"halt"}, out);
+        REQUIRE(exitCode == 1);
+        REQUIRE(out.str().find("error: CommandServer::stop()") == 0);
+        REQUIRE(server.running());
+    }
+
+    SECTION( "Large output should be streamed in multiple chunks") {
+        std::deque<std::string> args = {"echo"};
+        for(int ii = 0; ii < 5000; ii++) {
+            args.push_back("arg" + std::to_string(ii));
+        }
+
+        std::ostringstream out;
+        auto exitCode = argunaught::runRemoteCommand(socketPath, args, out);
+        REQUIRE(exitCode == 5000);
+        REQUIRE(out.str().substr(0, 10) == "arg0 arg1 ");
+        REQUIRE(out.str().size() > 4096);
+    }
+
+    SECTION( "Concurrent requests should each get their own output") {
+        std::vector<std::thread> clients;
+        std::vector<std::string> outputs(8);
+        std::vector<int> codes(8);
+        for(int ii = 0; ii < 8; ii++) {
+            clients.emplace_back([&, ii] {
+                std::ostringstream out;
+                std::deque<std::string> args = {"echo"};
+                for(int jj = 0; jj <= ii; jj++) args.push_back(std::to_string(ii));
+                codes[ii] = argunaught::runRemoteCommand(socketPath, args, out);
+                outputs[ii] = out.str();
+            });
+        }
+
+        for(auto& c : clients) c.join();
+
+        for(int ii = 0; ii < 8; ii++) {
+            REQUIRE(codes[ii] == ii + 1);
+            std::string expected = std::to_string(ii);
+            for(int jj = 0; jj < ii; jj++) expected += " " + std::to_string(ii);
+            REQUIRE(outputs[ii] == expected + "\n");
+        }
+    }
+
+    server.stop();
+    REQUIRE(!server.running());
+    REQUIRE(access(socketPath.c_str(), F_OK) != 0);
+    REQUIRE_THROWS_AS(
+        argunaught::runRemoteCommand(socketPath, {"echo"}, std::cout), 
+        std::runtime_error);
+}
+
+TEST_CASE( "Test command server socket files", "[server]" ) {
+    auto argu = argunaught::Parser("Cool Test App");
+    std::string socketPath = "/tmp/argunaught_server_file_test_" + std::to_string(getpid()) + ".sock";
+
+    SECTION( "Other files at the socket path are left alone") {
+        std::ofstream(socketPath) << "precious";
+
+        argunaught::CommandServer server(argu, socketPath);
+        REQUIRE_THROWS_AS(server.start(), std::runtime_error);
+
+        std::ifstream in(socketPath);
+        std::string contents;
+        in >> contents;
+        REQUIRE(contents == "precious");
+    }
+
+    SECTION( "A socket left behind by an earlier run is replaced") {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        std::copy(socketPath.begin(), socketPath.end(), addr.sun_path);
+        REQUIRE(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        close(fd);
+
+        argunaught::CommandServer server(argu, socketPath);
+        server.start();
+        REQUIRE(server.running());
+        server.stop();
+    }
+
+    unlink(socketPath.c_str());
+}
@@ -156,3 +156,98 @@ Commands:
     }
 
 }
+
+TEST_CASE( "Test cursor sub parsers", "[subparser]" ) {
+    int counter = 0;
+    auto leaf = argunaught::Parser("Leaf")
+        .options({{"leaf", "l", "A leaf option", 1}})
+        .command("work", "Unit test sub-command", 
+            {{"fast", "f", "Work quickly", 0}},
+            [&counter] (auto& parseResult) -> int 
+            {
+                counter = 300;
+                return 0;
+            });
+
+    auto middle = argunaught::Parser("Middle")
+        .options({{"middle", "m", "A middle option", 0}})
+        .cursorSubParser("leaf", "The innermost parser",
+            [&leaf] (const auto& parser, auto& args, auto& result) 
+            {
+                leaf.parseInto(args, result);
+            });
+
+    auto argu = argunaught::Parser("Root")
+        .options({{"global", "g", "A global option", 1}})
+        .cursorSubParser("middle", "The middle parser",
+            [&middle] (const auto& parser, auto& args, auto& result) 
+            {
+                middle.parseInto(args, result);
+            });
+
+    SECTION( "Options and commands from every level end up in one result") {
+        auto parseResult = argu.parseCommandLine("-g 1 middle -m leaf -l 2 work -f a b");
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.options.size() == 4);
+        REQUIRE(parseResult.getOption("global")->values[0] == "1");
+        REQUIRE(parseResult.hasOption("middle"));
+        REQUIRE(parseResult.getOption("leaf")->values[0] == "2");
+        REQUIRE(parseResult.hasOption("fast"));
+        REQUIRE(parseResult.positionalArgs == std::vector<std::string>{"a", "b"});
+
+        REQUIRE(parseResult.hasCommand());
+        parseResult.runCommand();
+        REQUIRE(counter == 300);
+    }
+
+    SECTION( "Error positions index the original tokens") {
+        const char* argv[] = {"app", "middle", "leaf", "--nope"};
+        auto parseResult = argu.parse(4, argv);
+        REQUIRE(parseResult.hasError());
+        REQUIRE(parseResult.errors[0].type == argunaught::ParseErrorType::UnknownOption);
+        REQUIRE(parseResult.errors[0].pos == 3);
+    }
+
+    SECTION( "The parent's constraints are checked before handing off") {
+        auto strict = argunaught::Parser("Root")
+            .options({{"global", "g", "A required global option", 1, 1, true}})
+            .cursorSubParser("leaf", "The leaf parser",
+                [&leaf] (const auto& parser, auto& args, auto& result) 
+                {
+                    leaf.parseInto(args, result);
+                })
+            .subParser("legacy", "A deque based leaf parser",
+                [&leaf] (auto& parent, auto foundOptions, auto args) 
+                {
+                    return leaf.parse(args, foundOptions);
+                });
+
+        for(auto commandLine : {"leaf work", "legacy work"}) {
+            auto parseResult = strict.parseCommandLine(commandLine);
+            REQUIRE(parseResult.errors.size() == 1);
+            REQUIRE(parseResult.errors[0].type == argunaught::ParseErrorType::MissingRequiredOption);
+            REQUIRE(parseResult.errors[0].value == "global");
+        }
+
+        REQUIRE(!strict.parseCommandLine("-g 1 leaf work").hasError());
+        REQUIRE(!strict.parseCommandLine("-g 1 legacy work").hasError());
+    }
+
+    SECTION( "Columnar results keep option names across parsers") {
+        auto columnar = argunaught::Parser("Root")
+            .columnarResults()
+            .options({{"global", "g", "A global option", 1}})
+            .cursorSubParser("leaf", "The leaf parser",
+                [&leaf] (const auto& parser, auto& args, auto& result) 
+                {
+                    leaf.parseInto(args, result);
+                });
+
+        auto parseResult = columnar.parseCommandLine("-g 1 leaf -l 2 x");
+        REQUIRE(!parseResult.hasError());
+        REQUIRE(parseResult.hasColumns());
+        REQUIRE(parseResult.getOption("global")->values[0] == "1");
+        REQUIRE(parseResult.getOption("leaf")->values[0] == "2");
+        REQUIRE(parseResult.positionalArgStrings() == std::vector<std::string>{"x"});
+    }
+}
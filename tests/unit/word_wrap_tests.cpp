@@ -70,3 +70,51 @@ TEST_CASE( "Test word wrap and formatting helper.", "[utils]" ) {
         REQUIRE(lineLen == 12);
     }
 }
+
+TEST_CASE( "Test word wrap with unicode text.", "[utils]" ) {
+
+    SECTION("Display widths count wide characters twice and combining marks not at all.") {
+        REQUIRE(argunaught::displayWidth("Hello") == 5);
+        REQUIRE(argunaught::displayWidth("caf\u00e9") == 4);
+        REQUIRE(argunaught::displayWidth("cafe\u0301") == 4);
+        REQUIRE(argunaught::displayWidth("┌──┐") == 4);
+        REQUIRE(argunaught::displayWidth("日本語") == 6);
+        REQUIRE(argunaught::displayWidth("\U0001F680") == 2);
+        REQUIRE(argunaught::displayWidth("\xff\xfe") == 2);
+        REQUIRE(argunaught::codePointWidth(0xFF21) == 2);
+        REQUIRE(argunaught::codePointWidth(0x200B) == 0);
+
+        // ASCII is measured a byte a column, as it's wrapped, even for controls.
+        REQUIRE(argunaught::codePointWidth(0x1B) == 0);
+        REQUIRE(argunaught::displayWidth("\x1b") == 1);
+        REQUIRE(argunaught::displayWidth("\x1b\u00e9") == 2);
+    }
+
+    SECTION("Wide characters wrap by their columns.") {
+        std::string result;
+        auto lineLen = argunaught::formatAndAppendText(result, 0, 0, 10, 
+            "日本語 テキスト");
+        REQUIRE(result == "日本語\nテキスト");
+        REQUIRE(lineLen == 8);
+    }
+
+    SECTION("Hyphenating never splits a code point.") {
+        std::string result;
+        auto lineLen = argunaught::formatAndAppendText(result, 0, 0, 10, 
+            "日本語のテキスト");
+        REQUIRE(result == "日本語の-\nテキスト");
+        REQUIRE(lineLen == 8);
+
+        result.clear();
+        lineLen = argunaught::formatAndAppendText(result, 0, 2, 5, "ééééééééé");
+        REQUIRE(result == "éééé-\n  éé-\n  ééé");
+        REQUIRE(lineLen == 5);
+    }
+
+    SECTION("Combining marks stay with their character.") {
+        std::string result;
+        auto lineLen = argunaught::formatAndAppendText(result, 0, 0, 8, "cafe\u0301 cafe\u0301");
+        REQUIRE(result == "cafe\u0301\ncafe\u0301");
+        REQUIRE(lineLen == 4);
+    }
+}
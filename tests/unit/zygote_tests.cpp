@@ -0,0 +1,158 @@
+#include "catch2/catch.hpp"
+#include <argunaught/zygote.hpp>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+
+std::string
+readAvailable(int fd)
+{
+    std::string data;
+    char buffer[256];
+    ssize_t len = 0;
+    while((len = read(fd, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, len);
+    }
+
+    return data;
+}
+
+argunaught::Zygote* runningZygote = nullptr;
+
+void
+stopZygote(int)
+{
+    runningZygote->stop();
+}
+
+}
+
+TEST_CASE( "Test zygote", "[zygote]" ) {
+    int built = 0;
+    auto argu = argunaught::Parser("Cool Test App")
+        .command("echo", "Echoes its positional arguments", 
+            [] (auto& parseResult) -> int 
+            {
+                auto& out = argunaught::commandOutput();
+                for(const auto& arg : parseResult.positionalArgs) out << arg << ";";
+                std::cerr << "pid " << getpid();
+                return static_cast<int>(parseResult.positionalArgs.size());
+            })
+        .lazyCommand("lazy", "Built before serving", [&built] () {
+            built++;
+            return std::make_shared<argunaught::Command>("lazy", "", std::vector<argunaught::Option>{}, 
+                [&built] (auto& parseResult) -> int { return built; });
+        });
+
+    std::string socketPath = "/tmp/argunaught_zygote_test_" + std::to_string(getpid()) + ".sock";
+    unlink(socketPath.c_str());
+
+    pid_t zygotePid = fork();
+    if(zygotePid == 0) {
+        argunaught::Zygote zygote(argu, socketPath);
+        zygote.run();
+        _exit(0);
+    }
+
+    // Wait for the zygote to start listening.
+    for(int ii = 0; ii < 200 && access(socketPath.c_str(), F_OK) != 0; ++ii) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    SECTION( "Commands run in a child with the client's stdio") {
+        int outPipe[2];
+        int errPipe[2];
+        REQUIRE(pipe(outPipe) == 0);
+        REQUIRE(pipe(errPipe) == 0);
+
+        auto exitCode = argunaught::runZygoteCommand(socketPath, {"echo", "a", "b"}, 0, outPipe[1], errPipe[1]);
+        close(outPipe[1]);
+        close(errPipe[1]);
+
+        REQUIRE(exitCode == 2);
+        REQUIRE(readAvailable(outPipe[0]) == "a;b;");
+
+        auto err = readAvailable(errPipe[0]);
+        REQUIRE(err.find("pid ") == 0);
+        REQUIRE(err != "pid " + std::to_string(zygotePid));
+        close(outPipe[0]);
+        close(errPipe[0]);
+    }
+
+    SECTION( "Parse errors go to the client's stderr without running the command") {
+        int outPipe[2];
+        int errPipe[2];
+        REQUIRE(pipe(outPipe) == 0);
+        REQUIRE(pipe(errPipe) == 0);
+
+        auto exitCode = argunaught::runZygoteCommand(socketPath, {"--bogus", "echo", "a"}, 0, outPipe[1], errPipe[1]);
+        close(outPipe[1]);
+        close(errPipe[1]);
+
+        REQUIRE(exitCode == 1);
+        REQUIRE(readAvailable(outPipe[0]) == "");
+        REQUIRE(readAvailable(errPipe[0]) == "error: unknown option: bogus\n");
+        close(outPipe[0]);
+        close(errPipe[0]);
+    }
+
+    SECTION( "Lazy commands are built once in the zygote") {
+        REQUIRE(argunaught::runZygoteCommand(socketPath, {"lazy"}) == 1);
+        REQUIRE(argunaught::runZygoteCommand(socketPath, {"lazy"}) == 1);
+    }
+
+    kill(zygotePid, SIGKILL);
+    waitpid(zygotePid, nullptr, 0);
+    unlink(socketPath.c_str());
+}
+
+TEST_CASE( "Test zygote leaves other children alone", "[zygote]" ) {
+    auto argu = argunaught::Parser("Cool Test App")
+        .command("noop", "Does nothing", [] (auto& parseResult) -> int { return 3; });
+
+    std::string socketPath = "/tmp/argunaught_zygote_reap_test_" + std::to_string(getpid()) + ".sock";
+    unlink(socketPath.c_str());
+
+    pid_t zygotePid = fork();
+    if(zygotePid == 0) {
+        // A child of the host that has nothing to do with the zygote.
+        pid_t unrelated = fork();
+        if(unrelated == 0) {
+            _exit(7);
+        }
+
+        argunaught::Zygote zygote(argu, socketPath);
+        runningZygote = &zygote;
+        signal(SIGUSR1, stopZygote);
+        zygote.run();
+
+        // The host can still collect its own child's exit status.
+        int status = 0;
+        bool collected = waitpid(unrelated, &status, 0) == unrelated && WEXITSTATUS(status) == 7;
+        _exit(collected ? 0 : 1);
+    }
+
+    for(int ii = 0; ii < 200 && access(socketPath.c_str(), F_OK) != 0; ++ii) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(argunaught::runZygoteCommand(socketPath, {"noop"}) == 3);
+
+    // Let the zygote go around its reaping loop a few times.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    kill(zygotePid, SIGUSR1);
+
+    int status = 0;
+    REQUIRE(waitpid(zygotePid, &status, 0) == zygotePid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+    unlink(socketPath.c_str());
+}
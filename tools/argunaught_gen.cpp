@@ -0,0 +1,758 @@
+// argunaught-gen: turns a JSON description of a command line interface into
+// C++ sources with the parser schema embedded, a perfect hash command lookup
+// and typed option structs.  See the "Code Generation" section of the ReadMe.
+
+#include <argunaught/argunaught.hpp>
+#include <argunaught/schema.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace
+{
+
+//! A parsed JSON value.
+struct JsonValue
+{
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue* find(const std::string& key) const
+    {
+        for(const auto& el : object) {
+            if(el.first == key) return &el.second;
+        }
+        return nullptr;
+    }
+
+    std::string getString(const std::string& key, const std::string& defaultVal = "") const
+    {
+        auto value = find(key);
+        return value != nullptr && value->type == Type::String ? value->string : defaultVal;
+    }
+
+    int getInt(const std::string& key, int defaultVal) const
+    {
+        auto value = find(key);
+        return value != nullptr && value->type == Type::Number ? static_cast<int>(value->number) : defaultVal;
+    }
+
+    bool getBool(const std::string& key, bool defaultVal) const
+    {
+        auto value = find(key);
+        return value != nullptr && value->type == Type::Bool ? value->boolean : defaultVal;
+    }
+
+    std::vector<std::string> getStrings(const std::string& key) const
+    {
+        std::vector<std::string> result;
+        if(auto value = find(key); value != nullptr) {
+            for(const auto& el : value->array) result.push_back(el.string);
+        }
+        return result;
+    }
+
+    const std::vector<JsonValue>& getArray(const std::string& key) const
+    {
+        static const std::vector<JsonValue> empty;
+        auto value = find(key);
+        return value != nullptr && value->type == Type::Array ? value->array : empty;
+    }
+};
+
+//! A small recursive descent JSON reader, enough for schema files.
+class JsonReader
+{
+private:
+    const std::string& mText;
+    std::size_t mPos = 0;
+
+    [[noreturn]] void fail(const std::string& message) const
+    {
+        auto line = 1 + std::count(mText.begin(), mText.begin() + std::min(mPos, mText.size()), '\n');
+        throw std::runtime_error("line " + std::to_string(line) + ": " + message);
+    }
+
+    void skipSpace()
+    {
+        while(mPos < mText.size() && std::isspace(static_cast<unsigned char>(mText[mPos]))) ++mPos;
+    }
+
+    bool consume(char c)
+    {
+        skipSpace();
+        if(mPos < mText.size() && mText[mPos] == c) {
+            ++mPos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if(!consume(c)) fail(std::string("expected '") + c + "'");
+    }
+
+    bool consumeWord(const char* word)
+    {
+        auto len = std::strlen(word);
+        if(mText.compare(mPos, len, word) == 0) {
+            mPos += len;
+            return true;
+        }
+        return false;
+    }
+
+    std::string parseString()
+    {
+        expect('"');
+        std::string result;
+        while(mPos < mText.size() && mText[mPos] != '"') {
+            char c = mText[mPos++];
+            if(c != '\\') {
+                result += c;
+                continue;
+            }
+
+            if(mPos >= mText.size()) break;
+            char escaped = mText[mPos++];
+            switch(escaped) {
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'r': result += '\r'; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'u': {
+                    if(mPos + 4 > mText.size()) fail("bad unicode escape");
+                    auto code = std::stoul(mText.substr(mPos, 4), nullptr, 16);
+                    mPos += 4;
+                    // Encode as UTF-8, surrogate pairs aren't combined.
+                    if(code < 0x80) {
+                        result += static_cast<char>(code);
+                    }
+                    else if(code < 0x800) {
+                        result += static_cast<char>(0xC0 | (code >> 6));
+                        result += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    else {
+                        result += static_cast<char>(0xE0 | (code >> 12));
+                        result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        result += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default: result += escaped;
+            }
+        }
+
+        if(mPos >= mText.size()) fail("unterminated string");
+        ++mPos;
+        return result;
+    }
+
+public:
+    explicit JsonReader(const std::string& text) : mText(text) {}
+
+    JsonValue parseValue()
+    {
+        skipSpace();
+        if(mPos >= mText.size()) fail("unexpected end of input");
+
+        JsonValue value;
+        char c = mText[mPos];
+        if(c == '{') {
+            value.type = JsonValue::Type::Object;
+            ++mPos;
+            if(consume('}')) return value;
+            do {
+                skipSpace();
+                auto key = parseString();
+                expect(':');
+                value.object.emplace_back(key, parseValue());
+            } while(consume(','));
+            expect('}');
+        }
+        else if(c == '[') {
+            value.type = JsonValue::Type::Array;
+            ++mPos;
+            if(consume(']')) return value;
+            do {
+                value.array.push_back(parseValue());
+            } while(consume(','));
+            expect(']');
+        }
+        else if(c == '"') {
+            value.type = JsonValue::Type::String;
+            value.string = parseString();
+        }
+        else if(consumeWord("true")) {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = true;
+        }
+        else if(consumeWord("false")) {
+            value.type = JsonValue::Type::Bool;
+        }
+        else if(consumeWord("null")) {
+            value.type = JsonValue::Type::Null;
+        }
+        else {
+            std::size_t used = 0;
+            try {
+                value.number = std::stod(mText.substr(mPos, 32), &used);
+            }
+            catch(const std::exception&) {
+                fail("unexpected character");
+            }
+            value.type = JsonValue::Type::Number;
+            mPos += used;
+        }
+
+        return value;
+    }
+
+    JsonValue parseDocument()
+    {
+        auto value = parseValue();
+        skipSpace();
+        if(mPos != mText.size()) fail("trailing characters");
+        return value;
+    }
+};
+
+argunaught::RepeatPolicy
+repeatPolicy(const std::string& name)
+{
+    static const std::map<std::string, argunaught::RepeatPolicy> policies = {
+        {"", argunaught::RepeatPolicy::Separate},
+        {"separate", argunaught::RepeatPolicy::Separate},
+        {"count", argunaught::RepeatPolicy::Count},
+        {"append", argunaught::RepeatPolicy::Append},
+        {"lastWins", argunaught::RepeatPolicy::LastWins},
+        {"firstWins", argunaught::RepeatPolicy::FirstWins},
+        {"error", argunaught::RepeatPolicy::Error},
+    };
+
+    auto found = policies.find(name);
+    if(found == policies.end()) {
+        throw std::runtime_error("unknown repeat policy '" + name + "'");
+    }
+    return found->second;
+}
+
+//! The C++ type of an option's field in the generated structs.
+struct FieldType
+{
+    //! `bool`, `count`, `int`, `double` or `string`.
+    std::string element;
+    bool isList = false;
+
+    std::string elementType() const
+    {
+        if(element == "int") return "int";
+        if(element == "double") return "double";
+        return "std::string";
+    }
+
+    std::string cppType() const
+    {
+        if(element == "bool") return "bool";
+        if(element == "count") return "std::size_t";
+        return isList ? "std::vector<" + elementType() + ">" : "std::optional<" + elementType() + ">";
+    }
+};
+
+//! The types given in the schema by command name, then option long name.
+using TypeMap = std::map<std::string, std::map<std::string, FieldType>>;
+
+FieldType
+fieldType(const JsonValue& json, const argunaught::Option& opt)
+{
+    auto type = json.getString("type");
+    if(type.empty()) {
+        // Infer from the number of parameters.
+        if(opt.maxNumParams == 0) return {opt.repeat == argunaught::RepeatPolicy::Count ? "count" : "bool", false};
+        return {"string", opt.maxNumParams != 1 || opt.repeat == argunaught::RepeatPolicy::Append};
+    }
+
+    FieldType result;
+    result.isList = type.size() > 2 && type.compare(type.size() - 2, 2, "[]") == 0;
+    result.element = result.isList ? type.substr(0, type.size() - 2) : type;
+
+    static const std::set<std::string> known = {"bool", "count", "int", "double", "string"};
+    if(known.count(result.element) == 0 || (result.isList && (result.element == "bool" || result.element == "count"))) {
+        throw std::runtime_error("unknown type '" + type + "' for option '" + opt.longName + "'");
+    }
+    return result;
+}
+
+std::vector<argunaught::Option>
+readOptions(const JsonValue& json, const std::string& commandName, TypeMap& types)
+{
+    std::vector<argunaught::Option> options;
+    for(const auto& el : json.getArray("options")) {
+        argunaught::Option opt{el.getString("long"), el.getString("short"), el.getString("description")};
+        opt.maxNumParams = el.getInt("params", 0);
+        opt.minNumParams = el.getInt("minParams", 0);
+        opt.required = el.getBool("required", false);
+        opt.conflictsWith = el.getStrings("conflictsWith");
+        opt.dependsOn = el.getStrings("dependsOn");
+        opt.repeat = repeatPolicy(el.getString("repeat"));
+
+        auto type = fieldType(el, opt);
+        if(type.element == "count") {
+            opt.repeat = argunaught::RepeatPolicy::Count;
+        }
+        types[commandName][opt.longName] = type;
+        options.push_back(opt);
+    }
+    return options;
+}
+
+template<typename Target>
+void
+addCommands(Target& target, const JsonValue& json, TypeMap& types)
+{
+    for(const auto& el : json.getArray("commands")) {
+        auto name = el.getString("name");
+        auto description = el.getString("description");
+        auto options = readOptions(el, name, types);
+        auto kind = el.getString("kind", "command");
+
+        // Handlers are bound when the generated parser is instantiated, these
+        // only record what kind of command it is.
+        if(kind == "command") {
+            target.command(name, description, options, [] (const argunaught::ParseResult&) { return 0; });
+        }
+        else if(kind == "streaming") {
+            target.streamingCommand(name, description, options,
+                [] (const argunaught::ParseResult&, argunaught::PositionalStream&) { return 0; });
+        }
+        else if(kind == "subparser") {
+            target.cursorSubParser(name, description, options,
+                [] (const argunaught::Parser&, argunaught::ArgCursor&, argunaught::ParseResult&) {});
+        }
+        else {
+            throw std::runtime_error("unknown kind '" + kind + "' for command '" + name + "'");
+        }
+    }
+}
+
+argunaught::Parser
+buildParser(const JsonValue& json, TypeMap& types)
+{
+    argunaught::Parser parser(json.getString("name"), json.getString("banner"));
+    parser.description(json.getString("description"));
+    parser.usage(json.getString("usage"));
+    parser.passThrough(json.getBool("passThrough", false));
+    parser.columnarResults(json.getBool("columnarResults", false));
+    parser.options(readOptions(json, "", types));
+
+    std::vector<argunaught::Constraint> constraints;
+    for(const auto& el : json.getArray("constraints")) {
+        auto type = el.getString("type");
+        if(type != "mutuallyExclusive" && type != "atLeastOne") {
+            throw std::runtime_error("unknown constraint type '" + type + "'");
+        }
+        constraints.push_back({
+            type == "atLeastOne" ? argunaught::ConstraintType::AtLeastOne : argunaught::ConstraintType::MutuallyExclusive,
+            el.getStrings("options")
+        });
+    }
+    if(!constraints.empty()) {
+        parser.constraints(constraints);
+    }
+
+    addCommands(parser, json, types);
+    for(const auto& el : json.getArray("groups")) {
+        auto& group = parser.group(el.getString("name"), el.getString("description"));
+        addCommands(group, el, types);
+    }
+
+    if(parser.hasConfigurationError()) {
+        std::string message = "invalid schema:";
+        for(const auto& err : parser.parserConfigErrors()) {
+            message += "\n  " + err.message;
+        }
+        throw std::runtime_error(message);
+    }
+
+    return parser;
+}
+
+//! The hash used by the generated command lookup, FNV-1a with a seed.
+std::uint32_t
+hashName(std::string_view name, std::uint32_t seed)
+{
+    std::uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for(auto c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//! A perfect hash over the command names, using hash and displace: names are
+//! spread over buckets, and each bucket gets a seed placing all of its names
+//! in free slots.
+struct PerfectHash
+{
+    std::vector<std::uint32_t> seeds;
+    std::vector<std::int32_t> slots;
+};
+
+PerfectHash
+buildPerfectHash(const std::vector<std::string>& names)
+{
+    const std::size_t numBuckets = std::max<std::size_t>(1, (names.size() + 3) / 4);
+    for(std::size_t numSlots = names.size() + names.size() / 4 + 1; ; numSlots += names.size() / 4 + 1) {
+        std::vector<std::vector<std::size_t>> buckets(numBuckets);
+        for(std::size_t ii = 0; ii < names.size(); ++ii) {
+            buckets[hashName(names[ii], 0) % numBuckets].push_back(ii);
+        }
+
+        std::vector<std::size_t> order(numBuckets);
+        for(std::size_t ii = 0; ii < numBuckets; ++ii) order[ii] = ii;
+        std::stable_sort(order.begin(), order.end(), [&buckets] (auto a, auto b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        PerfectHash result{std::vector<std::uint32_t>(numBuckets, 0), std::vector<std::int32_t>(numSlots, -1)};
+        bool placedAll = true;
+        for(auto bucket : order) {
+            if(buckets[bucket].empty()) continue;
+
+            bool placed = false;
+            for(std::uint32_t seed = 1; seed < 100000 && !placed; ++seed) {
+                std::vector<std::size_t> chosen;
+                for(auto name : buckets[bucket]) {
+                    auto slot = hashName(names[name], seed) % numSlots;
+                    if(result.slots[slot] != -1 || std::find(chosen.begin(), chosen.end(), slot) != chosen.end()) break;
+                    chosen.push_back(slot);
+                }
+
+                if(chosen.size() == buckets[bucket].size()) {
+                    for(std::size_t ii = 0; ii < chosen.size(); ++ii) {
+                        result.slots[chosen[ii]] = static_cast<std::int32_t>(buckets[bucket][ii]);
+                    }
+                    result.seeds[bucket] = seed;
+                    placed = true;
+                }
+            }
+
+            if(!placed) {
+                placedAll = false;
+                break;
+            }
+        }
+
+        if(placedAll) return result;
+    }
+}
+
+bool
+isCppKeyword(const std::string& word)
+{
+    static const std::set<std::string> keywords = {
+        "alignas", "alignof", "and", "asm", "auto", "bool", "break", "case", "catch", "char", "class",
+        "const", "constexpr", "continue", "decltype", "default", "delete", "do", "double", "else", "enum",
+        "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int",
+        "long", "mutable", "namespace", "new", "noexcept", "not", "nullptr", "operator", "or", "private",
+        "protected", "public", "register", "return", "short", "signed", "sizeof", "static", "struct",
+        "switch", "template", "this", "throw", "true", "try", "typedef", "typename", "union", "unsigned",
+        "using", "virtual", "void", "volatile", "while", "xor"
+    };
+    return keywords.count(word) > 0;
+}
+
+//! Turns a name like `dry-run` into `dryRun`, or `DryRun` when capitalized.
+std::string
+identifier(const std::string& name, bool capitalize)
+{
+    std::string result;
+    bool upperNext = capitalize;
+    for(auto c : name) {
+        if(!std::isalnum(static_cast<unsigned char>(c))) {
+            upperNext = !result.empty() || capitalize;
+            continue;
+        }
+
+        result += upperNext ? static_cast<char>(std::toupper(static_cast<unsigned char>(c))) : c;
+        upperNext = false;
+    }
+
+    if(result.empty() || std::isdigit(static_cast<unsigned char>(result[0]))) {
+        result = (capitalize ? "Command" : "option") + result;
+    }
+    if(isCppKeyword(result)) {
+        result += "_";
+    }
+    return result;
+}
+
+std::string
+quoted(std::string_view text)
+{
+    std::string result = "\"";
+    for(auto c : text) {
+        switch(c) {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default: result += c;
+        }
+    }
+    return result + "\"";
+}
+
+//! Writes a struct of typed fields for a set of options, and the function reading them from a result.
+void
+writeOptionStruct(
+        std::ostream& header,
+        std::ostream& source,
+        const std::string& structName,
+        const std::string& description,
+        const std::vector<argunaught::SchemaOption>& options,
+        const std::map<std::string, FieldType>& types)
+{
+    header << "//! " << description << "\n";
+    header << "struct " << structName << "\n{\n";
+    for(const auto& opt : options) {
+        const auto& type = types.at(std::string(opt.longName));
+        header << "    " << type.cppType() << " " << identifier(std::string(opt.longName), false);
+        header << (type.element == "bool" ? " = false" : (type.element == "count" ? " = 0" : "")) << ";\n";
+    }
+    header << "};\n\n";
+
+    header << "//! Reads the options into `options`, returning false if a value couldn't be converted.\n";
+    header << "bool read" << structName << "(const argunaught::ParseResult& result, " << structName << "& options);\n\n";
+
+    if(options.empty()) {
+        source << "bool\nread" << structName << "(const argunaught::ParseResult&, " << structName << "&)\n{\n";
+        source << "    return true;\n}\n\n";
+        return;
+    }
+
+    source << "bool\nread" << structName << "(const argunaught::ParseResult& result, " << structName << "& options)\n{\n";
+    source << "    bool converted = true;\n";
+    for(const auto& opt : options) {
+        const auto& type = types.at(std::string(opt.longName));
+        auto field = "options." + identifier(std::string(opt.longName), false);
+        source << "    if(auto opt = result.getOption(" << quoted(opt.longName) << "); opt.has_value()) {\n";
+        if(type.element == "bool") {
+            source << "        " << field << " = true;\n";
+        }
+        else if(type.element == "count") {
+            source << "        " << field << " = opt->count;\n";
+        }
+        else if(type.isList) {
+            source << "        for(const auto& value : opt->values) {\n";
+            source << "            converted = argunaught::detail::convertValue(value, " << field << ") && converted;\n";
+            source << "        }\n";
+        }
+        else {
+            source << "        if(!opt->values.empty()) {\n";
+            source << "            converted = argunaught::detail::convertValue(opt->values.back(), " << field << ") && converted;\n";
+            source << "        }\n";
+        }
+        source << "    }\n";
+    }
+    source << "\n    return converted;\n}\n\n";
+}
+
+void
+generate(const argunaught::Schema& schema, const TypeMap& types, const std::string& ns, const std::string& baseName,
+         std::ostream& header, std::ostream& source)
+{
+    header << "// Generated by argunaught-gen, do not edit.\n";
+    header << "#pragma once\n\n";
+    header << "#include <cstddef>\n#include <optional>\n#include <string>\n#include <string_view>\n#include <vector>\n\n";
+    header << "#include <argunaught/schema.hpp>\n\n";
+    header << "namespace " << ns << "\n{\n\n";
+
+    source << "// Generated by argunaught-gen, do not edit.\n";
+    source << "#include \"" << baseName << ".hpp\"\n\n";
+    source << "#include <cstdint>\n\n";
+    source << "namespace " << ns << "\n{\n\n";
+
+    // The schema, embedded as bytes.
+    auto data = schema.data();
+    source << "namespace\n{\n\n";
+    source << "alignas(8) const unsigned char SchemaData[] = {";
+    for(std::size_t ii = 0; ii < data.size(); ++ii) {
+        source << (ii % 16 == 0 ? "\n    " : " ") << static_cast<unsigned>(static_cast<unsigned char>(data[ii])) << ",";
+    }
+    source << "\n};\n\n";
+
+    std::vector<std::string> names;
+    for(std::size_t ii = 0; ii < schema.numCommands(); ++ii) {
+        names.emplace_back(schema.command(ii).name);
+    }
+
+    auto hash = buildPerfectHash(names);
+    if(!names.empty()) {
+        source << "constexpr std::string_view CommandNames[] = {\n";
+        for(const auto& name : names) source << "    " << quoted(name) << ",\n";
+        source << "};\n\n";
+
+        source << "constexpr std::uint32_t BucketSeeds[] = {";
+        for(std::size_t ii = 0; ii < hash.seeds.size(); ++ii) source << (ii % 16 == 0 ? "\n    " : " ") << hash.seeds[ii] << ",";
+        source << "\n};\n\n";
+
+        source << "constexpr std::int32_t Slots[] = {";
+        for(std::size_t ii = 0; ii < hash.slots.size(); ++ii) source << (ii % 16 == 0 ? "\n    " : " ") << hash.slots[ii] << ",";
+        source << "\n};\n\n";
+
+        source << "std::uint32_t\nhashName(std::string_view name, std::uint32_t seed)\n{\n";
+        source << "    std::uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);\n";
+        source << "    for(auto c : name) {\n";
+        source << "        hash ^= static_cast<unsigned char>(c);\n";
+        source << "        hash *= 16777619u;\n";
+        source << "    }\n";
+        source << "    return hash;\n}\n\n";
+    }
+    source << "}\n\n";
+
+    header << "//! The parser schema, embedded in the program.\n";
+    header << "const argunaught::Schema& schema();\n\n";
+    source << "const argunaught::Schema&\nschema()\n{\n";
+    source << "    static const argunaught::Schema embedded = argunaught::Schema::fromStatic(SchemaData, sizeof(SchemaData));\n";
+    source << "    return embedded;\n}\n\n";
+
+    header << "//! Builds the parser from the embedded schema, binding handlers by command name.\n";
+    header << "argunaught::Parser makeParser(const argunaught::SchemaHandlers& handlers);\n\n";
+    source << "argunaught::Parser\nmakeParser(const argunaught::SchemaHandlers& handlers)\n{\n";
+    source << "    return schema().instantiate(handlers);\n}\n\n";
+
+    header << "//! The commands, in schema order.\n";
+    header << "enum class CommandId\n{\n";
+    for(const auto& name : names) header << "    " << identifier(name, true) << ",\n";
+    header << "};\n\n";
+
+    header << "//! Finds a command by name with a perfect hash.\n";
+    header << "std::optional<CommandId> findCommand(std::string_view name);\n\n";
+    source << "std::optional<CommandId>\nfindCommand(std::string_view name)\n{\n";
+    if(names.empty()) {
+        source << "    return std::nullopt;\n}\n\n";
+    }
+    else {
+        source << "    auto seed = BucketSeeds[hashName(name, 0) % " << hash.seeds.size() << "];\n";
+        source << "    auto index = Slots[hashName(name, seed) % " << hash.slots.size() << "];\n";
+        source << "    if(index < 0 || CommandNames[index] != name) {\n";
+        source << "        return std::nullopt;\n";
+        source << "    }\n\n";
+        source << "    return static_cast<CommandId>(index);\n}\n\n";
+    }
+
+    std::vector<argunaught::SchemaOption> globals;
+    for(std::size_t ii = 0; ii < schema.numGlobalOptions(); ++ii) {
+        globals.push_back(schema.option(ii));
+    }
+    writeOptionStruct(header, source, "GlobalOptions", "The global options.", globals, types.count("") ? types.at("") : std::map<std::string, FieldType>{});
+
+    for(std::size_t ii = 0; ii < schema.numCommands(); ++ii) {
+        auto com = schema.command(ii);
+        std::vector<argunaught::SchemaOption> options;
+        for(std::uint32_t jj = 0; jj < com.numOptions; ++jj) {
+            options.push_back(schema.option(com.firstOption + jj));
+        }
+
+        auto name = std::string(com.name);
+        writeOptionStruct(header, source, identifier(name, true) + "Options", "The options of `" + name + "`.",
+                          options, types.count(name) ? types.at(name) : std::map<std::string, FieldType>{});
+    }
+
+    header << "}\n";
+    source << "}\n";
+}
+
+//! Only replaces the file when its contents change, so dependents aren't rebuilt needlessly.
+void
+writeIfChanged(const std::string& path, const std::string& contents)
+{
+    std::ifstream existing(path, std::ios::binary);
+    std::stringstream current;
+    current << existing.rdbuf();
+    if(existing && current.str() == contents) {
+        return;
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if(!out.write(contents.data(), contents.size())) {
+        throw std::runtime_error("unable to write '" + path + "'");
+    }
+}
+
+}
+
+int
+main(int argc, const char* argv[])
+{
+    auto args = argunaught::Parser("argunaught-gen")
+        .description("Generates C++ sources from a JSON command line schema.")
+        .usage("argunaught-gen --output <path/base_name> [--namespace <name>] <schema.json>")
+        .options({
+            {"output", "o", "Path of the files to generate, without an extension.", 1, 1, true},
+            {"namespace", "n", "Namespace of the generated code, the base name by default.", 1, 1},
+            {"help", "h", "Show this help.", 0}
+        });
+
+    auto result = args.parse(argc, argv);
+    if(result.hasOption("help")) {
+        std::cout << argunaught::DefaultHelpFormatter(args, {}, true).helpString();
+        return 0;
+    }
+
+    if(result.hasError() || result.positionalArgs.size() != 1) {
+        for(const auto& err : result.errors) {
+            std::cerr << "argunaught-gen: error: '" << err.value << "'\n";
+        }
+        std::cerr << "usage: argunaught-gen --output <path/base_name> [--namespace <name>] <schema.json>\n";
+        return 1;
+    }
+
+    const auto& schemaPath = result.positionalArgs[0];
+    auto output = result.getOption("output")->values[0];
+    auto baseName = output.substr(output.find_last_of('/') + 1);
+    auto ns = result.getOption("namespace", baseName).values[0];
+
+    try {
+        std::ifstream in(schemaPath, std::ios::binary);
+        if(!in) {
+            throw std::runtime_error("unable to read '" + schemaPath + "'");
+        }
+
+        std::stringstream text;
+        text << in.rdbuf();
+        auto json = JsonReader(text.str()).parseDocument();
+
+        TypeMap types;
+        auto parser = buildParser(json, types);
+        auto schema = argunaught::Schema::fromBuffer(argunaught::Schema::serialize(parser));
+
+        std::stringstream header;
+        std::stringstream source;
+        std::replace_if(ns.begin(), ns.end(), [] (char c) { return !std::isalnum(static_cast<unsigned char>(c)); }, '_');
+        generate(schema, types, ns, baseName, header, source);
+        writeIfChanged(output + ".hpp", header.str());
+        writeIfChanged(output + ".cpp", source.str());
+    }
+    catch(const std::exception& e) {
+        std::cerr << "argunaught-gen: " << schemaPath << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}